@@ -2,6 +2,7 @@
 #include <stdio.h>
 
 #include <malloc.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,37 +10,156 @@
 
 #include "utils/logger.h"
 #include "audio.h"
+#include "audio_medium.h"
+#include "internal/audio_backend.h"
 #include "internal/multi_waveform_data_source.h"
+#include "internal/pcm_sequence_data_source.h"
+
+/**
+ * A single playback in the playback queue.
+ */
+struct playback_item {
+    /** The datasource to play, either `pcm` or a datasource chain created by `AUDIO__play_sounds`. */
+    ma_data_source* source;
+
+    /** The datasource used to play queued PCM segments. */
+    struct pcm_sequence_data_source pcm;
+
+    /** A copy of the queued PCM segments list. */
+    struct pcm_segment_s segments[AUDIO_PLAYBACK_MAX_SEGMENTS];
+};
 
 /**
  * The definition of the audio_t interface.
  */
 struct audio_s {
-    /** The miniaudio library audio device, used for both recording/playing. */
+    /** The miniaudio library audio device, used for both recording/playing (unless driven by a backend). */
     ma_device audio_device;
 
+    /** The simulated medium the interface is connected to instead of the audio device, or NULL. */
+    audio_medium_t* medium;
+
+    /** The WAV file backend driving the interface instead of the audio device, or NULL. */
+    audio_wav_backend_t* wav;
+
+    /** The sample rate the interface plays and records at. */
+    uint32_t sample_rate;
+
+    /** The amount of channels the playbacks are played into. */
+    uint32_t playback_channels;
+
+    /** Whether the interface has been started (and not stopped since), when driven by a backend. */
+    atomic_bool is_started;
+
     /** User supplied callback for outputting recorded frames. */
     recording_callback_t recording_callback;
 
     /** User supplied general context pointer to be passed to the `recording_callback`. */
     void* recording_callback_context;
 
-    /** The currently playing datasource (or NULL if not playing). */
-    ma_data_source* sounds_playback;
+    /** User supplied callback checking whether the user is idle, or NULL. */
+    idle_callback_t idle_callback;
 
-    /** An event to playback has reached it's end. */
-    ma_event sounds_playback_finished_event;
+    /** User supplied general context pointer to be passed to the `idle_callback`. */
+    void* idle_callback_context;
 
     /**
-     * Saves the playback result upon it's end,
-     * ready for consumption when `sounds_playback_finished_event` is signaled.
+     * The playback queue, a single-producer/single-consumer ring between the playing thread and the audio callback.
+     * The playback of ticket `t` is held at index `(t - 1) % AUDIO_PLAYBACK_QUEUE_CAPACITY`.
      */
-    ma_result sounds_playback_result;
+    struct playback_item playback_queue[AUDIO_PLAYBACK_QUEUE_CAPACITY];
+
+    /** The result of each finished playback, indexed as the queue. */
+    ma_result playback_results[AUDIO_PLAYBACK_QUEUE_CAPACITY];
+
+    /** The amount of playbacks ever queued (the last ticket issued), owned by the playing thread. */
+    _Atomic uint64_t playbacks_queued;
+
+    /** The amount of playbacks ever finished (the last ticket finished), owned by the audio callback. */
+    _Atomic uint64_t playbacks_finished;
+
+    /** The ticket the playing thread is blocked on in `AUDIO__wait_playback`, or 0 if it isn't waiting. */
+    _Atomic uint64_t awaited_ticket;
+
+    /** An event signaled whenever a playback has reached it's end. */
+    ma_event playback_finished_event;
+
+    /** Set once the audio is being freed, so waiters won't wait for playbacks that will never finish. */
+    atomic_bool is_closing;
 
     /** Configures whether we allow recording (e.g invoking `recording_callback`) while playback is running. */
     bool full_duplex;
 };
 
+/**
+ * Plays the queued playbacks into the output buffer, chaining consecutive playbacks without gaps.
+ *
+ * @param audio The audio interface.
+ * @param pOutput The output buffer to write the playback frames into.
+ * @param frameCount The frames count in `pOutput`.
+ * @return Whether there was anything to play.
+ */
+static bool play_queued(audio_t* audio, void* pOutput, ma_uint32 frameCount) {
+    uint64_t finished = atomic_load_explicit(&audio->playbacks_finished, memory_order_relaxed);
+    uint64_t queued = atomic_load_explicit(&audio->playbacks_queued, memory_order_acquire);
+    if (finished == queued) {
+        return false;
+    }
+
+    ma_uint64 frames_written = 0;
+    while (frames_written < frameCount && finished < queued) {
+        /* Output the current playback to the speakers. */
+        size_t index = finished % AUDIO_PLAYBACK_QUEUE_CAPACITY;
+        ma_uint64 frames_to_read = frameCount - frames_written;
+        ma_uint64 frames_read = 0;
+        ma_result result = ma_data_source_read_pcm_frames(
+                audio->playback_queue[index].source,
+                ma_offset_pcm_frames_ptr(pOutput, frames_written, ma_format_f32, audio->playback_channels),
+                frames_to_read, &frames_read);
+        frames_written += frames_read;
+        if (result == MA_SUCCESS && frames_read == frames_to_read) {
+            /* The playback continues on the next callback. */
+            break;
+        }
+
+        /* The playback has reached it's end (or failed), save the result before publishing it. */
+        if (result != MA_SUCCESS && result != MA_AT_END) {
+            LOG_ERROR("Failed to read audio playback from data source %d", result);
+            audio->playback_results[index] = result;
+        } else {
+            audio->playback_results[index] = MA_SUCCESS;
+        }
+
+        finished++;
+        atomic_store_explicit(&audio->playbacks_finished, finished, memory_order_release);
+
+        /* Signal the waiting play functions, and continue right away with the next playback if there's one. */
+        if (ma_event_signal(&audio->playback_finished_event) != MA_SUCCESS) {
+            LOG_FATAL("Failed to signal playback finished");
+        }
+    }
+
+    /* Silence what's left in case we've ran out of playbacks. */
+    ma_silence_pcm_frames(
+            ma_offset_pcm_frames_ptr(pOutput, frames_written, ma_format_f32, audio->playback_channels),
+            frameCount - frames_written, ma_format_f32, audio->playback_channels);
+
+    return true;
+}
+
+/**
+ * Passes recorded frames to the recording callback, if there's one.
+ *
+ * @param audio The audio interface.
+ * @param input The recorded frames.
+ * @param frame_count The amount of recorded frames.
+ */
+static void pass_recording(audio_t* audio, const float* input, size_t frame_count) {
+    if (audio->recording_callback != NULL) {
+        audio->recording_callback(audio->recording_callback_context, input, frame_count);
+    }
+}
+
 /**
  * This callback is called by Miniaudio whenever there's a ready
  * recorded frame to read and an output buffer to write playback frames into
@@ -56,49 +176,65 @@ static void audio_callback(ma_device* pDevice, void* pOutput, const void* pInput
         return;
     }
 
-    if (audio->sounds_playback != NULL) {
-        /* Set the result as interrupt, this being the default status in case the Audio is uninitialized mid playing */
-        audio->sounds_playback_result = MA_INTERRUPT;
-
-        /* Output the sound to the speakers */
-        ma_result result = ma_data_source_read_pcm_frames(audio->sounds_playback, pOutput, frameCount, NULL);
-        if (result != MA_SUCCESS) {
-            if (result == MA_AT_END) {
-                /* Signal that we've exhausted the data source. */
-                audio->sounds_playback_result = MA_SUCCESS;
-            } else {
-                /* Signal we encountered an error on playback. */
-                LOG_ERROR("Failed to read audio sounds_playback from data source %d", result);
-                audio->sounds_playback_result = result;
-            }
-
-            /* Remove the current sounds playing, freeing it is the play function responsibility */
-            audio->sounds_playback = NULL;
-
-            /* Signal the play function we finished playing */
-            result = ma_event_signal(&audio->sounds_playback_finished_event);
-            if (result != MA_SUCCESS) {
-                LOG_FATAL("Failed to signal playback finished");
-            }
-        }
-
-        /* Return because we're not allowing to record ourself in half duplex mode. */
-        if (!audio->full_duplex) {
-            return;
-        }
+    /* Return if we played anything because we're not allowing to record ourself in half duplex mode. */
+    if (play_queued(audio, pOutput, frameCount) && !audio->full_duplex) {
+        return;
     }
 
     if (pDevice->capture.channels != 1) {
         LOG_ERROR("Unsupported recording channel count: %d", pDevice->capture.channels);
-    } else if (audio->recording_callback != NULL) {
+    } else {
         /* Pass the recorded frames to the recording callback */
-        audio->recording_callback(audio->recording_callback_context, pInput, frameCount);
+        pass_recording(audio, pInput, frameCount);
     }
 }
 
-audio_t* AUDIO__initialize(enum standard_sample_rate framerate, bool full_duplex) {
-    ma_result result;
+bool AUDIO__is_started(audio_t* audio) {
+    return atomic_load_explicit(&audio->is_started, memory_order_acquire);
+}
+
+bool AUDIO__render_playback(audio_t* audio, float* output, size_t samples_count) {
+    if (!atomic_load_explicit(&audio->is_started, memory_order_acquire)) {
+        memset(output, 0, samples_count * sizeof(float));
+        return false;
+    }
+
+    /* Nothing is written if nothing's queued, and the backends' buffers (unlike miniaudio's) aren't pre-silenced. */
+    if (!play_queued(audio, output, (ma_uint32)samples_count)) {
+        memset(output, 0, samples_count * sizeof(float));
+        return false;
+    }
+
+    return true;
+}
+
+void AUDIO__deliver_recording(audio_t* audio, const float* input, size_t samples_count, bool is_playing) {
+    /* We're not allowing to record ourself in half duplex mode. */
+    if (!atomic_load_explicit(&audio->is_started, memory_order_acquire) || (is_playing && !audio->full_duplex)) {
+        return;
+    }
+
+    pass_recording(audio, input, samples_count);
+}
+
+bool AUDIO__is_idle(audio_t* audio) {
+    /* The user is still setting the interface up until it's started. */
+    if (!atomic_load_explicit(&audio->is_started, memory_order_acquire)) {
+        return false;
+    }
+
+    return audio->idle_callback == NULL || audio->idle_callback(audio->idle_callback_context);
+}
 
+/**
+ * Allocates an audio struct and initializes the state shared by every backend.
+ *
+ * @param sample_rate The sample rate at which to record/play.
+ * @param playback_channels The amount of channels the playbacks are played into.
+ * @param full_duplex Whether recording is allowed while playing.
+ * @return The allocated audio struct, or NULL on failure.
+ */
+static audio_t* allocate_audio(uint32_t sample_rate, uint32_t playback_channels, bool full_duplex) {
     /* Allocate the audio struct */
     audio_t* audio = (audio_t*) malloc(sizeof(audio_t));
     if (audio == NULL) {
@@ -107,17 +243,110 @@ audio_t* AUDIO__initialize(enum standard_sample_rate framerate, bool full_duplex
     }
 
     /* Initialize the audio state */
+    audio->medium = NULL;
+    audio->wav = NULL;
+    audio->sample_rate = sample_rate;
+    audio->playback_channels = playback_channels;
+    atomic_init(&audio->is_started, false);
     audio->recording_callback = NULL;
     audio->recording_callback_context = NULL;
-    audio->sounds_playback = NULL;
+    audio->idle_callback = NULL;
+    audio->idle_callback_context = NULL;
     audio->full_duplex = full_duplex;
+    atomic_init(&audio->playbacks_queued, 0);
+    atomic_init(&audio->playbacks_finished, 0);
+    atomic_init(&audio->awaited_ticket, 0);
+    atomic_init(&audio->is_closing, false);
+    for (int i = 0; i < AUDIO_PLAYBACK_QUEUE_CAPACITY; ++i) {
+        audio->playback_queue[i].source = NULL;
+        audio->playback_results[i] = MA_SUCCESS;
+    }
+
+    /* Initialize the playback finished event */
+    if (ma_event_init(&audio->playback_finished_event) != MA_SUCCESS) {
+        LOG_ERROR("Failed to initialize playback finished event");
+        free(audio);
+        return NULL;
+    }
+
+    return audio;
+}
+
+/**
+ * Releases the state shared by every backend and frees the audio struct.
+ *
+ * @param audio The audio struct allocated by `allocate_audio`.
+ */
+static void release_audio(audio_t* audio) {
+    ma_event_uninit(&audio->playback_finished_event);
+    free(audio);
+}
+
+audio_t* AUDIO__initialize_simulated(audio_medium_t* medium, bool full_duplex) {
+    /* Validate parameters */
+    if (medium == NULL) {
+        LOG_ERROR("Invalid parameters");
+        return NULL;
+    }
+
+    /* The medium carries mono sound. */
+    audio_t* audio = allocate_audio(AUDIO_MEDIUM__get_sample_rate(medium), 1, full_duplex);
+    if (audio == NULL) {
+        return NULL;
+    }
+
+    audio->medium = medium;
+    if (AUDIO_MEDIUM__connect(medium, audio) != 0) {
+        LOG_ERROR("Failed to connect to the simulated medium");
+        release_audio(audio);
+        return NULL;
+    }
+
+    LOG_INFO("Initialized device: Simulated Medium");
+
+    return audio;
+}
+
+audio_t* AUDIO__initialize_wav(const struct audio_wav_config* config, bool full_duplex) {
+    /* Validate parameters */
+    if (config == NULL) {
+        LOG_ERROR("Invalid parameters");
+        return NULL;
+    }
+
+    /* The files hold mono sound. */
+    audio_t* audio = allocate_audio(config->sample_rate, 1, full_duplex);
+    if (audio == NULL) {
+        return NULL;
+    }
+
+    audio->wav = AUDIO_WAV__initialize(audio, config);
+    if (audio->wav == NULL) {
+        LOG_ERROR("Failed to initialize the WAV backend");
+        release_audio(audio);
+        return NULL;
+    }
+
+    LOG_INFO("Initialized device: WAV Files");
+
+    return audio;
+}
+
+audio_t* AUDIO__initialize(enum standard_sample_rate framerate, bool full_duplex) {
+    ma_result result;
+
+    /* Allocate the audio struct, the device plays in stereo */
+    audio_t* audio = allocate_audio(framerate, 2, full_duplex);
+    if (audio == NULL) {
+        return NULL;
+    }
 
     /* Configure miniaudio device config */
     ma_device_config deviceConfig  = ma_device_config_init(ma_device_type_duplex);
     deviceConfig.capture.format    = ma_format_f32;
     deviceConfig.capture.channels  = 1;
     deviceConfig.playback.format   = ma_format_f32;
-    deviceConfig.playback.channels = 2;
+    deviceConfig.playback.channels = audio->playback_channels;
     deviceConfig.sampleRate        = framerate;
     deviceConfig.dataCallback      = audio_callback;
     deviceConfig.pUserData         = audio;
@@ -126,16 +355,7 @@ audio_t* AUDIO__initialize(enum standard_sample_rate framerate, bool full_duplex
     result = ma_device_init(NULL, &deviceConfig, &audio->audio_device);
     if (result != MA_SUCCESS) {
         LOG_ERROR("Failed to initialize audio device, result: %d", result);
-        free(audio);
-        return NULL;
-    }
-
-    /* Initialize the playback finished event */
-    result = ma_event_init(&audio->sounds_playback_finished_event);
-    if (result != MA_SUCCESS) {
-        LOG_ERROR("Failed to initialize playback finished event");
-        ma_device_uninit(&audio->audio_device);
-        free(audio);
+        release_audio(audio);
         return NULL;
     }
 
@@ -148,17 +368,29 @@ void AUDIO__free(audio_t* audio) {
     /* Make sure the thread is stopped */
     AUDIO__stop(audio);
 
-    /* We signal the event in case some thread is still waiting on it */
-    ma_event_signal(&audio->sounds_playback_finished_event);
+    /* We signal the event in case some thread is still waiting on it, pending playbacks will never finish */
+    atomic_store(&audio->is_closing, true);
+    ma_event_signal(&audio->playback_finished_event);
 
     /* Uninitialized the resources,
      * note that there's no need to uninitialize the sounds since it's the play responsibility */
-    ma_device_uninit(&audio->audio_device);
-    ma_event_uninit(&audio->sounds_playback_finished_event);
-    free(audio);
+    if (audio->medium != NULL) {
+        AUDIO_MEDIUM__disconnect(audio->medium, audio);
+    } else if (audio->wav != NULL) {
+        AUDIO_WAV__free(audio->wav);
+    } else {
+        ma_device_uninit(&audio->audio_device);
+    }
+    release_audio(audio);
 }
 
 int AUDIO__start(audio_t* audio) {
+    /* A backend drives the interface on it's own clock, it only has to know the interface is playing/recording. */
+    if (audio->medium != NULL || audio->wav != NULL) {
+        atomic_store_explicit(&audio->is_started, true, memory_order_release);
+        return 0;
+    }
+
     ma_result result = ma_device_start(&audio->audio_device);
     if (result != MA_SUCCESS) {
         LOG_ERROR("Failed to start audio device");
@@ -169,6 +401,11 @@ int AUDIO__start(audio_t* audio) {
 }
 
 int AUDIO__stop(audio_t* audio) {
+    if (audio->medium != NULL || audio->wav != NULL) {
+        atomic_store_explicit(&audio->is_started, false, memory_order_release);
+        return 0;
+    }
+
     ma_result result = ma_device_stop(&audio->audio_device);
     if (result != MA_SUCCESS) {
         LOG_ERROR("Failed to stop audio device");
@@ -178,11 +415,20 @@ int AUDIO__stop(audio_t* audio) {
     return 0;
 }
 
+bool AUDIO__is_capture_finished(audio_t* audio) {
+    return audio->wav != NULL && AUDIO_WAV__is_capture_finished(audio->wav);
+}
+
 void AUDIO__set_recording_callback(audio_t* audio, recording_callback_t callback, void* callback_context) {
     audio->recording_callback_context = callback_context;
     audio->recording_callback = callback;
 }
 
+void AUDIO__set_idle_callback(audio_t* audio, idle_callback_t callback, void* callback_context) {
+    audio->idle_callback_context = callback_context;
+    audio->idle_callback = callback;
+}
+
 /**
  * Destroys all the datasources in a playback.
  *
@@ -203,13 +449,13 @@ static void destroy_playback(ma_data_source* playback) {
  * In order to play them in succession, we can use Miniaudio's `ma_data_source_set_next` function
  * that will cause the datasources to be linked and play seamlessly one after the other as a single datasource.
  *
- * @param audio_device The device the playback is expected to play on.
+ * @param audio The audio interface the playback is expected to play on.
  * @param sounds The sounds to play.
  * @param sounds_count The number of sounds.
  * @param playback Returns the playback datasource.
  * @return 0 On Success, -1 On Failure.
  */
-static int create_sounds_playback(ma_device* audio_device, struct sound_s* sounds, uint32_t sounds_count, ma_data_source** playback) {
+static int create_sounds_playback(audio_t* audio, struct sound_s* sounds, uint32_t sounds_count, ma_data_source** playback) {
     int ret = -1;
     ma_result result;
 
@@ -218,9 +464,9 @@ static int create_sounds_playback(ma_device* audio_device, struct sound_s* sound
     ma_data_source* first;
     result = multi_waveform_data_source_init(
             (struct multi_waveform_data_source **) &first,
-            audio_device->playback.format, audio_device->playback.channels, audio_device->sampleRate,
+            ma_format_f32, audio->playback_channels, audio->sample_rate,
             sounds[0].frequencies, sounds[0].number_of_frequencies,
-            audio_device->sampleRate / 1000 * sounds[0].length_milliseconds);
+            audio->sample_rate / 1000 * sounds[0].length_milliseconds);
     if (result != MA_SUCCESS) {
         LOG_ERROR("Failed to initialize multi waveform");
         ret = -1;
@@ -233,9 +479,9 @@ static int create_sounds_playback(ma_device* audio_device, struct sound_s* sound
         /* Create a new datasource for the current sound. */
         result = multi_waveform_data_source_init(
                 (struct multi_waveform_data_source **) &current,
-                audio_device->playback.format, audio_device->playback.channels, audio_device->sampleRate,
+                ma_format_f32, audio->playback_channels, audio->sample_rate,
                 sounds[i].frequencies, sounds[i].number_of_frequencies,
-                audio_device->sampleRate / 1000 * sounds[i].length_milliseconds);
+                audio->sample_rate / 1000 * sounds[i].length_milliseconds);
         if (result != MA_SUCCESS) {
             LOG_ERROR("Failed to initialize multi waveform");
             ret = -1;
@@ -269,47 +515,159 @@ l_cleanup:
     return ret;
 }
 
-int AUDIO__play_sounds(audio_t* audio, struct sound_s* sounds, uint32_t sounds_count) {
-    int ret = -1;
-    ma_result result;
+/**
+ * Acquires the next free playback queue item, waiting for the oldest playback to finish if the queue is full.
+ *
+ * @param audio The audio interface.
+ * @return The free playback item, or NULL on failure.
+ */
+static struct playback_item* acquire_playback_item(audio_t* audio) {
+    uint64_t queued = atomic_load_explicit(&audio->playbacks_queued, memory_order_relaxed);
+    uint64_t finished = atomic_load_explicit(&audio->playbacks_finished, memory_order_acquire);
+    if (queued - finished >= AUDIO_PLAYBACK_QUEUE_CAPACITY) {
+        if (AUDIO__wait_playback(audio, queued - AUDIO_PLAYBACK_QUEUE_CAPACITY + 1) != 0) {
+            LOG_ERROR("Failed waiting for a free playback queue item");
+            return NULL;
+        }
+    }
+
+    /* Release the previous use of the item. */
+    struct playback_item* item = &audio->playback_queue[queued % AUDIO_PLAYBACK_QUEUE_CAPACITY];
+    if (item->source == &item->pcm) {
+        pcm_sequence_data_source_uninit(&item->pcm);
+    }
 
+    item->source = NULL;
+    return item;
+}
+
+/**
+ * Publishes the acquired playback queue item to the audio callback.
+ *
+ * @param audio The audio interface.
+ * @return The ticket of the queued playback.
+ */
+static audio_playback_ticket_t publish_playback_item(audio_t* audio) {
+    uint64_t queued = atomic_load_explicit(&audio->playbacks_queued, memory_order_relaxed) + 1;
+    atomic_store_explicit(&audio->playbacks_queued, queued, memory_order_release);
+    return queued;
+}
+
+int AUDIO__wait_playback(audio_t* audio, audio_playback_ticket_t ticket) {
     /* Validate parameters. */
-    if (sounds_count == 0 || sounds == NULL || audio == NULL) {
+    if (audio == NULL || ticket == 0 || ticket > atomic_load_explicit(&audio->playbacks_queued, memory_order_relaxed)) {
         LOG_ERROR("Invalid parameters");
         return -1;
     }
 
-    /* Cannot play multiple sounds at the same time, validate there's no collisions. */
-    if (audio->sounds_playback != NULL) {
-        LOG_ERROR("Another sound is currently playing");
+    /* Wait until the callback reports the playback has finished, playbacks finish in order. */
+    int ret = 0;
+    atomic_store(&audio->awaited_ticket, ticket);
+    while (atomic_load_explicit(&audio->playbacks_finished, memory_order_acquire) < ticket) {
+        if (atomic_load(&audio->is_closing)) {
+            LOG_ERROR("Audio closed before playback has finished");
+            ret = -1;
+            break;
+        }
+
+        ma_result result = ma_event_wait(&audio->playback_finished_event);
+        if (result != MA_SUCCESS) {
+            LOG_ERROR("Failed waiting on playback to finish");
+            ret = -1;
+            break;
+        }
+    }
+    atomic_store(&audio->awaited_ticket, 0);
+    if (ret != 0) {
+        return ret;
+    }
+
+    /* Get the playback result. */
+    if (audio->playback_results[(ticket - 1) % AUDIO_PLAYBACK_QUEUE_CAPACITY] != MA_SUCCESS) {
+        LOG_ERROR("Failed playing sounds");
+        return -1;
+    }
+
+    return 0;
+}
+
+bool AUDIO__is_waiting_playback(audio_t* audio) {
+    uint64_t ticket = atomic_load(&audio->awaited_ticket);
+    return ticket != 0 && atomic_load_explicit(&audio->playbacks_finished, memory_order_acquire) < ticket;
+}
+
+int AUDIO__play_sounds(audio_t* audio, struct sound_s* sounds, uint32_t sounds_count) {
+    int ret = -1;
+
+    /* Validate parameters. */
+    if (sounds_count == 0 || sounds == NULL || audio == NULL) {
+        LOG_ERROR("Invalid parameters");
         return -1;
     }
 
     /* Create the playback from the given sounds. */
     ma_data_source* playback = NULL;
-    ret = create_sounds_playback(&audio->audio_device, sounds, sounds_count, &playback);
+    ret = create_sounds_playback(audio, sounds, sounds_count, &playback);
     if (ret != 0) {
         LOG_ERROR("Failed to create sounds playback");
         return ret;
     }
 
-    /* Set the playback as the datasource played, and wait until the playback is finished. */
-    audio->sounds_playback = playback;
-    result = ma_event_wait(&audio->sounds_playback_finished_event);
-    if (result != MA_SUCCESS) {
-        LOG_ERROR("Failed waiting on playback to finish");
+    /* Queue the playback. */
+    struct playback_item* item = acquire_playback_item(audio);
+    if (item == NULL) {
+        destroy_playback(playback);
         return -1;
     }
 
-    /* Get the playback result. */
-    result = audio->sounds_playback_result;
-    if (result != MA_SUCCESS) {
-        LOG_ERROR("Failed playing sounds");
-        return -1;
+    item->source = playback;
+    audio_playback_ticket_t ticket = publish_playback_item(audio);
+
+    /* Wait until the sounds have been played, the playback can only be cleaned once the callback is done with it. */
+    ret = AUDIO__wait_playback(audio, ticket);
+    if (ret != 0) {
+        return ret;
     }
 
     /* Clean the playback. */
+    item->source = NULL;
     destroy_playback(playback);
     return 0;
 }
 
+int AUDIO__enqueue_pcm(audio_t* audio, const struct pcm_segment_s* segments, uint32_t segments_count,
+                       audio_playback_ticket_t* ticket) {
+    /* Validate parameters. */
+    if (segments_count == 0 || segments_count > AUDIO_PLAYBACK_MAX_SEGMENTS ||
+        segments == NULL || audio == NULL || ticket == NULL) {
+        LOG_ERROR("Invalid parameters");
+        return -1;
+    }
+
+    struct playback_item* item = acquire_playback_item(audio);
+    if (item == NULL) {
+        return -1;
+    }
+
+    /* The sequence plays over the item's own copy of the segments list, so the caller's list may be reused. */
+    memcpy(item->segments, segments, segments_count * sizeof(struct pcm_segment_s));
+    ma_result result = pcm_sequence_data_source_init(&item->pcm, audio->playback_channels,
+                                                     audio->sample_rate, item->segments, segments_count);
+    if (result != MA_SUCCESS) {
+        LOG_ERROR("Failed to initialize PCM sequence");
+        return -1;
+    }
+
+    item->source = &item->pcm;
+    *ticket = publish_playback_item(audio);
+    return 0;
+}
+
+int AUDIO__play_pcm(audio_t* audio, const struct pcm_segment_s* segments, uint32_t segments_count) {
+    audio_playback_ticket_t ticket;
+    if (AUDIO__enqueue_pcm(audio, segments, segments_count, &ticket) != 0) {
+        return -1;
+    }
+
+    return AUDIO__wait_playback(audio, ticket);
+}
@@ -1,11 +1,26 @@
 #ifndef AUDIONET_AUDIO_H
 #define AUDIONET_AUDIO_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 /**
  * The maximum amount of concurrent frequencies in a sound.
  */
 #define SOUND_MAX_CONCURRENT_FREQUENCIES (5)
 
+/**
+ * The maximum amount of playbacks waiting in the playback queue,
+ * queueing more blocks until the oldest has finished playing.
+ */
+#define AUDIO_PLAYBACK_QUEUE_CAPACITY (16)
+
+/**
+ * The maximum amount of PCM segments in a single queued playback.
+ */
+#define AUDIO_PLAYBACK_MAX_SEGMENTS (32)
+
 /**
  * The various available sample rates for audio recording/playing.
  */
@@ -49,11 +64,22 @@ enum standard_sample_rate_sample_size {
  */
 typedef struct audio_s audio_t;
 
+/**
+ * The simulated acoustic medium type, see audio_medium.h.
+ */
+typedef struct audio_medium_s audio_medium_t;
+
 /**
  * The type definition for audio recording callback.
  */
 typedef void (*recording_callback_t)(void* context, const float* recorded_frame, size_t size);
 
+/**
+ * The type definition for the audio idle callback, checking whether the interface's user has handled everything
+ * recorded so far and is blocked waiting for more (or for a playback to finish).
+ */
+typedef bool (*idle_callback_t)(void* context);
+
 /**
  * Allocates and initializes an audio interface.
  * May be used for both recording and playing with the same interface.
@@ -65,6 +91,60 @@ typedef void (*recording_callback_t)(void* context, const float* recorded_frame,
  */
 audio_t* AUDIO__initialize(enum standard_sample_rate sample_rate, bool full_duplex);
 
+/**
+ * Allocates and initializes an audio interface connected to a simulated medium instead of the sound card.
+ * Behaves like a sound card interface at the medium's sample rate, any amount of them may be created.
+ *
+ * @param medium The medium to connect to, must outlive the interface.
+ * @param full_duplex Whether recording is allowed while playing.
+ * @return The initialize audio interface. Returns NULL on failure.
+ */
+audio_t* AUDIO__initialize_simulated(audio_medium_t* medium, bool full_duplex);
+
+/**
+ * The WAV file backend configuration, replaying a recording instead of the sound card.
+ */
+struct audio_wav_config {
+    /** The sample rate of the interface, the capture file must have been recorded at it. */
+    enum standard_sample_rate sample_rate;
+
+    /** The WAV file streamed as the recording, or NULL to record silence. */
+    const char* capture_path;
+
+    /** The WAV file the playback is written into (silence included, aligned with the capture), or NULL to discard it. */
+    const char* playback_path;
+
+    /** How many times faster than real time the files are streamed. */
+    float speed;
+
+    /** The amount of samples streamed at once, the period of the replayed device. */
+    uint32_t block_size;
+
+    /** Whether the samples recorded while playing are dropped in half duplex, as a sound card's would be.
+     *  Otherwise the capture file is passed through unchanged. */
+    bool drop_while_playing;
+};
+
+/**
+ * Allocates and initializes an audio interface streaming it's recording from a WAV file instead of the sound card,
+ * and writing it's playback into a WAV file. The files advance only while the interface is started,
+ * so the recording callback sees exactly the file's samples (unless `drop_while_playing` is set).
+ * Silence is recorded once the capture file ends.
+ *
+ * @param config The backend configuration.
+ * @param full_duplex Whether recording is allowed while playing.
+ * @return The initialize audio interface. Returns NULL on failure.
+ */
+audio_t* AUDIO__initialize_wav(const struct audio_wav_config* config, bool full_duplex);
+
+/**
+ * Checks whether the whole capture file has been recorded, always false for live interfaces.
+ *
+ * @param audio The audio interface.
+ * @return Whether the capture has ended.
+ */
+bool AUDIO__is_capture_finished(audio_t* audio);
+
 /**
  * Frees and uninitializes the audio interface.
  *
@@ -97,6 +177,16 @@ int AUDIO__stop(audio_t* audio);
  */
 void AUDIO__set_recording_callback(audio_t* audio, recording_callback_t callback, void* callback_context);
 
+/**
+ * Sets the user callback checking whether the user is idle, it's called by a lock-step simulated medium
+ * before advancing it's clock (see `struct audio_medium_config`), an interface without one is idle once started.
+ *
+ * @param audio The audio interface to set.
+ * @param callback The callback function checking whether the user is idle.
+ * @param callback_context An optional context param passed to the callback function.
+ */
+void AUDIO__set_idle_callback(audio_t* audio, idle_callback_t callback, void* callback_context);
+
 /**
  * A single sound that can be played,
  * composed from multiple frequencies playing together for some duration.
@@ -120,10 +210,15 @@ struct sound_s {
     uint32_t number_of_frequencies;
 };
 
+/**
+ * Identifies a queued playback, tickets are issued in increasing order starting at 1.
+ */
+typedef uint64_t audio_playback_ticket_t;
+
 /**
  * Plays an array of given sounds in succession.
- * The function blocks until the sounds has been played,
- * cannot call this function concurrently.
+ * The sounds are queued after any pending playback, and the function blocks until they have been played.
+ * Cannot call the playback functions concurrently from multiple threads.
  *
  * @param audio The audio interface to play from.
  * @param sounds The list of sounds to play.
@@ -132,4 +227,69 @@ struct sound_s {
  */
 int AUDIO__play_sounds(audio_t* audio, struct sound_s* sounds, uint32_t sounds_count);
 
+/**
+ * A segment of pre-rendered mono PCM to be played,
+ * the samples are duplicated to every output channel.
+ */
+struct pcm_segment_s {
+    /**
+     * The segment's samples, in 32 bit float format at the audio's sample rate.
+     * Owned by the caller, must stay valid until the segment has been played.
+     */
+    const float* samples;
+
+    /**
+     * The amount of samples in the segment.
+     */
+    uint32_t samples_count;
+};
+
+/**
+ * Plays an array of pre-rendered PCM segments in succession.
+ * Unlike `AUDIO__play_sounds` nothing is synthesized or allocated, the segments are copied as is to the device.
+ * The segments are queued after any pending playback, and the function blocks until they have been played.
+ * Cannot call the playback functions concurrently from multiple threads.
+ *
+ * @param audio The audio interface to play from.
+ * @param segments The list of segments to play.
+ * @param segments_count The amount of segments.
+ * @return 0 On Success, -1 On Failure.
+ */
+int AUDIO__play_pcm(audio_t* audio, const struct pcm_segment_s* segments, uint32_t segments_count);
+
+/**
+ * Queues an array of pre-rendered PCM segments to be played after any pending playback, without waiting for it.
+ * Consecutive playbacks are chained on the audio callback, so they play back to back without gaps.
+ * Blocks only while the queue is full (`AUDIO_PLAYBACK_QUEUE_CAPACITY`).
+ * Cannot call the playback functions concurrently from multiple threads.
+ *
+ * @param audio The audio interface to play from.
+ * @param segments The list of segments to play, at most `AUDIO_PLAYBACK_MAX_SEGMENTS`.
+ *                 The list is copied, but the samples must stay valid until the playback is finished.
+ * @param segments_count The amount of segments.
+ * @param ticket Returns the ticket of the playback, for `AUDIO__wait_playback`.
+ * @return 0 On Success, -1 On Failure.
+ */
+int AUDIO__enqueue_pcm(audio_t* audio, const struct pcm_segment_s* segments, uint32_t segments_count,
+                       audio_playback_ticket_t* ticket);
+
+/**
+ * Waits until a queued playback (and all the playbacks queued before it) has finished playing.
+ * The result of a playback is kept until `AUDIO_PLAYBACK_QUEUE_CAPACITY` later playbacks have finished.
+ *
+ * @param audio The audio interface.
+ * @param ticket The ticket of the playback to wait for.
+ * @return 0 On Success, -1 On Failure (including a failure to play the waited playback).
+ */
+int AUDIO__wait_playback(audio_t* audio, audio_playback_ticket_t ticket);
+
+/**
+ * Checks whether a thread is blocked in `AUDIO__wait_playback` (or in queueing a playback while the queue is full)
+ * on a playback that hasn't finished yet.
+ *
+ * @param audio The audio interface.
+ * @return Whether the playing thread is waiting for the playback.
+ */
+bool AUDIO__is_waiting_playback(audio_t* audio);
+
 #endif //AUDIONET_AUDIO_H
@@ -0,0 +1,504 @@
+#include <errno.h>
+#include <math.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "audio_medium.h"
+#include "internal/audio_backend.h"
+#include "utils/logger.h"
+
+/** The default amount of samples simulated at once (10 milliseconds at 48kHz). */
+#define DEFAULT_BLOCK_SIZE (480)
+
+/**
+ * How far (in samples) the recordings lag behind the medium's clock,
+ * so the interpolation never reads samples that haven't been played yet, whatever the clocks' drift.
+ */
+#define RECORDING_LATENCY_SAMPLES (4)
+
+/** How often a lock-step clock checks whether the connected interfaces are idle. */
+#define LOCK_STEP_POLL_NANOSECONDS (50000)
+
+/**
+ * A single path between two endpoints, the direct path or an echo.
+ */
+struct medium_tap {
+    /** The path's delay, in (medium clock) samples. */
+    double delay_samples;
+
+    /** The path's amplitude. */
+    float gain;
+};
+
+/**
+ * An audio interface connected to the medium.
+ */
+struct medium_endpoint {
+    /** The connected audio interface, or NULL if the endpoint is free. */
+    audio_t* audio;
+
+    /** The endpoint's samples per medium clock sample, it's clock drift. */
+    double clock_ratio;
+
+    /** The endpoint's played samples, the sample at position `p` is held at index `p % history_size`. */
+    float* history;
+
+    /** The amount of samples the endpoint has played (in it's own clock). */
+    uint64_t played_count;
+
+    /** The amount of samples the endpoint has recorded (in it's own clock). */
+    uint64_t recorded_count;
+
+    /** A block of samples played or recorded by the endpoint. */
+    float* block;
+
+    /** Whether the endpoint played anything in the current block. */
+    bool is_playing;
+};
+
+struct audio_medium_s {
+    /** The sample rate of the medium. */
+    enum standard_sample_rate sample_rate;
+
+    /** The medium configuration. */
+    struct audio_medium_config config;
+
+    /** The paths between any two endpoints, the direct path followed by the echoes. */
+    struct medium_tap taps[1 + AUDIO_MEDIUM_MAX_ECHOES];
+
+    /** The amount of paths. */
+    uint32_t taps_count;
+
+    /** The amount of samples each endpoint's history holds, a power of two. */
+    size_t history_size;
+
+    /** The amount of samples in each endpoint's block buffer, enough for a drifting block. */
+    size_t block_capacity;
+
+    /** The connected endpoints. */
+    struct medium_endpoint endpoints[AUDIO_MEDIUM_MAX_ENDPOINTS];
+
+    /** Protects the endpoints, held while a block is simulated. */
+    pthread_mutex_t endpoints_lock;
+
+    /** The amount of samples simulated so far, the medium's clock. */
+    _Atomic uint64_t position;
+
+    /** The state of the noise generator. */
+    uint64_t noise_state;
+
+    /** The medium clock thread. */
+    pthread_t clock_thread;
+
+    /** Cleared to ask the clock thread to exit. */
+    atomic_bool is_running;
+};
+
+void AUDIO_MEDIUM__get_default_config(struct audio_medium_config* config) {
+    config->block_size = DEFAULT_BLOCK_SIZE;
+    config->speed = 1;
+    config->lock_step = false;
+    config->attenuation_db = 0;
+    config->delay_milliseconds = 0;
+    memset(config->echoes, 0, sizeof(config->echoes));
+    config->echoes_count = 0;
+    config->noise_level = 0;
+    config->clock_drift_ppm = 0;
+    config->seed = 1;
+}
+
+/**
+ * Generates the next uniformly distributed random number (xorshift64*).
+ *
+ * @param medium The medium holding the generator state.
+ * @return A random number in (0, 1].
+ */
+static double next_uniform(audio_medium_t* medium) {
+    medium->noise_state ^= medium->noise_state >> 12;
+    medium->noise_state ^= medium->noise_state << 25;
+    medium->noise_state ^= medium->noise_state >> 27;
+    uint64_t value = medium->noise_state * 0x2545F4914F6CDD1DULL;
+    return ((value >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * Generates the next normally distributed random number (Box-Muller).
+ *
+ * @param medium The medium holding the generator state.
+ * @return A random number of the standard normal distribution.
+ */
+static float next_gaussian(audio_medium_t* medium) {
+    double radius = sqrt(-2 * log(next_uniform(medium)));
+    return (float)(radius * cos(2 * M_PI * next_uniform(medium)));
+}
+
+/**
+ * Gets an endpoint's played sample at a fractional position, linearly interpolated.
+ * Positions before the endpoint started playing are silent.
+ *
+ * @param medium The medium.
+ * @param endpoint The endpoint.
+ * @param position The position in the endpoint's clock.
+ * @return The interpolated sample.
+ */
+static float get_played_sample(audio_medium_t* medium, struct medium_endpoint* endpoint, double position) {
+    if (position < 0) {
+        return 0;
+    }
+
+    uint64_t index = (uint64_t)position;
+    float fraction = (float)(position - (double)index);
+    size_t mask = medium->history_size - 1;
+    float current = endpoint->history[index & mask];
+    float next = endpoint->history[(index + 1) & mask];
+    return current + (next - current) * fraction;
+}
+
+/**
+ * Plays every connected endpoint up to the medium's clock, into their histories.
+ *
+ * @param medium The medium.
+ * @param end The medium's clock at the end of the simulated block.
+ */
+static void play_endpoints(audio_medium_t* medium, uint64_t end) {
+    size_t mask = medium->history_size - 1;
+    for (int i = 0; i < AUDIO_MEDIUM_MAX_ENDPOINTS; ++i) {
+        struct medium_endpoint* endpoint = &medium->endpoints[i];
+        if (endpoint->audio == NULL) {
+            continue;
+        }
+
+        /* A drifting clock plays a sample more or less than the medium in some blocks. */
+        uint64_t target = (uint64_t)((double)end * endpoint->clock_ratio);
+        size_t count = (size_t)(target - endpoint->played_count);
+        endpoint->is_playing = AUDIO__render_playback(endpoint->audio, endpoint->block, count);
+        for (size_t n = 0; n < count; ++n) {
+            endpoint->history[(endpoint->played_count + n) & mask] = endpoint->block[n];
+        }
+        endpoint->played_count = target;
+    }
+}
+
+/**
+ * Records every connected endpoint up to the medium's clock (minus the recording latency),
+ * each hearing all the other endpoints through the channel model.
+ *
+ * @param medium The medium.
+ * @param end The medium's clock at the end of the simulated block.
+ */
+static void record_endpoints(audio_medium_t* medium, uint64_t end) {
+    float gain = powf(10, -medium->config.attenuation_db / 20);
+
+    for (int i = 0; i < AUDIO_MEDIUM_MAX_ENDPOINTS; ++i) {
+        struct medium_endpoint* listener = &medium->endpoints[i];
+        if (listener->audio == NULL || end < RECORDING_LATENCY_SAMPLES) {
+            continue;
+        }
+
+        uint64_t target = (uint64_t)((double)(end - RECORDING_LATENCY_SAMPLES) * listener->clock_ratio);
+        size_t count = (size_t)(target - listener->recorded_count);
+        for (size_t n = 0; n < count; ++n) {
+            /* The recorded sample's time on the medium's clock. */
+            double time = (double)(listener->recorded_count + n) / listener->clock_ratio;
+
+            /* Sum every other endpoint over every path, sampled at it's own clock. */
+            float sample = 0;
+            for (int j = 0; j < AUDIO_MEDIUM_MAX_ENDPOINTS; ++j) {
+                struct medium_endpoint* speaker = &medium->endpoints[j];
+                if (j == i || speaker->audio == NULL) {
+                    continue;
+                }
+
+                for (uint32_t t = 0; t < medium->taps_count; ++t) {
+                    double position = (time - medium->taps[t].delay_samples) * speaker->clock_ratio;
+                    sample += medium->taps[t].gain * get_played_sample(medium, speaker, position);
+                }
+            }
+
+            listener->block[n] = gain * sample;
+            if (medium->config.noise_level > 0) {
+                listener->block[n] += medium->config.noise_level * next_gaussian(medium);
+            }
+        }
+        listener->recorded_count = target;
+
+        AUDIO__deliver_recording(listener->audio, listener->block, count, listener->is_playing);
+    }
+}
+
+/**
+ * Gets the current monotonic time.
+ *
+ * @return The monotonic time in nanoseconds.
+ */
+static uint64_t monotonic_nanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * Checks whether the users of every connected endpoint are idle.
+ * A medium without any endpoint isn't idle, so it's clock starts with the first endpoint.
+ *
+ * @param medium The medium.
+ * @return Whether all the endpoints are idle.
+ */
+static bool are_endpoints_idle(audio_medium_t* medium) {
+    bool is_connected = false;
+    bool is_idle = true;
+    pthread_mutex_lock(&medium->endpoints_lock);
+    for (int i = 0; i < AUDIO_MEDIUM_MAX_ENDPOINTS && is_idle; ++i) {
+        if (medium->endpoints[i].audio != NULL) {
+            is_connected = true;
+            is_idle = AUDIO__is_idle(medium->endpoints[i].audio);
+        }
+    }
+    pthread_mutex_unlock(&medium->endpoints_lock);
+
+    return is_connected && is_idle;
+}
+
+/**
+ * The medium clock thread.
+ * Simulates a block at a time, pacing the blocks by the configured speed,
+ * or in lock-step mode by waiting for every connected endpoint to be idle.
+ *
+ * @param context The medium.
+ * @return Always NULL.
+ */
+static void* clock_thread_main(void* context) {
+    audio_medium_t* medium = context;
+    uint64_t start = monotonic_nanoseconds();
+    double block_nanoseconds = 1e9 * medium->config.block_size / medium->sample_rate / medium->config.speed;
+    uint64_t blocks = 0;
+
+    while (atomic_load(&medium->is_running)) {
+        /* Simulate the next block. */
+        uint64_t end = atomic_load_explicit(&medium->position, memory_order_relaxed) + medium->config.block_size;
+        pthread_mutex_lock(&medium->endpoints_lock);
+        play_endpoints(medium, end);
+        record_endpoints(medium, end);
+        pthread_mutex_unlock(&medium->endpoints_lock);
+        atomic_store_explicit(&medium->position, end, memory_order_relaxed);
+        blocks++;
+
+        /* In lock-step, wait for the endpoints to handle the block instead of the wall clock. */
+        if (medium->config.lock_step) {
+            struct timespec poll_time = {.tv_sec = 0, .tv_nsec = LOCK_STEP_POLL_NANOSECONDS};
+            while (atomic_load(&medium->is_running) && !are_endpoints_idle(medium)) {
+                nanosleep(&poll_time, NULL);
+            }
+            continue;
+        }
+
+        /* Sleep until the block's (scaled) end time. */
+        uint64_t deadline = start + (uint64_t)(blocks * block_nanoseconds);
+        struct timespec deadline_time = {
+            .tv_sec = (time_t)(deadline / 1000000000ULL),
+            .tv_nsec = (long)(deadline % 1000000000ULL)
+        };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline_time, NULL) == EINTR) {
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Validates a medium configuration.
+ *
+ * @param config The configuration.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int validate_config(const struct audio_medium_config* config) {
+    if (config->block_size == 0 || !(config->speed > 0) || config->noise_level < 0) {
+        LOG_ERROR("Invalid medium block size %u / speed %f / noise %f",
+                  config->block_size, config->speed, config->noise_level);
+        return -1;
+    }
+
+    if (config->echoes_count > AUDIO_MEDIUM_MAX_ECHOES) {
+        LOG_ERROR("Too many medium echoes %u", config->echoes_count);
+        return -1;
+    }
+
+    float max_delay = config->delay_milliseconds;
+    for (uint32_t i = 0; i < config->echoes_count; ++i) {
+        if (config->echoes[i].delay_milliseconds < 0) {
+            LOG_ERROR("Invalid medium echo delay %f", config->echoes[i].delay_milliseconds);
+            return -1;
+        }
+        max_delay = fmaxf(max_delay, config->delay_milliseconds + config->echoes[i].delay_milliseconds);
+    }
+    if (config->delay_milliseconds < 0 || max_delay > AUDIO_MEDIUM_MAX_DELAY_MILLISECONDS) {
+        LOG_ERROR("Invalid medium delay %f", max_delay);
+        return -1;
+    }
+
+    if (fabsf(config->clock_drift_ppm) * (AUDIO_MEDIUM_MAX_ENDPOINTS - 1) > AUDIO_MEDIUM_MAX_CLOCK_DRIFT_PPM) {
+        LOG_ERROR("Invalid medium clock drift %f ppm", config->clock_drift_ppm);
+        return -1;
+    }
+
+    return 0;
+}
+
+audio_medium_t* AUDIO_MEDIUM__initialize(enum standard_sample_rate sample_rate, const struct audio_medium_config* config) {
+    /* Use the default configuration if none is given. */
+    struct audio_medium_config default_config;
+    if (config == NULL) {
+        AUDIO_MEDIUM__get_default_config(&default_config);
+        config = &default_config;
+    }
+
+    /* Validate the configuration. */
+    if (validate_config(config) != 0) {
+        return NULL;
+    }
+
+    /* Allocate the medium struct. */
+    audio_medium_t* medium = malloc(sizeof(audio_medium_t));
+    if (medium == NULL) {
+        LOG_ERROR("Failed to allocate medium struct");
+        return NULL;
+    }
+
+    medium->sample_rate = sample_rate;
+    medium->config = *config;
+    memset(medium->endpoints, 0, sizeof(medium->endpoints));
+    atomic_init(&medium->position, 0);
+    atomic_init(&medium->is_running, true);
+
+    /* The generator's state must never be zero. */
+    medium->noise_state = (config->seed != 0) ? config->seed : 1;
+
+    /* The direct path followed by it's echoes. */
+    double samples_per_millisecond = sample_rate / 1000.0;
+    medium->taps[0].delay_samples = config->delay_milliseconds * samples_per_millisecond;
+    medium->taps[0].gain = 1;
+    for (uint32_t i = 0; i < config->echoes_count; ++i) {
+        medium->taps[i + 1].delay_samples =
+                (config->delay_milliseconds + config->echoes[i].delay_milliseconds) * samples_per_millisecond;
+        medium->taps[i + 1].gain = config->echoes[i].gain;
+    }
+    medium->taps_count = 1 + config->echoes_count;
+
+    /* The histories must hold the longest delayed path of a (drifting) block. */
+    double max_delay_samples = 0;
+    for (uint32_t i = 0; i < medium->taps_count; ++i) {
+        max_delay_samples = fmax(max_delay_samples, medium->taps[i].delay_samples);
+    }
+    medium->block_capacity = config->block_size + config->block_size / 50 + 2;
+    size_t history_needed = (size_t)(max_delay_samples * 1.01) + 2 * medium->block_capacity + RECORDING_LATENCY_SAMPLES;
+    medium->history_size = 1;
+    while (medium->history_size < history_needed) {
+        medium->history_size <<= 1;
+    }
+
+    if (pthread_mutex_init(&medium->endpoints_lock, NULL) != 0) {
+        LOG_ERROR("Failed to initialize medium lock");
+        free(medium);
+        return NULL;
+    }
+
+    /* Start the medium's clock. */
+    if (pthread_create(&medium->clock_thread, NULL, clock_thread_main, medium) != 0) {
+        LOG_ERROR("Failed to start medium clock thread");
+        pthread_mutex_destroy(&medium->endpoints_lock);
+        free(medium);
+        return NULL;
+    }
+
+    return medium;
+}
+
+void AUDIO_MEDIUM__free(audio_medium_t* medium) {
+    if (medium == NULL) {
+        return;
+    }
+
+    /* Stop the medium's clock. */
+    atomic_store(&medium->is_running, false);
+    pthread_join(medium->clock_thread, NULL);
+
+    /* Free any endpoint left connected. */
+    for (int i = 0; i < AUDIO_MEDIUM_MAX_ENDPOINTS; ++i) {
+        if (medium->endpoints[i].audio != NULL) {
+            LOG_WARNING("Freeing medium with a connected audio interface");
+            free(medium->endpoints[i].history);
+            free(medium->endpoints[i].block);
+        }
+    }
+
+    pthread_mutex_destroy(&medium->endpoints_lock);
+    free(medium);
+}
+
+enum standard_sample_rate AUDIO_MEDIUM__get_sample_rate(audio_medium_t* medium) {
+    return medium->sample_rate;
+}
+
+uint64_t AUDIO_MEDIUM__get_position(audio_medium_t* medium) {
+    return atomic_load_explicit(&medium->position, memory_order_relaxed);
+}
+
+int AUDIO_MEDIUM__connect(audio_medium_t* medium, audio_t* audio) {
+    int ret = -1;
+    pthread_mutex_lock(&medium->endpoints_lock);
+
+    /* Find a free endpoint, the endpoint's index sets it's clock drift. */
+    int index = 0;
+    while (index < AUDIO_MEDIUM_MAX_ENDPOINTS && medium->endpoints[index].audio != NULL) {
+        index++;
+    }
+    if (index == AUDIO_MEDIUM_MAX_ENDPOINTS) {
+        LOG_ERROR("The medium has no free endpoint");
+        goto l_cleanup;
+    }
+
+    struct medium_endpoint* endpoint = &medium->endpoints[index];
+    endpoint->history = calloc(medium->history_size, sizeof(float));
+    endpoint->block = malloc(medium->block_capacity * sizeof(float));
+    if (endpoint->history == NULL || endpoint->block == NULL) {
+        LOG_ERROR("Failed to allocate medium endpoint buffers");
+        free(endpoint->history);
+        free(endpoint->block);
+        endpoint->history = NULL;
+        endpoint->block = NULL;
+        goto l_cleanup;
+    }
+
+    /* The endpoint joins at the medium's current time, as if it played and recorded silence until now. */
+    uint64_t position = atomic_load_explicit(&medium->position, memory_order_relaxed);
+    endpoint->clock_ratio = 1 + index * medium->config.clock_drift_ppm * 1e-6;
+    endpoint->played_count = (uint64_t)((double)position * endpoint->clock_ratio);
+    endpoint->recorded_count = (position < RECORDING_LATENCY_SAMPLES) ? 0 :
+            (uint64_t)((double)(position - RECORDING_LATENCY_SAMPLES) * endpoint->clock_ratio);
+    endpoint->is_playing = false;
+    endpoint->audio = audio;
+    ret = 0;
+
+l_cleanup:
+    pthread_mutex_unlock(&medium->endpoints_lock);
+    return ret;
+}
+
+void AUDIO_MEDIUM__disconnect(audio_medium_t* medium, audio_t* audio) {
+    pthread_mutex_lock(&medium->endpoints_lock);
+    for (int i = 0; i < AUDIO_MEDIUM_MAX_ENDPOINTS; ++i) {
+        struct medium_endpoint* endpoint = &medium->endpoints[i];
+        if (endpoint->audio == audio) {
+            free(endpoint->history);
+            free(endpoint->block);
+            memset(endpoint, 0, sizeof(*endpoint));
+        }
+    }
+    pthread_mutex_unlock(&medium->endpoints_lock);
+}
@@ -0,0 +1,132 @@
+/**
+ * Defines a simulated acoustic medium, connecting multiple audio interfaces of a single process without a sound card.
+ * Every interface connected to the medium hears the playback of all the other interfaces through a channel model,
+ * attenuated, delayed, with multipath echoes, additive white gaussian noise and a drifting sample clock.
+ * The medium runs on it's own clock, which may run many times faster than real time, so the whole socket stack
+ * can be exercised and benchmarked headless. The channel is deterministic for a given seed, though on a free running
+ * clock the sample a playback starts at depends on when it's queued. A lock-step clock removes that dependency,
+ * it advances only once every connected interface's user is idle (see `AUDIO__set_idle_callback`).
+ */
+
+#ifndef AUDIONET_AUDIO_MEDIUM_H
+#define AUDIONET_AUDIO_MEDIUM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "audio.h"
+
+/**
+ * The maximum amount of echoes (besides the direct path) in the channel model.
+ */
+#define AUDIO_MEDIUM_MAX_ECHOES (4)
+
+/**
+ * The maximum amount of audio interfaces connected to a medium at once.
+ */
+#define AUDIO_MEDIUM_MAX_ENDPOINTS (8)
+
+/**
+ * The largest total clock drift of an endpoint, in parts per million.
+ */
+#define AUDIO_MEDIUM_MAX_CLOCK_DRIFT_PPM (10000)
+
+/**
+ * The longest delay of the direct path or an echo.
+ */
+#define AUDIO_MEDIUM_MAX_DELAY_MILLISECONDS (2000)
+
+/**
+ * An echo of the direct path, a reflection arriving later and weaker.
+ */
+struct audio_medium_echo {
+    /** How much later than the direct path the echo arrives. */
+    float delay_milliseconds;
+
+    /** The echo's amplitude relative to the direct path. */
+    float gain;
+};
+
+/**
+ * The simulated medium configuration.
+ */
+struct audio_medium_config {
+    /** The amount of samples simulated at once, the period of the simulated devices. */
+    uint32_t block_size;
+
+    /** How many times faster than real time the medium runs, unless it's lock-step. */
+    float speed;
+
+    /**
+     * Whether the clock runs in lock-step with the connected interfaces instead of the wall clock,
+     * simulating the next block only once all of them are idle (every recorded block was handled, and each user is
+     * blocked waiting for a recording or a playback), and only while any is connected.
+     * Runs are then reproducible, though timeouts stay in wall time.
+     */
+    bool lock_step;
+
+    /** The attenuation of the direct path (and it's echoes) between any two endpoints, in dB. */
+    float attenuation_db;
+
+    /** The propagation delay of the direct path. */
+    float delay_milliseconds;
+
+    /** The multipath echoes. */
+    struct audio_medium_echo echoes[AUDIO_MEDIUM_MAX_ECHOES];
+
+    /** The amount of echoes. */
+    uint32_t echoes_count;
+
+    /** The standard deviation of the white gaussian noise added to every recording (signals peak at 1). */
+    float noise_level;
+
+    /**
+     * The sample clock drift between consecutive endpoints, in parts per million.
+     * The n'th connected endpoint's clock runs `n * clock_drift_ppm` fast of the first's (for both playback and recording).
+     */
+    float clock_drift_ppm;
+
+    /** The seed of the noise generator. */
+    uint64_t seed;
+};
+
+/**
+ * Fills a configuration with the default medium settings, an ideal channel running at real time.
+ *
+ * @param config The configuration to fill.
+ */
+void AUDIO_MEDIUM__get_default_config(struct audio_medium_config* config);
+
+/**
+ * Allocates and initializes a simulated medium and starts it's clock.
+ *
+ * @param sample_rate The sample rate of the medium, every connected audio interface plays and records at it.
+ * @param config The medium configuration, or NULL for the defaults.
+ * @return The initialized medium, or NULL on failure.
+ */
+audio_medium_t* AUDIO_MEDIUM__initialize(enum standard_sample_rate sample_rate, const struct audio_medium_config* config);
+
+/**
+ * Stops and frees a simulated medium, every audio interface connected to it must be freed beforehand.
+ *
+ * @param medium The medium to free.
+ */
+void AUDIO_MEDIUM__free(audio_medium_t* medium);
+
+/**
+ * Gets the sample rate of the medium.
+ *
+ * @param medium The medium.
+ * @return The sample rate.
+ */
+enum standard_sample_rate AUDIO_MEDIUM__get_sample_rate(audio_medium_t* medium);
+
+/**
+ * Gets the amount of samples simulated so far, the medium's clock.
+ *
+ * @param medium The medium.
+ * @return The amount of samples simulated.
+ */
+uint64_t AUDIO_MEDIUM__get_position(audio_medium_t* medium);
+
+#endif //AUDIONET_AUDIO_MEDIUM_H
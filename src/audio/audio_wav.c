@@ -0,0 +1,220 @@
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "audio.h"
+#include "internal/audio_backend.h"
+#include "utils/logger.h"
+#include "wav/wav_file.h"
+
+/** How long the streaming thread waits between checks while the interface is stopped. */
+#define STOPPED_POLL_NANOSECONDS (1000000)
+
+struct audio_wav_backend_s {
+    /** The driven audio interface. */
+    audio_t* audio;
+
+    /** The streamed capture file, or NULL to record silence. */
+    wav_reader_t* capture;
+
+    /** The written playback file, or NULL to discard the playback. */
+    wav_writer_t* playback;
+
+    /** The amount of samples streamed at once. */
+    uint32_t block_size;
+
+    /** The duration of a block at the configured speed. */
+    double block_nanoseconds;
+
+    /** Whether the samples recorded while playing are dropped in half duplex. */
+    bool drop_while_playing;
+
+    /** A block of samples played or recorded. */
+    float* block;
+
+    /** Set once the whole capture file has been recorded. */
+    atomic_bool is_capture_finished;
+
+    /** The streaming thread. */
+    pthread_t thread;
+
+    /** Cleared to ask the streaming thread to exit. */
+    atomic_bool is_running;
+};
+
+/**
+ * Gets the current monotonic time.
+ *
+ * @return The monotonic time in nanoseconds.
+ */
+static uint64_t monotonic_nanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * Sleeps until the given monotonic time.
+ *
+ * @param deadline The monotonic time in nanoseconds.
+ */
+static void sleep_until(uint64_t deadline) {
+    struct timespec deadline_time = {
+        .tv_sec = (time_t)(deadline / 1000000000ULL),
+        .tv_nsec = (long)(deadline % 1000000000ULL)
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline_time, NULL) == EINTR) {
+    }
+}
+
+/**
+ * Streams a single block, playing into the playback file and recording from the capture file.
+ *
+ * @param backend The backend.
+ */
+static void stream_block(audio_wav_backend_t* backend) {
+    /* Play the block, a failing playback file is dropped so the stream goes on. */
+    bool is_playing = AUDIO__render_playback(backend->audio, backend->block, backend->block_size);
+    if (backend->playback != NULL && WAV_WRITER__write(backend->playback, backend->block, backend->block_size) != 0) {
+        LOG_ERROR("Failed to write playback file, discarding further playback");
+        WAV_WRITER__free(backend->playback);
+        backend->playback = NULL;
+    }
+
+    /* Record the block, silence follows the end of the capture. The capture file isn't our own playback,
+     * so it's dropped while playing only if asked to be. */
+    size_t recorded = 0;
+    if (backend->capture != NULL) {
+        recorded = WAV_READER__read(backend->capture, backend->block, backend->block_size);
+    }
+    memset(backend->block + recorded, 0, (backend->block_size - recorded) * sizeof(float));
+    AUDIO__deliver_recording(backend->audio, backend->block, backend->block_size,
+                             is_playing && backend->drop_while_playing);
+
+    if (recorded < backend->block_size) {
+        atomic_store_explicit(&backend->is_capture_finished, true, memory_order_release);
+    }
+}
+
+/**
+ * The streaming thread.
+ * Streams a block at a time while the interface is started, pacing the blocks by the configured speed.
+ *
+ * @param context The backend.
+ * @return Always NULL.
+ */
+static void* stream_thread_main(void* context) {
+    audio_wav_backend_t* backend = context;
+    uint64_t start = 0;
+    uint64_t blocks = 0;
+    bool was_started = false;
+
+    while (atomic_load(&backend->is_running)) {
+        /* The files don't advance while the interface is stopped, the pacing restarts once it's started. */
+        if (!AUDIO__is_started(backend->audio)) {
+            was_started = false;
+            sleep_until(monotonic_nanoseconds() + STOPPED_POLL_NANOSECONDS);
+            continue;
+        }
+        if (!was_started) {
+            was_started = true;
+            start = monotonic_nanoseconds();
+            blocks = 0;
+        }
+
+        stream_block(backend);
+        blocks++;
+        sleep_until(start + (uint64_t)(blocks * backend->block_nanoseconds));
+    }
+
+    return NULL;
+}
+
+audio_wav_backend_t* AUDIO_WAV__initialize(audio_t* audio, const struct audio_wav_config* config) {
+    /* Validate parameters. */
+    if (audio == NULL || config == NULL || config->block_size == 0 || !(config->speed > 0)) {
+        LOG_ERROR("Invalid parameters");
+        return NULL;
+    }
+
+    /* Allocate the backend struct. */
+    audio_wav_backend_t* backend = malloc(sizeof(audio_wav_backend_t));
+    if (backend == NULL) {
+        LOG_ERROR("Failed to allocate WAV backend struct");
+        return NULL;
+    }
+    backend->audio = audio;
+    backend->capture = NULL;
+    backend->playback = NULL;
+    backend->block_size = config->block_size;
+    backend->block_nanoseconds = 1e9 * config->block_size / config->sample_rate / config->speed;
+    backend->drop_while_playing = config->drop_while_playing;
+    atomic_init(&backend->is_capture_finished, config->capture_path == NULL);
+    atomic_init(&backend->is_running, true);
+
+    backend->block = malloc(config->block_size * sizeof(float));
+    if (backend->block == NULL) {
+        LOG_ERROR("Failed to allocate WAV backend block");
+        goto l_error;
+    }
+
+    /* Open the files. */
+    if (config->capture_path != NULL) {
+        backend->capture = WAV_READER__initialize(config->capture_path);
+        if (backend->capture == NULL) {
+            LOG_ERROR("Failed to open capture file");
+            goto l_error;
+        }
+        if (WAV_READER__get_sample_rate(backend->capture) != config->sample_rate) {
+            LOG_ERROR("The capture file was recorded at %uHz (expected %dHz)",
+                      WAV_READER__get_sample_rate(backend->capture), config->sample_rate);
+            goto l_error;
+        }
+    }
+    if (config->playback_path != NULL) {
+        backend->playback = WAV_WRITER__initialize(config->playback_path, config->sample_rate);
+        if (backend->playback == NULL) {
+            LOG_ERROR("Failed to create playback file");
+            goto l_error;
+        }
+    }
+
+    /* Start streaming. */
+    if (pthread_create(&backend->thread, NULL, stream_thread_main, backend) != 0) {
+        LOG_ERROR("Failed to start WAV backend thread");
+        goto l_error;
+    }
+
+    return backend;
+
+l_error:
+    WAV_READER__free(backend->capture);
+    WAV_WRITER__free(backend->playback);
+    free(backend->block);
+    free(backend);
+    return NULL;
+}
+
+void AUDIO_WAV__free(audio_wav_backend_t* backend) {
+    if (backend == NULL) {
+        return;
+    }
+
+    /* Stop streaming. */
+    atomic_store(&backend->is_running, false);
+    pthread_join(backend->thread, NULL);
+
+    WAV_READER__free(backend->capture);
+    WAV_WRITER__free(backend->playback);
+    free(backend->block);
+    free(backend);
+}
+
+bool AUDIO_WAV__is_capture_finished(audio_wav_backend_t* backend) {
+    return atomic_load_explicit(&backend->is_capture_finished, memory_order_acquire);
+}
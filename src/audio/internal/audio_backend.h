@@ -0,0 +1,99 @@
+/**
+ * Defines the interface between the audio interface and the backends driving it in place of a sound card,
+ * e.g the simulated medium or the WAV files.
+ * A backend plays the interface's queued playbacks and feeds it recordings on it's own clock.
+ */
+
+#ifndef AUDIONET_AUDIO_BACKEND_H
+#define AUDIONET_AUDIO_BACKEND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "audio/audio.h"
+
+/**
+ * Plays the next mono samples of the interface's queued playbacks.
+ * Outputs silence while the interface is stopped or has nothing queued.
+ *
+ * @param audio The audio interface.
+ * @param output The output buffer to write the samples into.
+ * @param samples_count The amount of samples to play.
+ * @return Whether anything was played.
+ */
+bool AUDIO__render_playback(audio_t* audio, float* output, size_t samples_count);
+
+/**
+ * Passes recorded mono samples to the interface's recording callback.
+ * Dropped while the interface is stopped, or while it's playing unless it's full duplex.
+ *
+ * @param audio The audio interface.
+ * @param input The recorded samples.
+ * @param samples_count The amount of samples recorded.
+ * @param is_playing Whether the interface was playing while the samples were recorded.
+ */
+void AUDIO__deliver_recording(audio_t* audio, const float* input, size_t samples_count, bool is_playing);
+
+/**
+ * Checks whether the interface's user is idle by it's idle callback, an interface without one is idle once started.
+ *
+ * @param audio The audio interface.
+ * @return Whether the user is idle.
+ */
+bool AUDIO__is_idle(audio_t* audio);
+
+/**
+ * Connects an audio interface to the medium, it's played and recorded by the medium's clock until disconnected.
+ *
+ * @param medium The medium.
+ * @param audio The audio interface.
+ * @return 0 On Success, -1 On Failure.
+ */
+int AUDIO_MEDIUM__connect(audio_medium_t* medium, audio_t* audio);
+
+/**
+ * Disconnects an audio interface from the medium, once this returns the medium no longer accesses it.
+ *
+ * @param medium The medium.
+ * @param audio The audio interface.
+ */
+void AUDIO_MEDIUM__disconnect(audio_medium_t* medium, audio_t* audio);
+
+/**
+ * Checks whether the interface has been started (and not stopped since).
+ *
+ * @param audio The audio interface.
+ * @return Whether the interface is started.
+ */
+bool AUDIO__is_started(audio_t* audio);
+
+/**
+ * The WAV file backend type, streaming an interface's recording from a file and it's playback into a file.
+ */
+typedef struct audio_wav_backend_s audio_wav_backend_t;
+
+/**
+ * Opens the backend's files and starts streaming them, the files advance only while the interface is started.
+ *
+ * @param audio The audio interface to drive.
+ * @param config The backend configuration.
+ * @return The initialized backend, or NULL on failure.
+ */
+audio_wav_backend_t* AUDIO_WAV__initialize(audio_t* audio, const struct audio_wav_config* config);
+
+/**
+ * Stops streaming and closes the backend's files, once this returns the backend no longer accesses the interface.
+ *
+ * @param backend The backend to free.
+ */
+void AUDIO_WAV__free(audio_wav_backend_t* backend);
+
+/**
+ * Checks whether the whole capture file has been recorded.
+ *
+ * @param backend The backend.
+ * @return Whether the capture has ended.
+ */
+bool AUDIO_WAV__is_capture_finished(audio_wav_backend_t* backend);
+
+#endif //AUDIONET_AUDIO_BACKEND_H
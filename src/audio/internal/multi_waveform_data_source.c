@@ -2,6 +2,51 @@
 #include "multi_waveform_data_source.h"
 #include "utils/logger.h"
 #include "utils/utils.h"
+#include "utils/vector.h"
+
+/**
+ * Accumulates a buffer into another, `destination += source`.
+ *
+ * @param destination The buffer to accumulate into.
+ * @param source The buffer to accumulate.
+ * @param count The amount of samples in the buffers.
+ */
+static void accumulate_samples(float* destination, const float* source, size_t count) {
+    size_t i = 0;
+    for (; i + FLOAT_VECTOR_LANES <= count; i += FLOAT_VECTOR_LANES) {
+        float_vector_t accumulator;
+        float_vector_t addend;
+        float_vector_load(&accumulator, &destination[i]);
+        float_vector_load(&addend, &source[i]);
+        accumulator += addend;
+        float_vector_store(&destination[i], &accumulator);
+    }
+
+    for (; i < count; ++i) {
+        destination[i] += source[i];
+    }
+}
+
+/**
+ * Scales a buffer in place, `samples *= scale`.
+ *
+ * @param samples The buffer to scale.
+ * @param count The amount of samples in the buffer.
+ * @param scale The scale to multiply by.
+ */
+static void scale_samples(float* samples, size_t count, float scale) {
+    size_t i = 0;
+    for (; i + FLOAT_VECTOR_LANES <= count; i += FLOAT_VECTOR_LANES) {
+        float_vector_t vector;
+        float_vector_load(&vector, &samples[i]);
+        vector *= scale;
+        float_vector_store(&samples[i], &vector);
+    }
+
+    for (; i < count; ++i) {
+        samples[i] *= scale;
+    }
+}
 
 /**
  * Miniaudio API - implements reading of the next audio frame from the multi waveform datasource.
@@ -27,49 +72,51 @@ static ma_result multi_waveform_data_source_read(ma_data_source* pDataSource, vo
         return MA_ERROR;
     }
 
-    /* We initialize the buffer to silence in case we wouldn't fill it all. */
-    ma_silence_pcm_frames(pFramesOut, frameCount, dataSource->format, dataSource->channels);
-
     /* The actual amount of frames we will output may be lower than frameCount if we reach the end of the stream. */
     ma_uint64 frames_to_output = min(frameCount, dataSource->length_frames - dataSource->frame_cursor);
     if (frames_to_output == 0) {
         /* In case there's nothing more to output. */
+        ma_silence_pcm_frames(pFramesOut, frameCount, dataSource->format, dataSource->channels);
         return MA_AT_END;
     }
 
-    /* We allocate a temporary buffer for mixing the different waveforms. */
-    void* temp = malloc(frames_to_output * ma_get_bytes_per_sample(dataSource->format) * dataSource->channels);
-    if (temp == NULL) {
-        LOG_ERROR("Failed to allocate temporary output calculation buffer");
-        return MA_ERROR;
-    }
+    /* Synthesize in chunks that fit the scratch buffer,
+     * the first waveform is read directly into the output and the others are accumulated on top of it. */
+    ma_result result = MA_SUCCESS;
+    float scale = 1.0f / (float)dataSource->waveforms_count;
+    for (ma_uint64 chunk_start = 0; chunk_start < frames_to_output; chunk_start += MULTI_WAVEFORM_SCRATCH_FRAMES) {
+        ma_uint64 chunk_frames = min(frames_to_output - chunk_start, MULTI_WAVEFORM_SCRATCH_FRAMES);
+        size_t chunk_samples = chunk_frames * dataSource->channels;
+        float* output = (float*)pFramesOut + chunk_start * dataSource->channels;
+
+        for (int i = 0; i < dataSource->waveforms_count; ++i) {
+            /* There's no need to check the waveform's actual read output since on success they always fill the buffer. */
+            float* destination = (i == 0) ? output : dataSource->scratch;
+            result = ma_waveform_read_pcm_frames(&dataSource->waveforms[i], destination, chunk_frames, NULL);
+            if (result != MA_SUCCESS) {
+                LOG_ERROR("Failed to read from waveform");
+                return result;
+            }
 
-    ma_result result;
-    for (int i = 0; i < dataSource->waveforms_count; ++i) {
-        /* There's no need to check the waveform's actual read output since on success they always fill the buffer. */
-        result = ma_waveform_read_pcm_frames(&dataSource->waveforms[i], temp, frames_to_output, NULL);
-        if (result != MA_SUCCESS) {
-            LOG_ERROR("Failed to read from waveform");
-            goto l_cleanup;
+            if (i != 0) {
+                accumulate_samples(output, dataSource->scratch, chunk_samples);
+            }
         }
 
         /* Mix the waveforms together with a simple average. */
-        for (int j = 0; j < frames_to_output * dataSource->channels; j++) {
-            ((float*)pFramesOut)[j] += ((float*)temp)[j] / (float) dataSource->waveforms_count;
-        }
+        scale_samples(output, chunk_samples, scale);
     }
 
+    /* Fill the rest with silence in case we've reached the end of the stream. */
+    ma_silence_pcm_frames((float*)pFramesOut + frames_to_output * dataSource->channels,
+                          frameCount - frames_to_output, dataSource->format, dataSource->channels);
+
     /* Update the cursor with the last frame size. */
     dataSource->frame_cursor += frames_to_output;
     if (pFramesRead != NULL) {
         *pFramesRead = frames_to_output;
     }
 
-l_cleanup:
-    if (temp != NULL) {
-        free(temp);
-    }
-
     return result;
 }
 
@@ -207,12 +254,21 @@ ma_result multi_waveform_data_source_init(
     temp_multi_waveform->length_frames = length_frames;
     temp_multi_waveform->frame_cursor = 0;
     temp_multi_waveform->waveforms = malloc(frequencies_count * sizeof(ma_waveform));
-    if (temp_multi_waveform == NULL) {
+    if (temp_multi_waveform->waveforms == NULL) {
         LOG_ERROR("Failed to allocate waveforms");
         free(temp_multi_waveform);
         return MA_ERROR;
     }
 
+    /* Allocate the mixing scratch buffer ahead, so reading (on the audio callback) never allocates. */
+    temp_multi_waveform->scratch = malloc(MULTI_WAVEFORM_SCRATCH_FRAMES * channels * sizeof(float));
+    if (temp_multi_waveform->scratch == NULL) {
+        LOG_ERROR("Failed to allocate mixing scratch buffer");
+        free(temp_multi_waveform->waveforms);
+        free(temp_multi_waveform);
+        return MA_ERROR;
+    }
+
     /* Initialize the multi-waveform as a miniaudio datasource */
     ma_data_source_config baseConfig = ma_data_source_config_init();
     baseConfig.vtable = &g_multi_waveform_data_source_vtable;
@@ -249,6 +305,8 @@ l_cleanup:
             temp_multi_waveform->waveforms = NULL;
         }
 
+        free(temp_multi_waveform->scratch);
+
         free(temp_multi_waveform);
         temp_multi_waveform = NULL;
     }
@@ -264,6 +322,7 @@ void multi_waveform_data_source_uninit(struct multi_waveform_data_source* pMulti
     }
 
     free(pMultiWaveformDataSource->waveforms);
+    free(pMultiWaveformDataSource->scratch);
 
     /* Uninitialize the multi-waveform and free it */
     ma_data_source_uninit(&pMultiWaveformDataSource->base);
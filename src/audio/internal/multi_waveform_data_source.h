@@ -8,6 +8,12 @@
 
 #include "miniaudio/miniaudio.h"
 
+/**
+ * The amount of frames synthesized at a time into the mixing scratch buffer,
+ * longer reads are mixed in chunks of this size.
+ */
+#define MULTI_WAVEFORM_SCRATCH_FRAMES (1024)
+
 /**
  * A datasource overlaying multiple waveforms together.
  */
@@ -32,6 +38,9 @@ struct multi_waveform_data_source {
 
     /** The current frame index */
     ma_uint32 frame_cursor;
+
+    /** Scratch buffer for mixing, `MULTI_WAVEFORM_SCRATCH_FRAMES` frames long, allocated at init */
+    float* scratch;
 };
 
 
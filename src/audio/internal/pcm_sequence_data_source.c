@@ -0,0 +1,228 @@
+#include <string.h>
+
+#include "pcm_sequence_data_source.h"
+#include "utils/logger.h"
+#include "utils/utils.h"
+
+/**
+ * Miniaudio API - implements reading of the next audio frames from the PCM sequence datasource.
+ *
+ * @param pDataSource The PCM sequence datasource to read from.
+ * @param pFramesOut The sound buffer to write to.
+ * @param frameCount The size of the output sound buffer.
+ * @param pFramesRead Returns the amount of frames written to the output sound buffer.
+ * @return MA_SUCCESS on success, other enum values otherwise.
+ */
+static ma_result pcm_sequence_data_source_read(ma_data_source* pDataSource, void* pFramesOut, ma_uint64 frameCount, ma_uint64* pFramesRead) {
+    if (frameCount == 0 || pDataSource == NULL) {
+        return MA_INVALID_ARGS;
+    }
+
+    if (pFramesRead != NULL) {
+        *pFramesRead = 0;
+    }
+
+    struct pcm_sequence_data_source* dataSource = pDataSource;
+    if (dataSource->frame_cursor >= dataSource->length_frames) {
+        /* In case there's nothing more to output. */
+        ma_silence_pcm_frames(pFramesOut, frameCount, ma_format_f32, dataSource->channels);
+        return MA_AT_END;
+    }
+
+    /* Copy from the segments until either the output or the segments are exhausted. */
+    float* output = pFramesOut;
+    ma_uint64 frames_written = 0;
+    while (frames_written < frameCount && dataSource->segment_index < dataSource->segments_count) {
+        const struct pcm_segment_s* segment = &dataSource->segments[dataSource->segment_index];
+        ma_uint64 frames_to_copy = min(frameCount - frames_written, segment->samples_count - dataSource->segment_cursor);
+        const float* samples = segment->samples + dataSource->segment_cursor;
+
+        if (dataSource->channels == 1) {
+            memcpy(output, samples, frames_to_copy * sizeof(float));
+        } else {
+            for (ma_uint64 i = 0; i < frames_to_copy; ++i) {
+                for (ma_uint32 channel = 0; channel < dataSource->channels; ++channel) {
+                    output[i * dataSource->channels + channel] = samples[i];
+                }
+            }
+        }
+
+        output += frames_to_copy * dataSource->channels;
+        frames_written += frames_to_copy;
+
+        /* Move on to the next segment once this one is done. */
+        dataSource->segment_cursor += frames_to_copy;
+        if (dataSource->segment_cursor == segment->samples_count) {
+            dataSource->segment_index++;
+            dataSource->segment_cursor = 0;
+        }
+    }
+
+    /* Fill the rest with silence in case we've reached the end of the sequence. */
+    ma_silence_pcm_frames(output, frameCount - frames_written, ma_format_f32, dataSource->channels);
+
+    /* Update the cursor with the last frame size. */
+    dataSource->frame_cursor += frames_written;
+    if (pFramesRead != NULL) {
+        *pFramesRead = frames_written;
+    }
+
+    return MA_SUCCESS;
+}
+
+/**
+ * Miniaudio API - Seek to a specific frame in the datasource.
+ *
+ * @param pDataSource The PCM sequence datasource to seek.
+ * @param frameIndex The frame index to seek to.
+ * @return MA_SUCCESS on success, other enum values otherwise.
+ */
+static ma_result pcm_sequence_data_source_seek(ma_data_source* pDataSource, ma_uint64 frameIndex) {
+    if (pDataSource == NULL) {
+        return MA_INVALID_ARGS;
+    }
+
+    struct pcm_sequence_data_source* dataSource = pDataSource;
+    if (frameIndex > dataSource->length_frames) {
+        LOG_ERROR("Failed to seek PCM sequence from %llu to %llu", dataSource->frame_cursor, frameIndex);
+        return MA_INVALID_ARGS;
+    }
+
+    /* Find the segment containing the frame. */
+    ma_uint64 remaining = frameIndex;
+    dataSource->segment_index = 0;
+    while (dataSource->segment_index < dataSource->segments_count &&
+           remaining >= dataSource->segments[dataSource->segment_index].samples_count) {
+        remaining -= dataSource->segments[dataSource->segment_index].samples_count;
+        dataSource->segment_index++;
+    }
+
+    dataSource->segment_cursor = (ma_uint32)remaining;
+    dataSource->frame_cursor = frameIndex;
+
+    return MA_SUCCESS;
+}
+
+/**
+ * Miniaudio API - Get the datasource data format and configurations.
+ *
+ * @param pDataSource The PCM sequence to get it's configurations
+ * @param pFormat Returns the data format of the datasource.
+ * @param pChannels Returns the channel count of the datasource.
+ * @param pSampleRate Returns the sample rate of the datasource.
+ * @param pChannelMap Returns the channel mapping of the datasource.
+ * @param channelMapCap The length of the channelMap parameter.
+ * @return MA_SUCCESS on success, other enum values otherwise.
+ */
+static ma_result pcm_sequence_data_source_get_data_format(ma_data_source* pDataSource, ma_format* pFormat, ma_uint32* pChannels, ma_uint32* pSampleRate, ma_channel* pChannelMap, size_t channelMapCap)
+{
+    if (pDataSource == NULL) {
+        return MA_INVALID_ARGS;
+    }
+
+    struct pcm_sequence_data_source* dataSource = pDataSource;
+    if (pFormat != NULL) {
+        *pFormat = ma_format_f32;
+    }
+
+    if (pChannels != NULL) {
+        *pChannels = dataSource->channels;
+    }
+
+    if (pSampleRate != NULL) {
+        *pSampleRate = dataSource->sample_rate;
+    }
+
+    if (pChannelMap != NULL) {
+        ma_channel_map_init_standard(ma_standard_channel_map_default, pChannelMap, channelMapCap, dataSource->channels);
+    }
+
+    return MA_SUCCESS;
+}
+
+/**
+ * Miniaudio API - Get the current position of the cursor.
+ *
+ * @param pDataSource The PCM sequence to get it's cursor position.
+ * @param pCursor Returns the current cursor value of the data source.
+ * @return MA_SUCCESS on success, other enum values otherwise.
+ */
+static ma_result pcm_sequence_data_source_get_cursor(ma_data_source* pDataSource, ma_uint64* pCursor) {
+    if (pDataSource == NULL) {
+        return MA_INVALID_ARGS;
+    }
+
+    struct pcm_sequence_data_source* data_source = pDataSource;
+    if (pCursor != NULL) {
+        *pCursor = data_source->frame_cursor;
+    }
+
+    return MA_SUCCESS;
+}
+
+/**
+ * Miniaudio API - Get the length of the datasource in PCM frames.
+ *
+ * @param pDataSource The PCM sequence to get it's length.
+ * @param pLength Returns the length of the data source.
+ * @return MA_SUCCESS on success, other enum values otherwise.
+ */
+static ma_result pcm_sequence_data_source_get_length(ma_data_source* pDataSource, ma_uint64* pLength) {
+    if (pDataSource == NULL) {
+        return MA_INVALID_ARGS;
+    }
+
+    struct pcm_sequence_data_source* data_source = pDataSource;
+    if (pLength != NULL) {
+        *pLength = data_source->length_frames;
+    }
+
+    return MA_SUCCESS;
+}
+
+/**
+ * This configures the API of the PCM sequence datasource for Miniaudio.
+ */
+static ma_data_source_vtable g_pcm_sequence_data_source_vtable = {
+        pcm_sequence_data_source_read,
+        pcm_sequence_data_source_seek,
+        pcm_sequence_data_source_get_data_format,
+        pcm_sequence_data_source_get_cursor,
+        pcm_sequence_data_source_get_length
+};
+
+ma_result pcm_sequence_data_source_init(
+        struct pcm_sequence_data_source* data_source, ma_uint32 channels, ma_uint32 sampleRate,
+        const struct pcm_segment_s* segments, ma_uint32 segments_count
+) {
+    /* Validate parameters constraints */
+    if (data_source == NULL || channels == 0 || (segments == NULL && segments_count != 0)) {
+        return MA_INVALID_ARGS;
+    }
+
+    data_source->segments = segments;
+    data_source->segments_count = segments_count;
+    data_source->channels = channels;
+    data_source->sample_rate = sampleRate;
+    data_source->segment_index = 0;
+    data_source->segment_cursor = 0;
+    data_source->frame_cursor = 0;
+    data_source->length_frames = 0;
+    for (ma_uint32 i = 0; i < segments_count; ++i) {
+        data_source->length_frames += segments[i].samples_count;
+    }
+
+    /* Initialize the sequence as a miniaudio datasource */
+    ma_data_source_config baseConfig = ma_data_source_config_init();
+    baseConfig.vtable = &g_pcm_sequence_data_source_vtable;
+    ma_result result = ma_data_source_init(&baseConfig, &data_source->base);
+    if (result != MA_SUCCESS) {
+        LOG_ERROR("Failed to initialize PCM sequence data_source_base");
+    }
+
+    return result;
+}
+
+void pcm_sequence_data_source_uninit(struct pcm_sequence_data_source* data_source) {
+    ma_data_source_uninit(&data_source->base);
+}
@@ -0,0 +1,69 @@
+/**
+ * This file defines a new kind of `datasource` for the miniaudio library to use.
+ * The application of this datasource is to play a sequence of pre-rendered PCM segments back to back.
+ */
+
+#ifndef AUDIONET_PCM_SEQUENCE_DATA_SOURCE_H
+#define AUDIONET_PCM_SEQUENCE_DATA_SOURCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "miniaudio/miniaudio.h"
+#include "audio/audio.h"
+
+/**
+ * A datasource playing mono PCM segments in succession, duplicated to every output channel.
+ */
+struct pcm_sequence_data_source {
+    /** Miniaudio datasource base */
+    ma_data_source_base base;
+
+    /** The segments to play, owned by the user */
+    const struct pcm_segment_s* segments;
+
+    /** The amount of segments */
+    ma_uint32 segments_count;
+
+    /** The amount of channels to output */
+    ma_uint32 channels;
+
+    /** The sample rate the segments were rendered at */
+    ma_uint32 sample_rate;
+
+    /** The total amount of frames in all the segments */
+    ma_uint64 length_frames;
+
+    /** The index of the segment currently being played */
+    ma_uint32 segment_index;
+
+    /** The current frame index in the current segment */
+    ma_uint32 segment_cursor;
+
+    /** The current frame index */
+    ma_uint64 frame_cursor;
+};
+
+/**
+ * Initializes a PCM sequence datasource in place, no allocations are made.
+ *
+ * @param data_source The datasource to initialize.
+ * @param channels The amount of channels to output.
+ * @param sampleRate The sample rate the segments were rendered at.
+ * @param segments The segments to play, must stay valid until the datasource is uninitialized.
+ * @param segments_count The amount of segments.
+ * @return MA_SUCCESS on success, other enum values otherwise.
+ */
+ma_result pcm_sequence_data_source_init(
+    struct pcm_sequence_data_source* data_source, ma_uint32 channels, ma_uint32 sampleRate,
+    const struct pcm_segment_s* segments, ma_uint32 segments_count
+);
+
+/**
+ * Uninitializes a PCM sequence datasource previously initialized with pcm_sequence_data_source_init.
+ *
+ * @param data_source The datasource to uninitialize.
+ */
+void pcm_sequence_data_source_uninit(struct pcm_sequence_data_source* data_source);
+
+#endif //AUDIONET_PCM_SEQUENCE_DATA_SOURCE_H
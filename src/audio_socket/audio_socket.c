@@ -1,4 +1,6 @@
 #include <malloc.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "utils/logger.h"
 #include "audio_socket.h"
@@ -7,19 +9,9 @@
 #include "audio_socket/layers/transport/transport_layer.h"
 
 /**
- * Defines the list of the different layers possible for the audio socket.
- * We can later decide which layer we want to use for debugging purposes.
+ * The socket layer used by default, lower layers can be chosen by the configuration for debugging.
  */
-enum audio_socket_layer {
-    AUDIO_LAYER_PHYSICAL,
-    AUDIO_LAYER_LINK,
-    AUDIO_LAYER_TRANSPORT,
-};
-
-/**
- * Here we can define the socket layer that will be used, useful for debugging lower layers.
- */
-#define SOCKET_LAYER (AUDIO_LAYER_TRANSPORT)
+#define DEFAULT_SOCKET_LAYER (AUDIO_LAYER_TRANSPORT)
 
 struct audio_socket_s {
     /** The layer at which the socket operates */
@@ -35,7 +27,33 @@ struct audio_socket_s {
     audio_transport_layer_socket_t * transport_layer;
 };
 
-audio_socket_t *AUDIO_SOCKET__initialize() {
+void AUDIO_SOCKET__get_default_config(struct audio_socket_config* config) {
+    config->layer = DEFAULT_SOCKET_LAYER;
+    PHYSICAL_LAYER__get_default_config(&config->physical);
+    LINK_LAYER__get_default_config(&config->link);
+    TRANSPORT_LAYER__get_default_config(&config->transport);
+}
+
+int AUDIO_SOCKET__warm_cache(const struct audio_socket_config* config) {
+    /* Every layer is built over the physical layer, which holds all of the caches */
+    return PHYSICAL_LAYER__warm_cache(config == NULL ? NULL : &config->physical);
+}
+
+audio_socket_t *AUDIO_SOCKET__initialize(const struct audio_socket_config* config) {
+    /* Use the default configuration if none is given */
+    struct audio_socket_config default_config;
+    if (config == NULL) {
+        AUDIO_SOCKET__get_default_config(&default_config);
+        config = &default_config;
+    }
+
+    /* Validate the configuration */
+    if (config->layer != AUDIO_LAYER_PHYSICAL && config->layer != AUDIO_LAYER_LINK &&
+            config->layer != AUDIO_LAYER_TRANSPORT) {
+        LOG_ERROR("Invalid audio socket layer %d", config->layer);
+        return NULL;
+    }
+
     /* Allocate the socket object */
     audio_socket_t* socket = malloc(sizeof(audio_socket_t));
     if (socket == NULL) {
@@ -44,10 +62,13 @@ audio_socket_t *AUDIO_SOCKET__initialize() {
     }
 
     /* Initialize the chosen layer, the rest will be uninitialized */
-    socket->layer = SOCKET_LAYER;
+    socket->layer = config->layer;
+    socket->physical_layer = NULL;
+    socket->link_layer = NULL;
+    socket->transport_layer = NULL;
     switch (socket->layer) {
         case AUDIO_LAYER_PHYSICAL:
-            socket->physical_layer = PHYSICAL_LAYER__initialize();
+            socket->physical_layer = PHYSICAL_LAYER__initialize(&config->physical);
             if (socket->physical_layer == NULL) {
                 free(socket);
                 LOG_ERROR("Failed to initialize audio socket physical layer");
@@ -55,7 +76,7 @@ audio_socket_t *AUDIO_SOCKET__initialize() {
             }
             break;
         case AUDIO_LAYER_LINK:
-            socket->link_layer = LINK_LAYER__initialize();
+            socket->link_layer = LINK_LAYER__initialize(&config->physical, &config->link);
             if (socket->link_layer == NULL) {
                 free(socket);
                 LOG_ERROR("Failed to initialize audio socket link layer");
@@ -63,7 +84,7 @@ audio_socket_t *AUDIO_SOCKET__initialize() {
             }
             break;
         case AUDIO_LAYER_TRANSPORT:
-            socket->transport_layer = TRANSPORT_LAYER__initialize();
+            socket->transport_layer = TRANSPORT_LAYER__initialize(&config->physical, &config->link, &config->transport);
             if (socket->transport_layer == NULL) {
                 free(socket);
                 LOG_ERROR("Failed to initialize audio socket transport layer");
@@ -110,6 +131,9 @@ int AUDIO_SOCKET__send(audio_socket_t *socket, void *data, size_t size) {
             return LINK_LAYER__send(socket->link_layer, data, size);
         case AUDIO_LAYER_TRANSPORT:
             return TRANSPORT_LAYER__send(socket->transport_layer, data, size);
+        default:
+            LOG_ERROR("Invalid audio socket layer %d", socket->layer);
+            return -1;
     }
 }
 
@@ -122,5 +146,69 @@ ssize_t AUDIO_SOCKET__recv(audio_socket_t *socket, void *data, size_t size) {
             return LINK_LAYER__recv(socket->link_layer, data, size);
         case AUDIO_LAYER_TRANSPORT:
             return TRANSPORT_LAYER__recv(socket->transport_layer, data, size);
+        default:
+            LOG_ERROR("Invalid audio socket layer %d", socket->layer);
+            return -1;
+    }
+}
+
+ssize_t AUDIO_SOCKET__recv_nonblocking(audio_socket_t *socket, void *data, size_t size) {
+    /* Receive data without waiting using the appropriate socket layer.  */
+    switch (socket->layer) {
+        case AUDIO_LAYER_PHYSICAL:
+            return PHYSICAL_LAYER__recv_nonblocking(socket->physical_layer, data, size);
+        case AUDIO_LAYER_LINK:
+            return LINK_LAYER__recv_nonblocking(socket->link_layer, data, size);
+        case AUDIO_LAYER_TRANSPORT:
+            return TRANSPORT_LAYER__recv_nonblocking(socket->transport_layer, data, size);
+        default:
+            LOG_ERROR("Invalid audio socket layer %d", socket->layer);
+            return -1;
+    }
+}
+
+int AUDIO_SOCKET__get_ready_fd(audio_socket_t *socket) {
+    /* Every layer is built over the physical layer, which owns the descriptor.  */
+    switch (socket->layer) {
+        case AUDIO_LAYER_PHYSICAL:
+            return PHYSICAL_LAYER__get_ready_fd(socket->physical_layer);
+        case AUDIO_LAYER_LINK:
+            return LINK_LAYER__get_ready_fd(socket->link_layer);
+        case AUDIO_LAYER_TRANSPORT:
+            return TRANSPORT_LAYER__get_ready_fd(socket->transport_layer);
+        default:
+            LOG_ERROR("Invalid audio socket layer %d", socket->layer);
+            return -1;
+    }
+}
+
+size_t AUDIO_SOCKET__get_mtu(audio_socket_t *socket) {
+    /* The transport layer splits messages into as many packets as needed.  */
+    switch (socket->layer) {
+        case AUDIO_LAYER_PHYSICAL:
+            return PHYSICAL_LAYER_MTU;
+        case AUDIO_LAYER_LINK:
+            return LINK_LAYER__get_mtu(socket->link_layer);
+        case AUDIO_LAYER_TRANSPORT:
+            return SIZE_MAX;
+        default:
+            LOG_ERROR("Invalid audio socket layer %d", socket->layer);
+            return 0;
+    }
+}
+
+void AUDIO_SOCKET__get_stats(audio_socket_t *socket, struct audio_socket_stats* stats) {
+    /* Each layer fills it's own counters and those of the layers below it.  */
+    memset(stats, 0, sizeof(*stats));
+    switch (socket->layer) {
+        case AUDIO_LAYER_PHYSICAL:
+            PHYSICAL_LAYER__get_stats(socket->physical_layer, &stats->physical);
+            break;
+        case AUDIO_LAYER_LINK:
+            LINK_LAYER__get_stats(socket->link_layer, &stats->link, &stats->physical);
+            break;
+        case AUDIO_LAYER_TRANSPORT:
+            TRANSPORT_LAYER__get_stats(socket->transport_layer, &stats->transport, &stats->link, &stats->physical);
+            break;
     }
 }
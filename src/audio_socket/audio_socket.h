@@ -3,18 +3,85 @@
 
 #include <stdbool.h>
 #include <sys/types.h>
+#include "layers/physical/physical_layer.h"
+#include "layers/link/link_layer.h"
+#include "layers/transport/transport_layer.h"
 
 /**
  * The audio socket type.
  */
 typedef struct audio_socket_s audio_socket_t;
 
+/**
+ * Defines the list of the different layers possible for the audio socket.
+ * The lower layers are useful for debugging and measuring the layers below the transport.
+ */
+enum audio_socket_layer {
+    /** Single frames (up to `PHYSICAL_LAYER_MTU` bytes), sent as is. */
+    AUDIO_LAYER_PHYSICAL,
+
+    /** Packets (up to the link layer's MTU), optionally error corrected and CRC checked, without retransmission. */
+    AUDIO_LAYER_LINK,
+
+    /** Messages of any length, delivered reliably by acks and retransmission. */
+    AUDIO_LAYER_TRANSPORT,
+};
+
+/**
+ * The audio socket configuration, chosen at socket initialization.
+ */
+struct audio_socket_config {
+    /** The layer at which the socket operates, both peers must use the same layer. */
+    enum audio_socket_layer layer;
+
+    /** The configuration of the physical layer (used by every socket layer). */
+    struct physical_layer_config physical;
+
+    /** The configuration of the link layer (used if the socket operates at the link or transport layer). */
+    struct link_layer_config link;
+
+    /** The configuration of the transport layer (used if the socket operates at the transport layer). */
+    struct transport_layer_config transport;
+};
+
+/**
+ * Runtime counters of the audio socket, by layer.
+ * Only the counters of the socket's layer and the layers below it are filled, the rest are zeroed.
+ */
+struct audio_socket_stats {
+    /** The counters of the physical layer. */
+    struct physical_layer_stats physical;
+
+    /** The counters of the link layer. */
+    struct link_layer_stats link;
+
+    /** The counters of the transport layer. */
+    struct transport_layer_stats transport;
+};
+
+/**
+ * Fills a configuration with the default socket settings.
+ *
+ * @param config The configuration to fill.
+ */
+void AUDIO_SOCKET__get_default_config(struct audio_socket_config* config);
+
+/**
+ * Prepares the caches sockets with the given configuration use (e.g FFT plans), so later sockets start up quickly.
+ * Meant to be run once, ahead of short-lived senders and receivers.
+ *
+ * @param config The socket configuration to prepare for, or NULL for the defaults.
+ * @return 0 On Success, -1 On Failure.
+ */
+int AUDIO_SOCKET__warm_cache(const struct audio_socket_config* config);
+
 /**
  * Initializes a new audio socket.
  *
+ * @param config The socket configuration, or NULL for the defaults.
  * @return The initialized audio socket.
  */
-audio_socket_t* AUDIO_SOCKET__initialize();
+audio_socket_t* AUDIO_SOCKET__initialize(const struct audio_socket_config* config);
 
 /**
  * Frees an audio socket.
@@ -43,4 +110,44 @@ int AUDIO_SOCKET__send(audio_socket_t* socket, void* data, size_t size);
  */
 ssize_t AUDIO_SOCKET__recv(audio_socket_t* socket, void* data, size_t size);
 
+/**
+ * Receives the data that has already arrived on the socket, without waiting.
+ * Meant to be called when the readiness descriptor (`AUDIO_SOCKET__get_ready_fd`) is readable.
+ * Since a message is made of multiple frames, a readable descriptor may still not complete a message,
+ * the same buffer must be given to each call until it does.
+ *
+ * @param socket The socket.
+ * @param data Returns the data received.
+ * @param size The size of the data buffer.
+ * @return The amount of bytes received on success, `RECV_WOULD_BLOCK_RET_CODE` if the data isn't complete yet,
+ *         another negative value on failure.
+ */
+ssize_t AUDIO_SOCKET__recv_nonblocking(audio_socket_t* socket, void* data, size_t size);
+
+/**
+ * Gets the socket's readiness descriptor, for multiplexing many sockets (and timers) with poll/select/epoll.
+ * The descriptor is readable (level-triggered) while there are received frames waiting to be handled.
+ * It's owned by the socket, the user shouldn't read from or close it.
+ *
+ * @param socket The socket.
+ * @return The readiness file descriptor.
+ */
+int AUDIO_SOCKET__get_ready_fd(audio_socket_t* socket);
+
+/**
+ * Gets the maximal length of a buffer sent over the socket, which depends on the socket's layer.
+ *
+ * @param socket The socket.
+ * @return The maximal length of a sent buffer, `SIZE_MAX` if there's no limit.
+ */
+size_t AUDIO_SOCKET__get_mtu(audio_socket_t* socket);
+
+/**
+ * Gets a snapshot of the socket's counters.
+ *
+ * @param socket The socket to query.
+ * @param stats Returns the counters.
+ */
+void AUDIO_SOCKET__get_stats(audio_socket_t* socket, struct audio_socket_stats* stats);
+
 #endif //AUDIONET_AUDIO_SOCKET_H
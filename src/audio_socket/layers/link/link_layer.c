@@ -5,6 +5,7 @@
 
 #include "link_layer.h"
 #include "audio_socket/layers/physical/physical_layer.h"
+#include "crc/crc32c.h"
 #include "utils/logger.h"
 #include "utils/utils.h"
 
@@ -14,10 +15,14 @@
 /** The maximum size of a single link packet (over multiple physical frames). */
 #define MAX_LINK_PACKET_SIZE (MAX_LINK_FRAMES * (PHYSICAL_LAYER_MTU - 1))
 
-struct audio_link_layer_socket_s {
-    /** The link layer uses the physical layer to send frames. */
-    audio_physical_layer_socket_t* physical_layer;
-};
+/** The amount of packet bytes carried by each frame (after it's sequence number). */
+#define LINK_FRAME_DATA_SIZE (PHYSICAL_LAYER_MTU - 1)
+
+/**
+ * The largest jump in sequence numbers an error corrected packet takes as lost frames,
+ * a frame with a larger jump is taken as having a corrupted sequence number.
+ */
+#define MAX_LOST_FRAMES_JUMP (4)
 
 /**
  * The structure of a single physical frame sent/received as part of the link packet.
@@ -38,7 +43,122 @@ struct link_packet_header_s {
     uint32_t data_length;
 } __attribute__((packed));
 
-audio_link_layer_socket_t *LINK_LAYER__initialize() {
+/**
+ * The structure of a link packet trailer, set after the data if the CRC is enabled.
+ */
+struct link_packet_trailer_s {
+    /** The CRC32C of the packet's header and data. */
+    uint32_t crc;
+} __attribute__((packed));
+
+/**
+ * The state of the packet currently being received, kept across non-blocking receives.
+ */
+struct link_recv_state {
+    /** The header of the packet, filled from the first frames. */
+    struct link_packet_header_s header;
+
+    /** The amount of header bytes received. */
+    size_t header_written;
+
+    /** The amount of data bytes received (those beyond the user's buffer are dropped). */
+    size_t data_received;
+
+    /** The trailer of the packet, filled from the last frames. */
+    struct link_packet_trailer_s trailer;
+
+    /** The amount of trailer bytes received. */
+    size_t trailer_written;
+
+    /** The CRC of the header and data received so far. */
+    uint32_t crc;
+
+    /** The expected sequence number of the next frame. */
+    uint8_t seq;
+};
+
+/**
+ * The state of the error corrected packet currently being received, kept across non-blocking receives.
+ * The frames are placed by their sequence number, so a lost frame leaves a gap of erasures for the correction to fill.
+ */
+struct link_coded_recv_state {
+    /** The packet's codewords, as received so far. */
+    uint8_t stream[MAX_LINK_PACKET_SIZE];
+
+    /** Whether each byte of `stream` is erased (never received, or received unreliably). */
+    bool erased[MAX_LINK_PACKET_SIZE];
+
+    /** Whether any frame of the packet has been received. */
+    bool is_started;
+
+    /** The index of the next expected frame, it's sequence number on the wire is the index's low byte. */
+    size_t seq;
+
+    /** The amount of frames in the packet, known once the header's codeword is corrected (0 until then). */
+    size_t frames_count;
+
+    /** The length of the packet's data, read from the corrected header. */
+    uint32_t data_length;
+};
+
+struct audio_link_layer_socket_s {
+    /** The link layer uses the physical layer to send frames. */
+    audio_physical_layer_socket_t* physical_layer;
+
+    /** The packet currently being received. */
+    struct link_recv_state recv_state;
+
+    /** The error correction codec, NULL if the socket sends no parity. */
+    reed_solomon_t* codec;
+
+    /** The amount of parity bytes in each codeword. */
+    uint32_t parity_bytes;
+
+    /** Whether the packets end with a CRC trailer. */
+    bool is_crc_enabled;
+
+    /** The error corrected packet currently being received. */
+    struct link_coded_recv_state coded_recv_state;
+
+    /** The socket's counters. */
+    struct link_layer_stats stats;
+};
+
+/**
+ * Resets the error corrected receive state, for a new packet.
+ *
+ * @param state The state to reset.
+ */
+static void reset_coded_recv_state(struct link_coded_recv_state* state) {
+    memset(state->erased, true, sizeof(state->erased));
+    state->is_started = false;
+    state->seq = 0;
+    state->frames_count = 0;
+    state->data_length = 0;
+}
+
+void LINK_LAYER__get_default_config(struct link_layer_config* config) {
+    config->parity_bytes = 0;
+    config->is_crc_enabled = true;
+}
+
+audio_link_layer_socket_t *LINK_LAYER__initialize(
+        const struct physical_layer_config* physical_config,
+        const struct link_layer_config* config
+) {
+    /* Use the default configuration if none is given */
+    struct link_layer_config default_config;
+    if (config == NULL) {
+        LINK_LAYER__get_default_config(&default_config);
+        config = &default_config;
+    }
+
+    /* Validate the configuration */
+    if (config->parity_bytes > LINK_LAYER_MAX_PARITY_BYTES) {
+        LOG_ERROR("Invalid link parity bytes %u (0 - %zu)", config->parity_bytes, LINK_LAYER_MAX_PARITY_BYTES);
+        return NULL;
+    }
+
     /* Allocate the link layer socket struct. */
     audio_link_layer_socket_t* socket = malloc(sizeof(audio_link_layer_socket_t));
     if (socket == NULL) {
@@ -46,14 +166,31 @@ audio_link_layer_socket_t *LINK_LAYER__initialize() {
         return NULL;
     }
 
+    /* Initialize the error correction codec, if enabled */
+    socket->is_crc_enabled = config->is_crc_enabled;
+    socket->parity_bytes = config->parity_bytes;
+    socket->codec = NULL;
+    if (socket->parity_bytes > 0) {
+        socket->codec = REED_SOLOMON__initialize(socket->parity_bytes);
+        if (socket->codec == NULL) {
+            LOG_ERROR("Failed to initialize link layer error correction");
+            free(socket);
+            return NULL;
+        }
+    }
+
     /* Initialize the physical layer */
-    socket->physical_layer = PHYSICAL_LAYER__initialize();
+    socket->physical_layer = PHYSICAL_LAYER__initialize(physical_config);
     if (socket->physical_layer == NULL) {
         LOG_ERROR("Failed to initialize audio physical layer");
+        REED_SOLOMON__free(socket->codec);
         free(socket);
         return NULL;
     }
 
+    memset(&socket->recv_state, 0, sizeof(socket->recv_state));
+    reset_coded_recv_state(&socket->coded_recv_state);
+    memset(&socket->stats, 0, sizeof(socket->stats));
     return socket;
 }
 
@@ -61,116 +198,554 @@ void LINK_LAYER__free(audio_link_layer_socket_t *socket) {
     /* Free the physical layer */
     PHYSICAL_LAYER__free(socket->physical_layer);
 
+    /* Free the error correction codec */
+    REED_SOLOMON__free(socket->codec);
+
     /* Free the link layer */
     free(socket);
 }
 
-int LINK_LAYER__send(audio_link_layer_socket_t *socket, void *data, size_t size) {
+/**
+ * Gets the length of the packet's trailer.
+ *
+ * @param socket The socket.
+ * @return The length of the trailer, 0 if there's none.
+ */
+static size_t get_trailer_size(audio_link_layer_socket_t* socket) {
+    return socket->is_crc_enabled ? sizeof(struct link_packet_trailer_s) : 0;
+}
+
+/**
+ * Gets the length of the header's codeword, the first codeword of an error corrected packet.
+ *
+ * @param socket The socket.
+ * @return The length of the header's codeword.
+ */
+static size_t get_header_codeword_length(audio_link_layer_socket_t* socket) {
+    return sizeof(struct link_packet_header_s) + socket->parity_bytes;
+}
+
+/**
+ * Gets the length of an error corrected packet's codewords,
+ * the header's codeword followed by the payload's (data and trailer) codewords of up to `REED_SOLOMON_MAX_CODEWORD_SIZE` bytes.
+ *
+ * @param socket The socket.
+ * @param payload_length The length of the packet's data and trailer.
+ * @return The length of the packet's codewords.
+ */
+static size_t get_coded_length(audio_link_layer_socket_t* socket, size_t payload_length) {
+    size_t block_size = REED_SOLOMON_MAX_CODEWORD_SIZE - socket->parity_bytes;
+    size_t full_blocks = payload_length / block_size;
+    size_t remainder = payload_length % block_size;
+
+    return get_header_codeword_length(socket) +
+           full_blocks * REED_SOLOMON_MAX_CODEWORD_SIZE +
+           ((remainder > 0) ? remainder + socket->parity_bytes : 0);
+}
+
+size_t LINK_LAYER__get_mtu(audio_link_layer_socket_t *socket) {
+    if (socket->parity_bytes == 0) {
+        return LINK_LAYER_MTU - get_trailer_size(socket);
+    }
+
+    /* The payload fills whole codewords after the header's codeword, a partial last codeword still carries a full parity. */
+    size_t block_size = REED_SOLOMON_MAX_CODEWORD_SIZE - socket->parity_bytes;
+    size_t capacity = MAX_LINK_PACKET_SIZE - get_header_codeword_length(socket);
+    size_t remainder = capacity % REED_SOLOMON_MAX_CODEWORD_SIZE;
+    size_t payload_mtu = (capacity / REED_SOLOMON_MAX_CODEWORD_SIZE) * block_size +
+                         ((remainder > socket->parity_bytes) ? remainder - socket->parity_bytes : 0);
+
+    return (payload_mtu > get_trailer_size(socket)) ? payload_mtu - get_trailer_size(socket) : 0;
+}
+
+/**
+ * Lays a packet out as the byte stream carried by it's frames.
+ * Without error correction it's the header followed by the payload (the data and trailer), otherwise it's
+ * the header's codeword followed by the payload's codewords, each codeword's parity following it's data.
+ *
+ * @param socket The socket.
+ * @param data The packet's data.
+ * @param size The length of the packet's data, mustn't exceed `LINK_LAYER__get_mtu`.
+ * @param stream Returns the packet's stream, `MAX_LINK_PACKET_SIZE` bytes long.
+ * @return The length of the stream.
+ */
+static size_t build_stream(audio_link_layer_socket_t *socket, const uint8_t* data, size_t size, uint8_t* stream) {
+    struct link_packet_header_s header;
+    header.data_length = size;
+    memcpy(stream, &header, sizeof(header));
+
+    /* The payload is the data, followed by the CRC of the header and data. */
+    uint8_t payload[MAX_LINK_PACKET_SIZE];
+    size_t payload_length = size;
+    memcpy(payload, data, size);
+    if (socket->is_crc_enabled) {
+        struct link_packet_trailer_s trailer;
+        trailer.crc = CRC32C__update(CRC32C__update(0, &header, sizeof(header)), data, size);
+        memcpy(payload + size, &trailer, sizeof(trailer));
+        payload_length += sizeof(trailer);
+    }
+
+    if (socket->codec == NULL) {
+        memcpy(stream + sizeof(header), payload, payload_length);
+        return sizeof(header) + payload_length;
+    }
+
+    /* The header has a codeword of it's own, so the packet's length is known before all of it arrives. */
+    REED_SOLOMON__encode(socket->codec, stream, sizeof(header), stream + sizeof(header));
+
+    size_t block_size = REED_SOLOMON_MAX_CODEWORD_SIZE - socket->parity_bytes;
+    size_t offset = get_header_codeword_length(socket);
+    for (size_t payload_offset = 0; payload_offset < payload_length; payload_offset += block_size) {
+        size_t block_length = min(block_size, payload_length - payload_offset);
+        memcpy(stream + offset, payload + payload_offset, block_length);
+        REED_SOLOMON__encode(socket->codec, stream + offset, block_length, stream + offset + block_length);
+        offset += block_length + socket->parity_bytes;
+    }
+
+    return offset;
+}
+
+/**
+ * Splits a packet into frames and queues them over the physical layer.
+ *
+ * @param socket The socket to send data over.
+ * @param data The data to send.
+ * @param size the length of the data to send.
+ * @param wait Whether to wait until the frames have been sent.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int send_frames(audio_link_layer_socket_t *socket, void *data, size_t size, bool wait) {
     /* Validate parameters. */
-    if (size > MAX_LINK_PACKET_SIZE - sizeof(struct link_packet_header_s)) {
+    if (size > LINK_LAYER__get_mtu(socket)) {
         LOG_ERROR("link packet exceeds maximum size");
         return -1;
     }
 
-    // Note: Here we could add CRC calculation and add to the packet header.
+    /* Lay out the packet's header, data and parity. */
+    uint8_t stream[MAX_LINK_PACKET_SIZE];
+    size_t stream_length = build_stream(socket, data, size, stream);
 
-    /* Create the packet header and the first frame. */
+    /* Send the stream frame by frame until finished.
+     * Each frame is queued before waiting for the previous one, so the frames are sent back to back. */
     int ret;
     struct link_frame_s frame = { .seq = 0 };
-    struct link_packet_header_s header;
-    header.data_length = size;
+    uint64_t ticket = 0;
+    uint64_t previous_ticket = 0;
+    for (size_t stream_sent = 0; stream_sent < stream_length; stream_sent += LINK_FRAME_DATA_SIZE) {
+        size_t frame_data_length = min(LINK_FRAME_DATA_SIZE, stream_length - stream_sent);
+        memcpy(frame.data, stream + stream_sent, frame_data_length);
 
-    /* Send the data frame by frame until finished. */
-    size_t header_sent = 0;
-    size_t data_sent = 0;
-    while (data_sent < size) {
-        size_t frame_data_length = 0;
-        /* If the header hasn't been sent yet, copy to the frame. */
-        if (header_sent < sizeof(header)) {
-            size_t header_length_to_be_sent = min(PHYSICAL_LAYER_MTU - 1, sizeof(header) - header_sent);
-            memcpy(frame.data, ((uint8_t*)&header) + header_sent, header_length_to_be_sent);
-            frame_data_length += header_length_to_be_sent;
-            header_sent += header_length_to_be_sent;
-        }
-
-        /* Add as much data as possible to the frame. */
-        if (frame_data_length < PHYSICAL_LAYER_MTU - 1) {
-            size_t data_length_to_be_sent = min(PHYSICAL_LAYER_MTU - 1 - frame_data_length, size - data_sent);
-            memcpy(((uint8_t*)frame.data) + frame_data_length, ((uint8_t*)data) + data_sent, data_length_to_be_sent);
-            frame_data_length += data_length_to_be_sent;
-            data_sent += data_length_to_be_sent;
-        }
-
-        /* Send the frame */
-        ret = PHYSICAL_LAYER__send(socket->physical_layer, &frame, frame_data_length + 1);
+        /* Queue the frame, and wait for the previous one to be sent. */
+        ret = PHYSICAL_LAYER__send_async(socket->physical_layer, &frame, frame_data_length + 1, &ticket);
         if (ret != 0) {
             LOG_ERROR("Failed to send data on physical layer");
             return ret;
         }
 
+        if (wait && previous_ticket != 0) {
+            ret = PHYSICAL_LAYER__wait_sent(socket->physical_layer, previous_ticket);
+            if (ret != 0) {
+                LOG_ERROR("Failed to send data on physical layer");
+                return ret;
+            }
+        }
+
+        previous_ticket = ticket;
         frame.seq++;
+        socket->stats.frames_sent++;
+    }
+    socket->stats.packets_sent++;
+
+    /* Wait for the last frame to be sent. */
+    if (wait && ticket != 0) {
+        ret = PHYSICAL_LAYER__wait_sent(socket->physical_layer, ticket);
+        if (ret != 0) {
+            LOG_ERROR("Failed to send data on physical layer");
+            return ret;
+        }
     }
 
     return 0;
 }
 
-ssize_t LINK_LAYER__recv(audio_link_layer_socket_t *socket, void *data, size_t size) {
+int LINK_LAYER__send(audio_link_layer_socket_t *socket, void *data, size_t size) {
+    return send_frames(socket, data, size, true);
+}
+
+int LINK_LAYER__send_async(audio_link_layer_socket_t *socket, void *data, size_t size) {
+    return send_frames(socket, data, size, false);
+}
+
+/**
+ * Pops the frames already received until the start of the next packet (a `0` sequence frame).
+ *
+ * @param socket The socket to clean.
+ * @return `RECV_OUT_OF_SYNC_RET_CODE` once cleaned, or a negative error code of the physical layer.
+ */
+static ssize_t skip_to_next_packet(audio_link_layer_socket_t *socket) {
+    struct link_frame_s frame;
+
+    /* We got a bad sequence number, so we pop all the next frames until we find a `0` sequence frame */
+    while (true) {
+        ssize_t recv_ret = PHYSICAL_LAYER__peek(socket->physical_layer, &frame, PHYSICAL_LAYER_MTU, false);
+        if (recv_ret < 0) {
+            return recv_ret;
+        } else if (recv_ret == 0 || frame.seq == 0) {
+            /* We cleaned all the frames until a `0` frame, return out-of-sync */
+            return RECV_OUT_OF_SYNC_RET_CODE;
+        }
+
+        PHYSICAL_LAYER__pop(socket->physical_layer);
+    }
+}
+
+/**
+ * Receives frames into the packet currently being received, until the packet is complete.
+ * The receive state is kept only when returning `RECV_WOULD_BLOCK_RET_CODE`, otherwise the next call starts a new packet.
+ *
+ * @param socket The socket to receive the packet over.
+ * @param data The buffer to save the incoming packet into, the same buffer must be given until the packet completes.
+ * @param size The size of the buffer.
+ * @param blocking Whether to wait (up to timeout) for each frame.
+ * @return The length of the packet on success, negative value on failure.
+ */
+static ssize_t recv_frames(audio_link_layer_socket_t *socket, void *data, size_t size, bool blocking) {
+    struct link_recv_state* state = &socket->recv_state;
     struct link_frame_s frame;
-    struct link_packet_header_s header;
-    size_t header_written = 0;
-    size_t data_written = 0;
     size_t current_new_data_count = 0;
-    uint8_t seq = 0;
+    ssize_t ret = -1;
 
     while (true) {
         /* Get the next frame. */
-        ssize_t recv_ret = PHYSICAL_LAYER__recv(socket->physical_layer, &frame, PHYSICAL_LAYER_MTU);
-        if (recv_ret < 0) {
-            LOG_ERROR("Failed to recv link layer header: %zd", recv_ret);
+        ssize_t recv_ret = blocking ?
+                PHYSICAL_LAYER__recv(socket->physical_layer, &frame, PHYSICAL_LAYER_MTU) :
+                PHYSICAL_LAYER__recv_nonblocking(socket->physical_layer, &frame, PHYSICAL_LAYER_MTU);
+        if (recv_ret == RECV_WOULD_BLOCK_RET_CODE) {
+            /* Keep the state, the packet continues on the next call. */
             return recv_ret;
+        } else if (recv_ret < 0) {
+            LOG_ERROR("Failed to recv link layer header: %zd", recv_ret);
+            ret = recv_ret;
+            goto l_cleanup;
         }
 
         /* Check the sequence of the received frame. */
-        if (seq != frame.seq) {
-            LOG_ERROR("link layer received bad seq %d, expected %d, cleaning physical layer", frame.seq, seq);
-            /* We got a bad sequence number, so we pop all the next frames until we find a `0` sequence frame */
-            while (true) {
-                recv_ret = PHYSICAL_LAYER__peek(socket->physical_layer, &frame, PHYSICAL_LAYER_MTU, false);
-                if (recv_ret < 0 ) {
-                    return recv_ret;
-                } else if (recv_ret == 0 || frame.seq == 0) {
-                    /* We cleaned all the frames until a `0` frame, return out-of-sync */
-                    return RECV_OUT_OF_SYNC_RET_CODE;
-                }
-
-                PHYSICAL_LAYER__pop(socket->physical_layer);
-            }
+        if (state->seq != frame.seq) {
+            LOG_ERROR("link layer received bad seq %d, expected %d, cleaning physical layer", frame.seq, state->seq);
+            ret = skip_to_next_packet(socket);
+            goto l_cleanup;
         }
 
-        seq++;
+        state->seq++;
         current_new_data_count = recv_ret - 1;
 
         /* Write the data to the header first, if not filled */
-        size_t amount_to_write_to_header = 0;
-        if (header_written < sizeof(header)) {
-            amount_to_write_to_header = min(current_new_data_count, sizeof(header) - header_written);
-            memcpy(((uint8_t*)&header) + header_written, frame.data, amount_to_write_to_header);
-            header_written += amount_to_write_to_header;
+        const uint8_t* frame_data = frame.data;
+        if (state->header_written < sizeof(state->header)) {
+            size_t amount_to_write_to_header = min(current_new_data_count, sizeof(state->header) - state->header_written);
+            memcpy(((uint8_t*)&state->header) + state->header_written, frame_data, amount_to_write_to_header);
+            state->header_written += amount_to_write_to_header;
             current_new_data_count -= amount_to_write_to_header;
+            frame_data += amount_to_write_to_header;
+
+            if (state->header_written < sizeof(state->header)) {
+                continue;
+            }
+
+            /* A length beyond the MTU can only be a corrupted header. */
+            if (state->header.data_length > LINK_LAYER__get_mtu(socket)) {
+                LOG_ERROR("link layer packet too long: %u", state->header.data_length);
+                ret = skip_to_next_packet(socket);
+                goto l_cleanup;
+            }
+            state->crc = CRC32C__update(0, &state->header, sizeof(state->header));
         }
 
-        /* Write the rest of the data to the output buffer */
-        if (current_new_data_count > 0) {
-            size_t amount_to_write_to_data = min(current_new_data_count, size - data_written);
-            memcpy(((uint8_t*)data) + data_written, frame.data + amount_to_write_to_header, amount_to_write_to_data);
-            data_written += amount_to_write_to_data;
+        /* Write the data to the output buffer, data beyond it's size is only checked */
+        size_t amount_of_data = min(current_new_data_count, state->header.data_length - state->data_received);
+        if (state->data_received < size) {
+            memcpy(((uint8_t*)data) + state->data_received, frame_data, min(amount_of_data, size - state->data_received));
         }
+        if (socket->is_crc_enabled) {
+            state->crc = CRC32C__update(state->crc, frame_data, amount_of_data);
+        }
+        state->data_received += amount_of_data;
+        current_new_data_count -= amount_of_data;
+        frame_data += amount_of_data;
+
+        /* The rest is the trailer */
+        size_t amount_to_write_to_trailer = min(current_new_data_count, get_trailer_size(socket) - state->trailer_written);
+        memcpy(((uint8_t*)&state->trailer) + state->trailer_written, frame_data, amount_to_write_to_trailer);
+        state->trailer_written += amount_to_write_to_trailer;
 
-        /* We finish when we filled the header and received `data_length` bytes */
-        if (header_written >= sizeof(header) && header.data_length <= data_written) {
+        /* We finish when we received `data_length` bytes and the trailer */
+        if (state->header.data_length <= state->data_received && state->trailer_written >= get_trailer_size(socket)) {
             break;
         }
     }
 
-    return (ssize_t) data_written;
+    /* Reject a corrupted packet, rather than handing it up. */
+    if (socket->is_crc_enabled && state->trailer.crc != state->crc) {
+        LOG_WARNING("link layer packet CRC mismatch: %08x, expected %08x", state->crc, state->trailer.crc);
+        ret = RECV_CRC_MISMATCH_RET_CODE;
+        goto l_cleanup;
+    }
+
+    ret = (ssize_t)min(state->data_received, size);
+
+l_cleanup:
+    /* The packet is done (or failed), the next call starts a new one. */
+    memset(state, 0, sizeof(*state));
+    return ret;
+}
+
+/**
+ * Corrects a codeword of the error corrected packet, it's erased bytes are given to the codec as erasures.
+ *
+ * @param socket The socket.
+ * @param offset The offset of the codeword in the packet's stream.
+ * @param length The length of the codeword, including the parity.
+ * @return 0 On Success, -1 if the codeword has more errors than can be corrected.
+ */
+static int correct_codeword(audio_link_layer_socket_t *socket, size_t offset, size_t length) {
+    struct link_coded_recv_state* state = &socket->coded_recv_state;
+    size_t erasures[REED_SOLOMON_MAX_CODEWORD_SIZE];
+    size_t erasures_count = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        if (state->erased[offset + i]) {
+            erasures[erasures_count++] = i;
+        }
+    }
+
+    int corrected = REED_SOLOMON__decode(socket->codec, state->stream + offset, length, erasures, erasures_count);
+    if (corrected < 0) {
+        LOG_WARNING("Uncorrectable link codeword at %zu (%zu erasures)", offset, erasures_count);
+        return -1;
+    }
+
+    if (corrected > 0) {
+        socket->stats.bytes_corrected += (uint64_t)corrected;
+        LOG_DEBUG("Corrected %d bytes of link codeword at %zu (%zu erasures)", corrected, offset, erasures_count);
+    }
+    return 0;
+}
+
+/**
+ * Corrects the payload codewords of the error corrected packet being received, and copies it's data to the user's buffer.
+ * Frames that haven't arrived are left as erasures.
+ *
+ * @param socket The socket.
+ * @param data The buffer to save the packet into.
+ * @param size The size of the buffer.
+ * @return The length of the packet on success, `RECV_UNCORRECTABLE_RET_CODE` or `RECV_CRC_MISMATCH_RET_CODE` on failure.
+ */
+static ssize_t finalize_coded_packet(audio_link_layer_socket_t *socket, void *data, size_t size) {
+    struct link_coded_recv_state* state = &socket->coded_recv_state;
+    size_t block_size = REED_SOLOMON_MAX_CODEWORD_SIZE - socket->parity_bytes;
+    size_t offset = get_header_codeword_length(socket);
+    size_t payload_length = state->data_length + get_trailer_size(socket);
+    struct link_packet_trailer_s trailer;
+    uint32_t crc = CRC32C__update(0, state->stream, sizeof(struct link_packet_header_s));
+
+    for (size_t payload_offset = 0; payload_offset < payload_length; payload_offset += block_size) {
+        size_t block_length = min(block_size, payload_length - payload_offset);
+        if (correct_codeword(socket, offset, block_length + socket->parity_bytes) != 0) {
+            return RECV_UNCORRECTABLE_RET_CODE;
+        }
+
+        /* Copy the block's data, data beyond the user's buffer is dropped */
+        const uint8_t* block = state->stream + offset;
+        size_t block_data_length = 0;
+        if (payload_offset < state->data_length) {
+            block_data_length = min(block_length, state->data_length - payload_offset);
+            if (payload_offset < size) {
+                memcpy(((uint8_t*)data) + payload_offset, block, min(block_data_length, size - payload_offset));
+            }
+            if (socket->is_crc_enabled) {
+                crc = CRC32C__update(crc, block, block_data_length);
+            }
+        }
+
+        /* The rest of the block is the trailer */
+        if (block_data_length < block_length) {
+            memcpy(((uint8_t*)&trailer) + (payload_offset + block_data_length - state->data_length),
+                   block + block_data_length, block_length - block_data_length);
+        }
+        offset += block_length + socket->parity_bytes;
+    }
+
+    /* Reject a packet the error correction got wrong, rather than handing it up. */
+    if (socket->is_crc_enabled && trailer.crc != crc) {
+        LOG_WARNING("link layer packet CRC mismatch: %08x, expected %08x", crc, trailer.crc);
+        return RECV_CRC_MISMATCH_RET_CODE;
+    }
+
+    return (ssize_t)min(state->data_length, size);
+}
+
+/**
+ * Receives frames into the error corrected packet currently being received, until the packet is complete.
+ * Each frame is placed by it's sequence number along with the physical layer's erasures, a missing frame only leaves erasures.
+ * The packet is completed by it's last frame, by the next packet's first frame, or by a timeout (when blocking),
+ * whatever didn't arrive by then is left to the error correction.
+ * The receive state is kept only when returning `RECV_WOULD_BLOCK_RET_CODE`, otherwise the next call starts a new packet.
+ *
+ * @param socket The socket to receive the packet over.
+ * @param data The buffer to save the incoming packet into.
+ * @param size The size of the buffer.
+ * @param blocking Whether to wait (up to timeout) for each frame.
+ * @return The length of the packet on success, negative value on failure.
+ */
+static ssize_t recv_coded_frames(audio_link_layer_socket_t *socket, void *data, size_t size, bool blocking) {
+    struct link_coded_recv_state* state = &socket->coded_recv_state;
+    struct link_frame_s frame;
+    uint16_t erasures;
+    ssize_t ret = -1;
+
+    while (state->frames_count == 0 || state->seq < state->frames_count) {
+        /* Peek the next frame, it's popped only once it's known to belong to this packet. */
+        ssize_t recv_ret = PHYSICAL_LAYER__peek(socket->physical_layer, &frame, PHYSICAL_LAYER_MTU, blocking);
+        if (recv_ret == 0) {
+            /* Keep the state, the packet continues on the next call. */
+            return RECV_WOULD_BLOCK_RET_CODE;
+        } else if (recv_ret == RECV_TIMEOUT_RET_CODE && state->frames_count > 0) {
+            /* The rest of the packet was lost, leave it to the error correction. */
+            LOG_DEBUG("Link packet timed out at frame %zu/%zu", state->seq, state->frames_count);
+            break;
+        } else if (recv_ret < 0) {
+            LOG_ERROR("Failed to recv link layer frame: %zd", recv_ret);
+            ret = recv_ret;
+            goto l_cleanup;
+        }
+
+        if (PHYSICAL_LAYER__peek_erasures(socket->physical_layer, &erasures) != 0) {
+            erasures = 0;
+        }
+
+        bool is_seq_reliable = !(erasures & 1);
+        if (state->is_started && is_seq_reliable && frame.seq == 0) {
+            /* The next packet has started, this packet's missing frames were lost. */
+            if (state->frames_count > 0) {
+                LOG_DEBUG("Link packet cut at frame %zu/%zu", state->seq, state->frames_count);
+                break;
+            }
+
+            LOG_ERROR("link layer packet restarted before it's header was received");
+            ret = RECV_OUT_OF_SYNC_RET_CODE;
+            goto l_cleanup;
+        }
+        PHYSICAL_LAYER__pop(socket->physical_layer);
+
+        /* A few frames may have been lost, otherwise an unreliable or unlikely sequence number is assumed to be
+         * the expected one. A frame that doesn't belong to the packet after all fails the header's correction. */
+        uint8_t jump = (uint8_t)(frame.seq - (uint8_t)state->seq);
+        size_t seq = state->seq + jump;
+        if (!is_seq_reliable || jump > MAX_LOST_FRAMES_JUMP || seq >= MAX_LINK_FRAMES ||
+                (state->frames_count > 0 && seq >= state->frames_count)) {
+            if (jump != 0) {
+                LOG_DEBUG("link layer taking frame of seq %d as the expected %d", frame.seq, (uint8_t)state->seq);
+            }
+            seq = state->seq;
+        }
+
+        /* Place the frame, with the erasures of it's bytes. */
+        size_t offset = seq * LINK_FRAME_DATA_SIZE;
+        for (size_t i = 0; i < (size_t)recv_ret - 1; ++i) {
+            state->stream[offset + i] = frame.data[i];
+            state->erased[offset + i] = (erasures >> (i + 1)) & 1;
+        }
+        state->is_started = true;
+        state->seq = seq + 1;
+
+        /* Once past the header's codeword, correct it to learn the length of the packet. */
+        size_t header_codeword_length = get_header_codeword_length(socket);
+        if (state->frames_count == 0 && state->seq * LINK_FRAME_DATA_SIZE >= header_codeword_length) {
+            if (correct_codeword(socket, 0, header_codeword_length) != 0) {
+                ret = skip_to_next_packet(socket);
+                if (ret == RECV_OUT_OF_SYNC_RET_CODE) {
+                    ret = RECV_UNCORRECTABLE_RET_CODE;
+                }
+                goto l_cleanup;
+            }
+
+            struct link_packet_header_s header;
+            memcpy(&header, state->stream, sizeof(header));
+            if (header.data_length > LINK_LAYER__get_mtu(socket)) {
+                LOG_ERROR("link layer packet too long: %u", header.data_length);
+                ret = skip_to_next_packet(socket);
+                goto l_cleanup;
+            }
+
+            state->data_length = header.data_length;
+            state->frames_count = (get_coded_length(socket, header.data_length + get_trailer_size(socket)) +
+                                   LINK_FRAME_DATA_SIZE - 1) / LINK_FRAME_DATA_SIZE;
+            LOG_DEBUG("link layer recv packet size %u in %zu frames", state->data_length, state->frames_count);
+        }
+    }
+
+    ret = finalize_coded_packet(socket, data, size);
+
+l_cleanup:
+    /* The packet is done (or failed), the next call starts a new one. */
+    reset_coded_recv_state(state);
+    return ret;
+}
+
+/**
+ * Counts the outcome of a packet receive.
+ *
+ * @param socket The socket.
+ * @param ret The return value of the receive.
+ * @return The given return value.
+ */
+static ssize_t count_received_packet(audio_link_layer_socket_t *socket, ssize_t ret) {
+    if (ret >= 0) {
+        socket->stats.packets_received++;
+    } else if (ret == RECV_OUT_OF_SYNC_RET_CODE) {
+        socket->stats.packets_out_of_sync++;
+    } else if (ret == RECV_UNCORRECTABLE_RET_CODE) {
+        socket->stats.packets_uncorrectable++;
+    } else if (ret == RECV_CRC_MISMATCH_RET_CODE) {
+        socket->stats.packets_crc_mismatch++;
+    }
+
+    return ret;
+}
+
+ssize_t LINK_LAYER__recv(audio_link_layer_socket_t *socket, void *data, size_t size) {
+    if (socket->codec != NULL) {
+        return count_received_packet(socket, recv_coded_frames(socket, data, size, true));
+    }
+    return count_received_packet(socket, recv_frames(socket, data, size, true));
+}
+
+ssize_t LINK_LAYER__recv_nonblocking(audio_link_layer_socket_t *socket, void *data, size_t size) {
+    if (socket->codec != NULL) {
+        return count_received_packet(socket, recv_coded_frames(socket, data, size, false));
+    }
+    return count_received_packet(socket, recv_frames(socket, data, size, false));
+}
+
+int LINK_LAYER__send_feedback(audio_link_layer_socket_t *socket, enum physical_layer_feedback feedback) {
+    return PHYSICAL_LAYER__send_feedback(socket->physical_layer, feedback);
+}
+
+int LINK_LAYER__send_feedback_async(audio_link_layer_socket_t *socket, enum physical_layer_feedback feedback) {
+    uint64_t ticket;
+    return PHYSICAL_LAYER__send_feedback_async(socket->physical_layer, feedback, &ticket);
+}
+
+int LINK_LAYER__recv_feedback(audio_link_layer_socket_t *socket, enum physical_layer_feedback* feedback) {
+    return PHYSICAL_LAYER__recv_feedback(socket->physical_layer, feedback);
+}
+
+int LINK_LAYER__get_ready_fd(audio_link_layer_socket_t *socket) {
+    return PHYSICAL_LAYER__get_ready_fd(socket->physical_layer);
+}
+
+void LINK_LAYER__get_stats(audio_link_layer_socket_t *socket, struct link_layer_stats* stats,
+                           struct physical_layer_stats* physical_stats) {
+    *stats = socket->stats;
+    PHYSICAL_LAYER__get_stats(socket->physical_layer, physical_stats);
 }
@@ -7,11 +7,20 @@
 #define AUDIONET_LINK_LAYER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <sys/types.h>
 #include "audio_socket/layers/physical/physical_layer.h"
+#include "fec/reed_solomon.h"
 
-/** The maximum length that can be transmitted in a single link packet. */
-#define LINK_LAYER_MTU (256 * PHYSICAL_LAYER_MTU)
+/**
+ * The maximum length that can be transmitted in a single link packet,
+ * each of the 256 frames spends a byte on it's sequence number, and the packet starts with a 32bit length header.
+ * The CRC trailer and error correction parity take from it, `LINK_LAYER__get_mtu` gives a socket's actual MTU.
+ */
+#define LINK_LAYER_MTU (256 * (PHYSICAL_LAYER_MTU - 1) - sizeof(uint32_t))
+
+/** The maximal amount of parity bytes per codeword, the packet header's codeword must still fit. */
+#define LINK_LAYER_MAX_PARITY_BYTES (REED_SOLOMON_MAX_CODEWORD_SIZE - sizeof(uint32_t))
 
 /** The return code for recv operation timeout. */
 #define RECV_TIMEOUT_RET_CODE (-2)
@@ -19,17 +28,84 @@
 /** The return code for recv operation out-of-sync error. */
 #define RECV_OUT_OF_SYNC_RET_CODE (-3)
 
+/** The return code for a non-blocking recv operation with no complete packet yet. */
+#define RECV_WOULD_BLOCK_RET_CODE (-4)
+
+/** The return code for recv operation of a packet with more errors than the error correction can fix. */
+#define RECV_UNCORRECTABLE_RET_CODE (-5)
+
+/** The return code for recv operation of a packet whose CRC doesn't match it's content. */
+#define RECV_CRC_MISMATCH_RET_CODE (-6)
+
 /**
  * The link layer socket type.
  */
 typedef struct audio_link_layer_socket_s audio_link_layer_socket_t;
 
+/**
+ * The link layer configuration, chosen at socket initialization.
+ */
+struct link_layer_config {
+    /**
+     * The amount of Reed-Solomon parity bytes protecting each codeword of a packet (0 - `LINK_LAYER_MAX_PARITY_BYTES`),
+     * up to `parity_bytes` erased bytes (lost frames, unclear votes) or half as many wrong bytes are corrected per codeword.
+     * The packet is split into codewords of up to 255 bytes (including the parity), 0 disables the error correction.
+     * Both peers must use the same value.
+     */
+    uint32_t parity_bytes;
+
+    /**
+     * Whether each packet ends with a CRC32C of it's header and data, checked after the error correction.
+     * A packet that fails the check is dropped with `RECV_CRC_MISMATCH_RET_CODE` instead of being handed up corrupted.
+     * Both peers must use the same value.
+     */
+    bool is_crc_enabled;
+};
+
+/**
+ * Runtime counters of the link layer.
+ */
+struct link_layer_stats {
+    /** The amount of packets sent (or queued to be sent). */
+    uint64_t packets_sent;
+
+    /** The amount of frames the sent packets were split into. */
+    uint64_t frames_sent;
+
+    /** The amount of packets received intact. */
+    uint64_t packets_received;
+
+    /** The amount of packets dropped since their frames arrived out of sequence. */
+    uint64_t packets_out_of_sync;
+
+    /** The amount of packets dropped since they had more errors than the error correction can fix. */
+    uint64_t packets_uncorrectable;
+
+    /** The amount of packets dropped since their CRC didn't match their content. */
+    uint64_t packets_crc_mismatch;
+
+    /** The amount of bytes fixed by the error correction (erased or wrong). */
+    uint64_t bytes_corrected;
+};
+
+/**
+ * Fills a configuration with the default link layer settings.
+ *
+ * @param config The configuration to fill.
+ */
+void LINK_LAYER__get_default_config(struct link_layer_config* config);
+
 /**
  * Allocates and initializes a new link layer socket.
  *
+ * @param physical_config The configuration of the underlying physical layer, or NULL for the defaults.
+ * @param config The configuration of the link layer, or NULL for the defaults.
  * @return The initialize socket, or NULL on failure.
  */
-audio_link_layer_socket_t* LINK_LAYER__initialize();
+audio_link_layer_socket_t* LINK_LAYER__initialize(
+        const struct physical_layer_config* physical_config,
+        const struct link_layer_config* config
+);
 
 /**
  * Frees a link layer socket.
@@ -39,7 +115,15 @@ audio_link_layer_socket_t* LINK_LAYER__initialize();
 void LINK_LAYER__free(audio_link_layer_socket_t *socket);
 
 /**
- * Sends a packet over the link layer socket, the size of the packet mustn't exceed `LINK_LAYER_MTU`.
+ * Gets the maximum length that can be transmitted in a single packet over the socket, after the error correction parity.
+ *
+ * @param socket The socket.
+ * @return The socket's MTU, `LINK_LAYER_MTU` without a CRC or error correction.
+ */
+size_t LINK_LAYER__get_mtu(audio_link_layer_socket_t* socket);
+
+/**
+ * Sends a packet over the link layer socket, the size of the packet mustn't exceed `LINK_LAYER__get_mtu`.
  *
  * @param socket The socket to send data over.
  * @param data The data to send.
@@ -48,9 +132,20 @@ void LINK_LAYER__free(audio_link_layer_socket_t *socket);
  */
 int LINK_LAYER__send(audio_link_layer_socket_t* socket, void* data, size_t size);
 
+/**
+ * Queues a packet to be sent over the link layer socket without waiting for it to be sent,
+ * the size of the packet mustn't exceed `LINK_LAYER__get_mtu`.
+ *
+ * @param socket The socket to send data over.
+ * @param data The data to send, may be reused once the function returns.
+ * @param size the length of the data to send.
+ * @return 0 On Success (the packet is queued), -1 On Failure.
+ */
+int LINK_LAYER__send_async(audio_link_layer_socket_t* socket, void* data, size_t size);
+
 /**
  * Receives packet over the audio link layer.
- * May fail on timeout or synchronization with sender.
+ * May fail on timeout, synchronization with sender, errors beyond the error correction, or a CRC mismatch.
  *
  * @param socket The socket to receive the packet over.
  * @param data The buffer to save the incoming packet into.
@@ -59,4 +154,62 @@ int LINK_LAYER__send(audio_link_layer_socket_t* socket, void* data, size_t size)
  */
 ssize_t LINK_LAYER__recv(audio_link_layer_socket_t* socket, void* data, size_t size);
 
+/**
+ * Receives the frames that have already arrived into the current packet, without waiting.
+ * A packet may take multiple calls to complete, the same buffer must be given to each call until it does.
+ *
+ * @param socket The socket to receive the packet over.
+ * @param data The buffer to save the incoming packet into.
+ * @param size The size of the buffer.
+ * @return The length of the packet on success, `RECV_WOULD_BLOCK_RET_CODE` if the packet isn't complete yet,
+ *         another negative value on failure.
+ */
+ssize_t LINK_LAYER__recv_nonblocking(audio_link_layer_socket_t* socket, void* data, size_t size);
+
+/**
+ * Sends a feedback signal (a single physical layer symbol, much shorter than any packet).
+ *
+ * @param socket The socket to send the feedback over.
+ * @param feedback The feedback to send.
+ * @return 0 On Success, -1 On Failure.
+ */
+int LINK_LAYER__send_feedback(audio_link_layer_socket_t* socket, enum physical_layer_feedback feedback);
+
+/**
+ * Queues a feedback signal to be sent without waiting for it to be sent.
+ *
+ * @param socket The socket to send the feedback over.
+ * @param feedback The feedback to send.
+ * @return 0 On Success (the feedback is queued), -1 On Failure.
+ */
+int LINK_LAYER__send_feedback_async(audio_link_layer_socket_t* socket, enum physical_layer_feedback feedback);
+
+/**
+ * Waits to receive a feedback signal sent after the socket's last send, or until a packet starts arriving instead.
+ *
+ * @param socket The socket to receive the feedback over.
+ * @param feedback Returns the received feedback.
+ * @return 0 if a feedback was received, `RECV_FRAME_PENDING_RET_CODE` if a packet is arriving instead,
+ *         `RECV_TIMEOUT_RET_CODE` on timeout, or another negative code on error.
+ */
+int LINK_LAYER__recv_feedback(audio_link_layer_socket_t* socket, enum physical_layer_feedback* feedback);
+
+/**
+ * Gets the socket's readiness descriptor, readable while there are received frames waiting to be handled.
+ *
+ * @param socket The socket.
+ * @return The readiness file descriptor.
+ */
+int LINK_LAYER__get_ready_fd(audio_link_layer_socket_t* socket);
+
+/**
+ * Gets a snapshot of the socket's counters, along with those of the underlying physical layer.
+ *
+ * @param socket The socket to query.
+ * @param stats Returns the link layer counters.
+ * @param physical_stats Returns the physical layer counters.
+ */
+void LINK_LAYER__get_stats(audio_link_layer_socket_t* socket, struct link_layer_stats* stats,
+                           struct physical_layer_stats* physical_stats);
+
 #endif //AUDIONET_LINK_LAYER_H
@@ -5,244 +5,198 @@
 #include <stdbool.h>
 
 #include "audio_encoding.h"
+#include "channel_tuples.h"
 #include "utils/logger.h"
 #include "utils/utils.h"
 
+struct audio_encoding_s {
+    /** The lowest frequency transmitted. */
+    uint32_t base_frequency;
+
+    /** The separation width between transmitted frequencies. */
+    uint32_t band_width;
+
+    /** The number of different frequency channels. */
+    uint32_t channels_count;
+
+    /** The number of frequency channels that are used simultaneously. */
+    uint32_t concurrent_channels_count;
+
+    /** The table of the channel tuples transmitting each value. */
+    channel_tuples_t* tuples;
+};
+
 /**
  * Calculates the channel index of the given frequency (rounding down).
+ * In signed arithmetic since frequencies under the base are negative.
+ *
+ * @param encoding The encoding.
+ * @param frequency The frequency.
+ * @return The channel index, which may be out of the channels' range.
  */
-#define FREQUENCY_TO_CHANNEL_INDEX(frequency) (                                                           \
-    (ROUND_TO((frequency), CHANNEL_FREQUENCY_BAND_WIDTH) / CHANNEL_FREQUENCY_BAND_WIDTH)                  \
-    - (ROUND_TO(BASE_CHANNEL_FREQUENCY, CHANNEL_FREQUENCY_BAND_WIDTH) / CHANNEL_FREQUENCY_BAND_WIDTH)     \
-)
+static int frequency_to_channel_index(audio_encoding_t* encoding, float frequency) {
+    return (int)(ROUND_TO(frequency, encoding->band_width) / encoding->band_width)
+           - (int)(ROUND_TO(encoding->base_frequency, encoding->band_width) / encoding->band_width);
+}
 
 /**
  * Calculates the frequency for a given channel (gives a frequency the middle of the frequency channel width).
- */
-#define CHANNEL_INDEX_TO_FREQUENCY(channel) (                                                             \
-    (channel) * CHANNEL_FREQUENCY_BAND_WIDTH + (CHANNEL_FREQUENCY_BAND_WIDTH/2) + BASE_CHANNEL_FREQUENCY  \
-)
-
-/**
- * Calculates the value of a received channel with respect to other transmitted channels.
  *
- * @param normalized_total_channels The total number for possible channels for the currently calculated channel value.
- * @param number_of_lower_order_channels The amount of lower-order received channels.
- * @param normalized_channel The normalized value of the channel.
- * @return The calculated value of the channel.
+ * @param encoding The encoding.
+ * @param channel The channel index.
+ * @return The channel's carrier frequency.
  */
-static uint64_t calculate_channel_value(unsigned int normalized_total_channels, unsigned int number_of_lower_order_channels, unsigned int normalized_channel) {
-    /* We need to sum the number of arrangements of the lower order channels for each position of channel up to it's current value.
-     * For example, when having 3 channels and 5 total channels we have these values:
-     * [0, 1, 2] -> 0,  [0, 1, 3] -> 1,  [0, 1, 4] -> 2
-     * [0, 2, 3] -> 3,  [0, 2, 4] -> 4,  [0, 3, 4] -> 5
-     * [1, 2, 3] -> 6,  [1, 2, 4] -> 7,  [1, 3, 4] -> 8,  [2, 3, 4] -> 9
-     * Looking at calculating the value of the second channel, between [0, 1, 2] and [0, 2, 3] there are 3 arrangements (3 possible values for the last channel),
-     * which we can calculate as: The number of remaining values (2,3,4 -> 3) nCr The number of lower order channels (1) --> 3C1=3.
-     * We need to do it for every position the channel has moved through to get to it's current value in order to
-     * calculate the channel numerical value.
-     * But, we actually don't care about previous channel values (e.g, in this example it's the first channel)
-     * so we can use just the normalized values.
-     */
-    uint64_t sum = 0;
-    for (int i = 0; i < normalized_channel; ++i) {
-        sum += comb(normalized_total_channels - i - 1, number_of_lower_order_channels);
+static uint32_t channel_index_to_frequency(audio_encoding_t* encoding, unsigned int channel) {
+    return channel * encoding->band_width + (encoding->band_width / 2) + encoding->base_frequency;
+}
+
+audio_encoding_t* AUDIO_ENCODING__initialize(uint32_t base_frequency, uint32_t band_width,
+                                             uint32_t channels_count, uint32_t concurrent_channels_count) {
+    /* Validate parameters, the channel tuples validate the channel counts. */
+    if (band_width == 0) {
+        LOG_ERROR("Invalid channel band width %u", band_width);
+        return NULL;
+    }
+
+    /* Allocate the encoding struct. */
+    audio_encoding_t* encoding = malloc(sizeof(audio_encoding_t));
+    if (encoding == NULL) {
+        LOG_ERROR("Failed to allocate audio encoding struct");
+        return NULL;
+    }
+
+    encoding->base_frequency = base_frequency;
+    encoding->band_width = band_width;
+    encoding->channels_count = channels_count;
+    encoding->concurrent_channels_count = concurrent_channels_count;
+
+    /* Build the channel tuples table. */
+    encoding->tuples = CHANNEL_TUPLES__initialize(channels_count, concurrent_channels_count);
+    if (encoding->tuples == NULL) {
+        LOG_ERROR("Failed to build the channel tuples table");
+        free(encoding);
+        return NULL;
     }
 
-    return sum;
+    return encoding;
 }
 
-/**
- * Recursively calculates the value of each received channel, summing their values.
- *
- * @param normalized_total_channels The total number for possible channels for the currently calculated channel value.
- * @param zero_channel_number The index of the "zero" channel.
- * @param channels_length The amount of channels remaining to set.
- * @param channels The array of channels to set.
- * @return The total value of the channels given.
- */
-static uint64_t decode_channels_recurse(unsigned int normalized_total_channels, unsigned int zero_channel_number,
-                                        size_t channels_length, unsigned int *channels) {
-    /* This is the end condition for the recursion, when there's no channels to decode. */
-    if (channels_length == 0) {
-        return 0;
+void AUDIO_ENCODING__free(audio_encoding_t* encoding) {
+    if (encoding == NULL) {
+        return;
     }
 
-    unsigned int normalized_channel = channels[0] - zero_channel_number;
-    uint64_t channel_value = calculate_channel_value(
-            normalized_total_channels,
-        channels_length - 1, /* The amount of lower order channels is the remaining channels without the current */
-        normalized_channel
-    );
-    return channel_value + decode_channels_recurse(
-        /* The amount of remaining channels is what we had minus the amount we took (since the channels must be in ascending order) */
-        normalized_total_channels - normalized_channel - 1,
-        /* The next channel zero number is the next number after the current channel number */
-        channels[0] + 1,
-        /* We advance the channels array to the next element */
-        channels_length - 1,
-        channels + 1
-    );
+    CHANNEL_TUPLES__free(encoding->tuples);
+    free(encoding);
 }
 
-/**
- * Decodes the given channels to an integer number.
- *
- * @param total_channels The number of possible channels to transmit over.
- * @param channels_length The amount of channels received.
- * @param channels The channels received.
- * @return The integer value decoded.
- */
-static uint64_t decode_channels(unsigned int total_channels, size_t channels_length, unsigned int *channels) {
-    /* We need to have the channels sorted for the algorithm */
-    qsort(channels, channels_length, sizeof(unsigned int), (int (*)(const void *, const void *)) compare_unsigned_ints);
-    return decode_channels_recurse(total_channels, 0, channels_length, channels);
+uint64_t AUDIO_ENCODING__get_values_count(audio_encoding_t* encoding) {
+    return CHANNEL_TUPLES__get_values_count(encoding->tuples);
+}
+
+uint32_t AUDIO_ENCODING__get_concurrent_channels_count(audio_encoding_t* encoding) {
+    return encoding->concurrent_channels_count;
 }
 
 /**
- * Tries to recursively encode an integer value to frequency channels.
+ * Folds recorded frequencies into their channels, keeping the peak magnitude heard on each channel.
+ * Frequencies outside of the channels (probably noise) are ignored.
  *
- * @param normalized_total_channels The total available channels.
- * @param zero_channel_number The index of the current "zero" channel.
- * @param remaining_to_encode The integer value to encode.
- * @param channels_length The length of the channels array.
- * @param channels The channels array to which we assign the channel values.
- * @return 0 On Success, -1 On Failure.
+ * @param encoding The encoding.
+ * @param frequencies_count The length of frequencies.
+ * @param frequencies Array of recorded frequencies.
+ * @param channel_peaks Returns the peak magnitude of each channel, `channels_count` long.
  */
-static int encode_channels_recurse(unsigned int normalized_total_channels, unsigned int zero_channel_number,
-                                   uint64_t remaining_to_encode, size_t channels_length, unsigned int *channels) {
-    /* End condition for the recursion */
-    if (channels_length == 0) {
-        if (remaining_to_encode != 0) {
-            /* We couldn't encode the remaining_to_encode properly with the amount of channels we had. */
-            return -1;
-        }
-        return 0;
+static void fold_channel_peaks(audio_encoding_t* encoding, size_t frequencies_count,
+                               const struct frequency_and_magnitude frequencies[], float channel_peaks[]) {
+    for (unsigned int channel = 0; channel < encoding->channels_count; ++channel) {
+        channel_peaks[channel] = 0;
     }
 
-    /* We iterate through the possible values for the current channel number,
-     * for each we calculate the channel numerical value and try to take the
-     * largest value that fits without overshooting remaining_to_encode */
-    unsigned int best_normalized_channel = 0;
-    uint64_t best_value = 0;
-    unsigned int number_of_lower_order_channels = channels_length - 1;
-    /* There's no need to calculate for 0, it's 0... */
-    for (int i = 1; i < normalized_total_channels - number_of_lower_order_channels; ++i) {
-        uint64_t test_value = calculate_channel_value(normalized_total_channels, number_of_lower_order_channels, i);
-        if (test_value > remaining_to_encode) {
-            /* The current value is too big, we can take the last value */
-            break;
+    for (size_t i = 0; i < frequencies_count; ++i) {
+        /* Transform the frequency into channel. */
+        int channel = frequency_to_channel_index(encoding, frequencies[i].frequency);
+        if (channel < 0 || channel >= (int)encoding->channels_count) {
+            continue;
         }
 
-        best_normalized_channel = i;
-        best_value = test_value;
-
-        if (test_value == remaining_to_encode) {
-            /* The current value is perfect, we are taking it */
-            break;
-        }
+        channel_peaks[channel] = fmaxf(channel_peaks[channel], frequencies[i].magnitude);
     }
-
-    /* We can update the channels */
-    channels[0] = best_normalized_channel + zero_channel_number;
-    return encode_channels_recurse(
-        /* The remaining total channels is reduced by what the current channel have taken */
-        normalized_total_channels - best_normalized_channel - 1,
-        /* The zero number for the next channel is the next channel after this one */
-        best_normalized_channel + zero_channel_number + 1,
-        /* Reduce what remains_to_encode by what we have encoded */
-        remaining_to_encode - best_value,
-        /* Advance the channels array */
-        channels_length - 1,
-        channels + 1
-    );
 }
 
 /**
- * Tries to encode an integer value to frequency channels.
+ * Decodes recorded frequencies to integer value.
  *
- * @param total_channels The total available number of channels.
- * @param value The value to encode.
- * @param channels_length The length of the channels array.
- * @param channels An array of channels to assign.
- * @return 0 On Success, -1 On Failure.
+ * @param encoding The encoding.
+ * @param value_out On success, returns the decoded value.
+ * @param frequencies_count The length of frequencies.
+ * @param frequencies Array of recorded frequencies.
+ * @param threshold The minimal magnitude that is considered "heard", in the same units as the given magnitudes.
+ * @return 0 on Success, -1 on Error, -2 on Quiet.
  */
-static int encode_channels(unsigned int total_channels, uint64_t value, size_t channels_length, unsigned int *channels) {
-    return encode_channels_recurse(total_channels, 0, value, channels_length, channels);
-}
-
-/**
- * Compares `frequency_and_magnitude` structs by their magnitudes for sorting.
- * The order is descending.
- *
- * @param a The first value.
- * @param b The second value.
- * @return The ordering between a and b.
- */
-static int compare_magnitudes(const struct frequency_and_magnitude* a, const struct frequency_and_magnitude* b) {
-    // Note: Reverse comparison for descending order
-    return -1 * compare_floats(&a->magnitude, &b->magnitude);
-}
-
-int AUDIO_ENCODING__decode_frequencies(uint64_t* value_out, size_t frequencies_count,
-                                       struct frequency_and_magnitude frequencies[]) {
+static int decode_frequencies(audio_encoding_t* encoding, uint64_t* value_out, size_t frequencies_count,
+                              const struct frequency_and_magnitude frequencies[], float threshold) {
     /* Validate parameters */
-    if (frequencies_count < NUMBER_OF_CONCURRENT_CHANNELS) {
-        LOG_ERROR("Expected at least %d frequencies, got: %lld", NUMBER_OF_CONCURRENT_CHANNELS, frequencies_count);
+    int concurrent_channels_count = (int)encoding->concurrent_channels_count;
+    if (frequencies_count < concurrent_channels_count) {
+        LOG_ERROR("Expected at least %d frequencies, got: %zu", concurrent_channels_count, frequencies_count);
         return -1;
     }
 
-    /* Sort the frequencies by their magnitudes */
-    qsort((void*)frequencies, frequencies_count, sizeof(struct frequency_and_magnitude),
-          (int (*)(const void *, const void *)) compare_magnitudes);
-
-    /* If there aren't at least NUMBER_OF_CONCURRENT_CHANNELS frequencies with some noticeable sound,
-     * we consider it as quiet and there's no reason to continue. */
-    if (frequencies[NUMBER_OF_CONCURRENT_CHANNELS - 1].magnitude <= AMPLITUDE_MAGNITUDE_THRESHOLD) {
-        return AUDIO_DECODE_RET_QUIET;
-    }
+    /* Each channel is heard at most once, by the loudest frequency in it's band. */
+    float channel_peaks[CHANNEL_TUPLES_MAX_CHANNELS];
+    fold_channel_peaks(encoding, frequencies_count, frequencies, channel_peaks);
 
+    /* Select the concurrent_channels_count loudest channels in a single pass,
+     * keeping them ordered by descending magnitude with an insertion step. */
     int channels_found = 0;
-    unsigned int channels[NUMBER_OF_CONCURRENT_CHANNELS];
-    for (int i = 0; i < frequencies_count && channels_found < NUMBER_OF_CONCURRENT_CHANNELS; i++) {
-        /* Check whether there's still sufficient sound. */
-        if (frequencies[i].magnitude <= AMPLITUDE_MAGNITUDE_THRESHOLD) {
-            LOG_VERBOSE("sound died out by frequency index %d", i);
-            break;
+    unsigned int channels[CHANNEL_TUPLES_MAX_CHANNELS];
+    float channel_magnitudes[CHANNEL_TUPLES_MAX_CHANNELS];
+    for (unsigned int channel = 0; channel < encoding->channels_count; ++channel) {
+        /* Check whether there's sufficient sound on the channel. */
+        float magnitude = channel_peaks[channel];
+        if (magnitude <= threshold) {
+            continue;
         }
 
-        /* Transform the frequency into channel. */
-        unsigned int channel = FREQUENCY_TO_CHANNEL_INDEX(frequencies[i].frequency);
-        if (channel >= NUMBER_OF_CHANNELS) {
-            LOG_VERBOSE("Invalid channel number: %d (probably due to noise)", channel);
+        /* Skip channels quieter than all of the currently selected ones. */
+        if (channels_found == concurrent_channels_count &&
+            magnitude <= channel_magnitudes[concurrent_channels_count - 1]) {
             continue;
         }
 
-        /* We shouldn't have duplicate channels. */
-        if (array_contains(channel, channels_found, channels)) {
-            LOG_VERBOSE("Channel %d found twice, might be due to noise, multiple speakers or general collision. skipping", channel);
-            continue;
+        /* Shift the quieter selected channels down, dropping the quietest if we're full. */
+        int position = min(channels_found, concurrent_channels_count - 1);
+        while (position > 0 && channel_magnitudes[position - 1] < magnitude) {
+            channels[position] = channels[position - 1];
+            channel_magnitudes[position] = channel_magnitudes[position - 1];
+            position--;
         }
 
-        LOG_VERBOSE("Found channel: %d (%.0fHz)", channel, frequencies[i].frequency);
-        channels[channels_found] = channel;
-        channels_found++;
+        channels[position] = channel;
+        channel_magnitudes[position] = magnitude;
+        channels_found = min(channels_found + 1, concurrent_channels_count);
     }
 
-    /* Couldn't find enough channels */
-    if (channels_found < NUMBER_OF_CONCURRENT_CHANNELS) {
+    /* If there aren't at least concurrent_channels_count channels with some noticeable sound,
+     * we consider it as quiet. */
+    if (channels_found < concurrent_channels_count) {
         return AUDIO_DECODE_RET_QUIET;
     }
 
-    /* Output the decoded channels value. */
-    LOG_VERBOSE("Trying to decode %d %d %d", channels[0], channels[1], channels[2]);
-    *value_out = decode_channels(NUMBER_OF_CHANNELS, NUMBER_OF_CONCURRENT_CHANNELS, channels);
+    /* Output the decoded channels value, the tuple's order doesn't matter as a mask. */
+    LOG_VERBOSE("Trying to decode %d channels, loudest %u", concurrent_channels_count, channels[0]);
+    uint64_t channels_mask = 0;
+    for (int i = 0; i < concurrent_channels_count; ++i) {
+        channels_mask |= (uint64_t)1 << channels[i];
+    }
+    *value_out = CHANNEL_TUPLES__get_value(encoding->tuples, channels_mask);
 
     /* Extra verbose debug prints */
 #ifdef VERBOSE
     printf("Decoded %llu: ", *value_out);
-    for(int i=0; i < NUMBER_OF_CONCURRENT_CHANNELS; ++i) {
-        printf("%d ", CHANNEL_INDEX_TO_FREQUENCY(channels[i]));
+    for(int i=0; i < concurrent_channels_count; ++i) {
+        printf("%d ", channel_index_to_frequency(encoding, channels[i]));
     }
 
     printf("\n");
@@ -250,32 +204,41 @@ int AUDIO_ENCODING__decode_frequencies(uint64_t* value_out, size_t frequencies_c
     return 0;
 }
 
-int AUDIO_ENCODING__encode_frequencies(uint64_t value, size_t frequencies_count,
-                                       uint32_t frequencies[]) {
-    unsigned int channels[NUMBER_OF_CONCURRENT_CHANNELS];
+int AUDIO_ENCODING__decode_frequencies(audio_encoding_t* encoding, uint64_t* value_out, size_t frequencies_count,
+                                       const struct frequency_and_magnitude frequencies[]) {
+    return decode_frequencies(encoding, value_out, frequencies_count, frequencies, AMPLITUDE_MAGNITUDE_THRESHOLD);
+}
 
+int AUDIO_ENCODING__decode_frequency_powers(audio_encoding_t* encoding, uint64_t* value_out,
+                                            size_t frequencies_count, const struct frequency_and_magnitude frequencies[]) {
+    return decode_frequencies(encoding, value_out, frequencies_count, frequencies,
+                              AMPLITUDE_MAGNITUDE_THRESHOLD * AMPLITUDE_MAGNITUDE_THRESHOLD);
+}
+
+int AUDIO_ENCODING__encode_frequencies(audio_encoding_t* encoding, uint64_t value, size_t frequencies_count,
+                                       uint32_t frequencies[]) {
     /* Validate parameters. */
-    if (frequencies_count != NUMBER_OF_CONCURRENT_CHANNELS) {
+    if (frequencies_count != encoding->concurrent_channels_count) {
         LOG_ERROR("Encode frequencies count exceeded maximum allowed");
         return -1;
     }
 
     /* Encode the value into channels. */
-    int ret = encode_channels(NUMBER_OF_CHANNELS, value, frequencies_count, channels);
-    if (ret != 0) {
+    const uint8_t* channels = CHANNEL_TUPLES__get_channels(encoding->tuples, value);
+    if (channels == NULL) {
         LOG_ERROR("Failed to encode value to channels");
-        return ret;
+        return -1;
     }
 
     /* Translate the channels into frequencies. */
     for (int i = 0; i < frequencies_count; ++i) {
-        frequencies[i] = CHANNEL_INDEX_TO_FREQUENCY(channels[i]);
+        frequencies[i] = channel_index_to_frequency(encoding, channels[i]);
     }
 
     /* Extra verbose debug prints */
 #ifdef VERBOSE
     printf("Encoded %llu: ", value);
-    for(int i=0; i < NUMBER_OF_CONCURRENT_CHANNELS; ++i) {
+    for(int i=0; i < frequencies_count; ++i) {
         printf("%d ", frequencies[i]);
     }
 
@@ -283,4 +246,8 @@ int AUDIO_ENCODING__encode_frequencies(uint64_t value, size_t frequencies_count,
 #endif
 
     return 0;
+}
+
+uint32_t AUDIO_ENCODING__get_channel_frequency(audio_encoding_t* encoding, unsigned int channel) {
+    return channel_index_to_frequency(encoding, channel);
 }
\ No newline at end of file
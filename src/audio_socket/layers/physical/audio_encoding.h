@@ -3,43 +3,96 @@
 
 #include "fft/fft.h"
 
-/** The lowest frequency transmitted. */
-#define BASE_CHANNEL_FREQUENCY (100)
-
-/** The separation width between transmitted frequencies. */
-#define CHANNEL_FREQUENCY_BAND_WIDTH (150)
-
-/** The number of different frequencies channels. */
-#define NUMBER_OF_CHANNELS (13)
-
-/** The number of frequency channel that are used simultaneously. */
-#define NUMBER_OF_CONCURRENT_CHANNELS (3)
-
 /** The minimal frequency amplitude that is considered "heard". */
 #define AMPLITUDE_MAGNITUDE_THRESHOLD (0.1)
 
 /** The return code from the decode function to signify quiet recording. */
 #define AUDIO_DECODE_RET_QUIET (-2)
 
+/**
+ * The audio encoding type, maps values to the channel carriers sounding them for a single channel plan.
+ * Each channel is a frequency band, a value is sounded on a distinct tuple of concurrent channels.
+ */
+typedef struct audio_encoding_s audio_encoding_t;
+
+/**
+ * Initializes an audio encoding for a channel plan.
+ *
+ * @param base_frequency The lowest frequency transmitted.
+ * @param band_width The separation width between transmitted frequencies.
+ * @param channels_count The number of different frequency channels.
+ * @param concurrent_channels_count The number of frequency channels that are used simultaneously.
+ * @return The initialized encoding, or NULL on failure.
+ */
+audio_encoding_t* AUDIO_ENCODING__initialize(uint32_t base_frequency, uint32_t band_width,
+                                             uint32_t channels_count, uint32_t concurrent_channels_count);
+
+/**
+ * Frees an audio encoding previously initialized with AUDIO_ENCODING__initialize.
+ *
+ * @param encoding The encoding to free.
+ */
+void AUDIO_ENCODING__free(audio_encoding_t* encoding);
+
+/**
+ * Gets the amount of values the encoding can sound (values are 0 to count - 1).
+ *
+ * @param encoding The encoding.
+ * @return The amount of values.
+ */
+uint64_t AUDIO_ENCODING__get_values_count(audio_encoding_t* encoding);
+
+/**
+ * Gets the number of frequencies sounded for each value.
+ *
+ * @param encoding The encoding.
+ * @return The number of concurrent channels.
+ */
+uint32_t AUDIO_ENCODING__get_concurrent_channels_count(audio_encoding_t* encoding);
+
 /**
  * Decodes recorded frequencies to integer value.
  *
+ * @param encoding The encoding.
  * @param value_out On success, returns the decoded value.
  * @param frequencies_count The length of frequencies.
  * @param frequencies Array of recorded frequencies.
  * @return 0 on Success, -1 on Error, -2 on Quiet.
  */
-int AUDIO_ENCODING__decode_frequencies(uint64_t* value_out, size_t frequencies_count,
-                                       struct frequency_and_magnitude frequencies[]);
+int AUDIO_ENCODING__decode_frequencies(audio_encoding_t* encoding, uint64_t* value_out, size_t frequencies_count,
+                                       const struct frequency_and_magnitude frequencies[]);
+
+/**
+ * Decodes recorded frequencies to integer value, where the magnitudes are squared (powers).
+ * Behaves exactly like `AUDIO_ENCODING__decode_frequencies`, saving the caller the per-frequency square root.
+ *
+ * @param encoding The encoding.
+ * @param value_out On success, returns the decoded value.
+ * @param frequencies_count The length of frequencies.
+ * @param frequencies Array of recorded frequencies, with squared magnitudes.
+ * @return 0 on Success, -1 on Error, -2 on Quiet.
+ */
+int AUDIO_ENCODING__decode_frequency_powers(audio_encoding_t* encoding, uint64_t* value_out,
+                                            size_t frequencies_count, const struct frequency_and_magnitude frequencies[]);
 
 /**
  * Encodes integer value to frequencies.
  *
+ * @param encoding The encoding.
  * @param value The value to encode.
- * @param frequencies_count The number of frequencies in the array.
+ * @param frequencies_count The number of frequencies in the array, the number of concurrent channels.
  * @param frequencies Output array of frequencies encoding the value.
- * @return
+ * @return 0 on Success, -1 on Error.
  */
-int AUDIO_ENCODING__encode_frequencies(uint64_t value, size_t frequencies_count,
+int AUDIO_ENCODING__encode_frequencies(audio_encoding_t* encoding, uint64_t value, size_t frequencies_count,
                                        uint32_t frequencies[]);
+
+/**
+ * Gets the carrier frequency transmitted for a channel (the middle of the channel's frequency band).
+ *
+ * @param encoding The encoding.
+ * @param channel The channel index, lower than the number of channels.
+ * @return The carrier frequency in Hz.
+ */
+uint32_t AUDIO_ENCODING__get_channel_frequency(audio_encoding_t* encoding, unsigned int channel);
 #endif //AUDIONET_AUDIO_ENCODING_H
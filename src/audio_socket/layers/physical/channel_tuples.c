@@ -0,0 +1,151 @@
+#include <malloc.h>
+
+#include "channel_tuples.h"
+#include "utils/logger.h"
+
+struct channel_tuples_s {
+    /** The amount of channels (n). */
+    unsigned int channels_count;
+
+    /** The amount of channels in each tuple (k). */
+    unsigned int concurrent_channels_count;
+
+    /** The amount of values, n choose k. */
+    uint64_t values_count;
+
+    /** The binomial coefficients, `binomials[i * (k + 1) + j]` is i choose j (for i <= n, j <= k). */
+    uint64_t* binomials;
+
+    /** The channels of each value, k ascending channels per value. */
+    uint8_t* channels;
+};
+
+/**
+ * Gets a binomial coefficient from the table.
+ *
+ * @param tuples The table.
+ * @param n The set size, up to the channels count.
+ * @param r The sample size, up to the concurrent channels count.
+ * @return n choose r.
+ */
+static inline uint64_t get_binomial(const channel_tuples_t* tuples, unsigned int n, unsigned int r) {
+    return tuples->binomials[n * (tuples->concurrent_channels_count + 1) + r];
+}
+
+channel_tuples_t* CHANNEL_TUPLES__initialize(unsigned int channels_count, unsigned int concurrent_channels_count) {
+    unsigned int k = concurrent_channels_count;
+
+    /* Validate parameters */
+    if (channels_count > CHANNEL_TUPLES_MAX_CHANNELS || k == 0 || k > channels_count) {
+        LOG_ERROR("Invalid channel tuples %u of %u", k, channels_count);
+        return NULL;
+    }
+
+    /* Allocate the table object */
+    channel_tuples_t* tuples = malloc(sizeof(channel_tuples_t));
+    if (tuples == NULL) {
+        LOG_ERROR("Failed to allocate channel tuples struct");
+        return NULL;
+    }
+    tuples->channels_count = channels_count;
+    tuples->concurrent_channels_count = k;
+    tuples->channels = NULL;
+
+    /* Fill Pascal's triangle, with at most 64 channels none of the coefficients overflows. */
+    tuples->binomials = calloc((channels_count + 1) * (k + 1), sizeof(uint64_t));
+    if (tuples->binomials == NULL) {
+        LOG_ERROR("Failed to allocate channel tuples binomials");
+        goto l_cleanup;
+    }
+    for (unsigned int n = 0; n <= channels_count; ++n) {
+        tuples->binomials[n * (k + 1)] = 1;
+        for (unsigned int r = 1; r <= k && r <= n; ++r) {
+            tuples->binomials[n * (k + 1) + r] = get_binomial(tuples, n - 1, r - 1) + get_binomial(tuples, n - 1, r);
+        }
+    }
+
+    tuples->values_count = get_binomial(tuples, channels_count, k);
+    if (tuples->values_count > CHANNEL_TUPLES_MAX_VALUES) {
+        LOG_ERROR("Too many channel tuples %u of %u", k, channels_count);
+        goto l_cleanup;
+    }
+
+    /* Enumerate the combinations in lexicographic order, the index of each is it's value. */
+    tuples->channels = malloc(tuples->values_count * k);
+    if (tuples->channels == NULL) {
+        LOG_ERROR("Failed to allocate channel tuples table");
+        goto l_cleanup;
+    }
+
+    uint8_t combination[CHANNEL_TUPLES_MAX_CHANNELS];
+    for (unsigned int i = 0; i < k; ++i) {
+        combination[i] = (uint8_t)i;
+    }
+    for (uint64_t value = 0; value < tuples->values_count; ++value) {
+        for (unsigned int i = 0; i < k; ++i) {
+            tuples->channels[value * k + i] = combination[i];
+        }
+
+        /* Advance the rightmost channel that can move, resetting the ones after it right behind it. */
+        int position = (int)k - 1;
+        while (position >= 0 && combination[position] == channels_count - k + position) {
+            position--;
+        }
+        if (position < 0) {
+            break;
+        }
+
+        combination[position]++;
+        for (unsigned int i = position + 1; i < k; ++i) {
+            combination[i] = combination[i - 1] + 1;
+        }
+    }
+
+    return tuples;
+
+l_cleanup:
+    CHANNEL_TUPLES__free(tuples);
+    return NULL;
+}
+
+void CHANNEL_TUPLES__free(channel_tuples_t* tuples) {
+    if (tuples == NULL) {
+        return;
+    }
+
+    free(tuples->binomials);
+    free(tuples->channels);
+    free(tuples);
+}
+
+uint64_t CHANNEL_TUPLES__get_values_count(channel_tuples_t* tuples) {
+    return tuples->values_count;
+}
+
+const uint8_t* CHANNEL_TUPLES__get_channels(channel_tuples_t* tuples, uint64_t value) {
+    if (value >= tuples->values_count) {
+        return NULL;
+    }
+
+    return &tuples->channels[value * tuples->concurrent_channels_count];
+}
+
+uint64_t CHANNEL_TUPLES__get_value(channel_tuples_t* tuples, uint64_t channels_mask) {
+    unsigned int n = tuples->channels_count;
+    unsigned int k = tuples->concurrent_channels_count;
+    uint64_t value = 0;
+    unsigned int first_free_channel = 0;
+
+    /* Every combination whose i'th channel is lower (with the same channels before it) precedes the tuple,
+     * for the channels skipped from `first_free_channel` up to the i'th channel `c` these count
+     * C(n - first_free_channel, k - i) - C(n - c, k - i). */
+    for (unsigned int i = 0; i < k && channels_mask != 0; ++i) {
+        unsigned int channel = (unsigned int)__builtin_ctzll(channels_mask);
+        channels_mask &= channels_mask - 1;
+
+        value += get_binomial(tuples, n - first_free_channel, k - i) - get_binomial(tuples, n - channel, k - i);
+        first_free_channel = channel + 1;
+    }
+
+    return value;
+}
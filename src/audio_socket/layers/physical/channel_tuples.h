@@ -0,0 +1,67 @@
+/**
+ * Defines the mapping between symbol values and the channel tuples transmitting them.
+ * A symbol is transmitted over k of the n channels at once, each k-combination of the channels is a value,
+ * numbered by the lexicographic order of the (ascending) combinations.
+ * The combinations are enumerated once into a table, so encoding is a lookup and decoding a few binomial lookups.
+ */
+
+#ifndef AUDIONET_CHANNEL_TUPLES_H
+#define AUDIONET_CHANNEL_TUPLES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** The maximal amount of channels, a channel tuple is given as a 64 bit mask. */
+#define CHANNEL_TUPLES_MAX_CHANNELS (64)
+
+/** The maximal amount of values (combinations) a table holds. */
+#define CHANNEL_TUPLES_MAX_VALUES (1 << 24)
+
+/**
+ * The channel tuples table type.
+ */
+typedef struct channel_tuples_s channel_tuples_t;
+
+/**
+ * Allocates and initializes a channel tuples table, enumerating every combination of the channels.
+ *
+ * @param channels_count The amount of channels (n), up to `CHANNEL_TUPLES_MAX_CHANNELS`.
+ * @param concurrent_channels_count The amount of channels in each tuple (k), 1 to n.
+ * @return The initialized table, or NULL on failure (or too many combinations).
+ */
+channel_tuples_t* CHANNEL_TUPLES__initialize(unsigned int channels_count, unsigned int concurrent_channels_count);
+
+/**
+ * Frees a table previously initialized with CHANNEL_TUPLES__initialize.
+ *
+ * @param tuples The table to free.
+ */
+void CHANNEL_TUPLES__free(channel_tuples_t* tuples);
+
+/**
+ * Gets the amount of values the tuples encode, n choose k.
+ *
+ * @param tuples The table.
+ * @return The amount of values.
+ */
+uint64_t CHANNEL_TUPLES__get_values_count(channel_tuples_t* tuples);
+
+/**
+ * Gets the channel tuple of a value.
+ *
+ * @param tuples The table.
+ * @param value The value.
+ * @return The value's channels in ascending order (k long, owned by the table), or NULL if the value is out of range.
+ */
+const uint8_t* CHANNEL_TUPLES__get_channels(channel_tuples_t* tuples, uint64_t value);
+
+/**
+ * Gets the value of a channel tuple.
+ *
+ * @param tuples The table.
+ * @param channels_mask The tuple's channels, bit i is set for channel i, exactly k bits must be set.
+ * @return The value.
+ */
+uint64_t CHANNEL_TUPLES__get_value(channel_tuples_t* tuples, uint64_t channels_mask);
+
+#endif //AUDIONET_CHANNEL_TUPLES_H
@@ -1,50 +1,138 @@
 #include <malloc.h>
+#include <inttypes.h>
 #include <math.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <sys/eventfd.h>
 
 #include "physical_layer.h"
 
 #include "audio/audio.h"
+#include "audio/audio_medium.h"
 #include "utils/logger.h"
 #include "fft/fft.h"
+#include "goertzel/goertzel.h"
+#include "decimator/decimator.h"
 #include "utils/utils.h"
+#include "wav/wav_file.h"
 #include "audio_encoding.h"
+#include "channel_tuples.h"
+#include "reframer.h"
+#include "symbol_cache.h"
 
-/** The length of time each value symbol will sound. */
-#define SYMBOL_LENGTH_MILLISECONDS (150)
+/** The length of time each preamble symbol will sound, in value symbol lengths. */
+#define PREAMBLE_SYMBOL_LENGTHS (2)
 
-/** The length of time each preamble symbol will sound. */
-#define PREAMBLE_SYMBOL_LENGTH_MILLISECONDS (SYMBOL_LENGTH_MILLISECONDS * 2)
+/** The length of time each post symbol will sound, in value symbol lengths. */
+#define POST_SYMBOL_LENGTHS (2)
 
-/** The length of time each post symbol will sound. */
-#define POST_SYMBOL_LENGTH_MILLISECONDS (SYMBOL_LENGTH_MILLISECONDS * 2)
+/** The length of time each seperator symbol will sound, in value symbol lengths. */
+#define SEP_SYMBOL_LENGTHS (1)
 
-/** The length of time each seperator symbol will sound. */
-#define SEP_SYMBOL_LENGTH_MILLISECONDS (SYMBOL_LENGTH_MILLISECONDS)
+/** The length of time each feedback (ACK/NACK) symbol will sound, in value symbol lengths. */
+#define FEEDBACK_SYMBOL_LENGTHS (2)
 
-/** The maximum amount of frames to be cached */
-#define MAX_FRAMES_COUNT (50)
+/**
+ * The length of the silence before each feedback symbol, in value symbol lengths.
+ * The frame being answered is done once it's post is heard, but the (half duplex) peer can't hear the feedback
+ * until it has finished playing the post.
+ */
+#define FEEDBACK_GUARD_SYMBOL_LENGTHS (POST_SYMBOL_LENGTHS)
+
+/**
+ * The amount of consecutive analysis windows a feedback symbol must be detected in to be reported,
+ * since unlike data it isn't framed by a preamble and post.
+ */
+#define FEEDBACK_MIN_WINDOWS (2)
+
+/** The fewest bits a data symbol carries, a byte per symbol. */
+#define MIN_SYMBOL_BITS (8)
+
+/**
+ * The largest frame the receive state machine assembles,
+ * a frame whose padded last symbol makes for an extra byte is one byte over the MTU until it's trimmed.
+ */
+#define FRAME_BUFFER_SIZE (PHYSICAL_LAYER_MTU + 1)
+
+/**
+ * How far (in samples) an analysis window may stick out of a byte slot and still vote on the byte,
+ * tolerating the timing recovered from the preamble's end being off by up to a hop.
+ */
+#define TIMED_FRAMING_SLOT_GUARD (ANALYSIS_WINDOW_SIZE / 4)
+
+/** The amount of consecutive windows that must hear data after the preamble to recover the timed framing's timing. */
+#define TIMED_FRAMING_SYNC_WINDOWS (2)
+
+/** The amount of recorded samples in each analysis window passed to the decoder (before decimation). */
+#define ANALYSIS_WINDOW_SIZE (SAMPLE_RATE_48000_SAMPLE_SIZE)
+
+/** The alignment of the analysis window buffers, enough for any SIMD load. */
+#define ANALYSIS_WINDOW_ALIGNMENT (64)
 
 /**
- * Defines the numerical value of each symbol, while data symbols are their own value.
+ * How far above the top channel's band edge the decimated Nyquist frequency must be,
+ * leaving room for the decimation filter's transition band.
+ */
+#define DECIMATION_GUARD_RATIO (1.25)
+
+/** The default amount of samples between consecutive analysis windows (no overlap). */
+#define ANALYSIS_HOP_SIZE (ANALYSIS_WINDOW_SIZE)
+
+/** The amount of recorded samples the capture ring can hold (rounded up to a power of two), about 2.7 seconds of backlog. */
+#define CAPTURE_RING_CAPACITY (SAMPLE_RATE_48000 * 2)
+
+/**
+ * Defines the numerical value of each signal symbol, as an offset past the data values
+ * (the 256 byte values 0-255 with the default channel plan), while data symbols are their own value.
+ * Each signal owns the values up to the next signal, and is sent as it's second value for some tolerance.
  */
 enum signals {
+    /** Ack feedback symbol code */
+    SIGNAL_ACK = 4,
 
-    /* 256 byte values 0-255 */
+    /** Nack feedback symbol code */
+    SIGNAL_NACK = 9,
 
     /** Preamble symbol code */
-    SIGNAL_PREAMBLE = 270,
+    SIGNAL_PREAMBLE = 14,
 
     /** Seperator symbol code */
-    SIGNAL_SEP = 275,
+    SIGNAL_SEP = 19,
 
     /** Post symbol code */
-    SIGNAL_POST = 280,
+    SIGNAL_POST = 24,
+
+    /**
+     * Post symbol code of a frame whose zero padded last symbol makes for an extra byte, which is trimmed.
+     * Only used when data symbols carry more than a byte.
+     */
+    SIGNAL_POST_TRIM = 29,
 
-    /** The maximal symbol value (inclusive) */
-    SIGNAL_MAX = 285
+    /** The amount of values the signals span past the data values, without `SIGNAL_POST_TRIM` */
+    SIGNALS_SPAN = 30,
+
+    /** The amount of values the signals span past the data values, with `SIGNAL_POST_TRIM` */
+    SIGNALS_SPAN_WITH_TRIM = 35
+};
+
+/**
+ * The kinds of symbols a decoded value may be.
+ */
+enum symbol_kind {
+    SYMBOL_DATA,
+    SYMBOL_ACK,
+    SYMBOL_NACK,
+    SYMBOL_PREAMBLE,
+    SYMBOL_SEP,
+    SYMBOL_POST,
+    SYMBOL_POST_TRIM,
+    SYMBOL_UNKNOWN,
 };
 
 /**
@@ -54,6 +142,9 @@ enum state_e {
     /** Waiting for preamble */
     STATE_PREAMBLE,
 
+    /** (Timed framing) Preamble heard, waiting for it's end to recover the symbol timing */
+    STATE_SYNC,
+
     /** Collecting data */
     STATE_WORD,
 
@@ -61,6 +152,20 @@ enum state_e {
     STATE_DISCARDING,
 };
 
+/**
+ * What the reader waits for, when it's blocked (or polling the readiness descriptor).
+ */
+enum reader_wait_e {
+    /** The reader is handling what it got, it isn't waiting. */
+    READER_WAIT_NONE,
+
+    /** Waiting for a frame. */
+    READER_WAIT_FRAME,
+
+    /** Waiting for a feedback or a frame. */
+    READER_WAIT_FEEDBACK,
+};
+
 
 /**
  * Contains the data that has been (or currently is) received for a single packet.
@@ -69,211 +174,1453 @@ struct packet_buffer {
     /** The current amount of bytes filled into `buffer`. */
     uint32_t packet_size;
 
-    /** Whether the packet has been full received and is considered ready. */
-    bool is_ready;
-
     /** Buffer containing the packet received. */
-    uint8_t buffer[PHYSICAL_LAYER_MTU];
+    uint8_t buffer[FRAME_BUFFER_SIZE];
+
+    /** Bit i is set if byte i of `buffer` is unreliable (it's vote had no majority winner). */
+    uint16_t erasures;
 };
 
 struct audio_physical_layer_socket_s {
     /** The audio module for recording/playback. */
     audio_t* audio;
 
-    /** The FFT module for recorded data decoding. */
+    /** The pre-rendered PCM of the transmitted symbols. */
+    symbol_cache_t* symbol_cache;
+
+    /** The silence played before each feedback symbol. */
+    struct pcm_segment_s feedback_guard;
+
+    /** Maps symbol values to the channel carriers of the configured channel plan. */
+    audio_encoding_t* encoding;
+
+    /** The amount of channels of the configured channel plan. */
+    uint32_t channels_count;
+
+    /** The amount of bits each data symbol carries. */
+    uint32_t symbol_bits;
+
+    /** The amount of data symbol values, the signals' values follow them. */
+    uint32_t data_values_count;
+
+    /** The maximal symbol value (inclusive). */
+    uint64_t signal_max;
+
+    /** The length of time each value symbol sounds. */
+    uint32_t symbol_length_milliseconds;
+
+    /** The amount of samples each value symbol sounds for, the symbol slot length of the timed framing. */
+    uint64_t symbol_length_samples;
+
+    /** The amount of samples each preamble symbol sounds for. */
+    uint64_t preamble_length_samples;
+
+    /** The detector used for recorded data decoding. */
+    enum physical_layer_detector detector;
+
+    /** The FFTW wisdom cache file used when planning the FFT module (or NULL). */
+    const char* fft_wisdom_path;
+
+    /** The FFT module for recorded data decoding (when `detector` is FFT). */
     fft_t* fft;
 
+    /** The Goertzel filter bank for recorded data decoding (when `detector` is Goertzel). */
+    goertzel_t* goertzel;
+
+    /** Collects the recorded samples into fixed size analysis windows. */
+    reframer_t* reframer;
+
+    /** The buffer holding the analysis window currently being decoded. */
+    float* analysis_window;
+
+    /** The band-limiting decimator in front of the detector, or NULL when decimation is disabled. */
+    decimator_t* decimator;
+
+    /** The buffer holding the decimated analysis window (when decimating). */
+    float* detector_window;
+
+    /** The amount of samples the detector analyzes per window. */
+    uint32_t detector_window_size;
+
+    /** The sample rate the detector analyzes at. */
+    float detector_sample_rate;
+
+    /** The framing frames are sent and received with. */
+    enum physical_layer_framing framing;
+
+    /** The offset of an analysis window's center from it's first recorded sample. */
+    uint64_t window_center_offset;
+
     /** The current state in the state machine. */
     enum state_e state;
 
-    /** The current byte's votes. */
-    int byte_votes[256];
+    /** (Timed framing) The stream position of the center of the last window that heard the preamble. */
+    uint64_t preamble_last_center;
+
+    /** (Timed framing) The stream position of the center of the first window that heard data after the preamble. */
+    uint64_t sync_data_center;
+
+    /** (Timed framing) The amount of consecutive windows that heard data after the preamble. */
+    uint32_t sync_data_windows;
+
+    /** (Timed framing) The stream position the frame's first byte symbol starts at. */
+    uint64_t frame_start;
+
+    /** (Timed framing) The index of the symbol slot currently voted on. */
+    uint32_t symbol_index;
 
-    /** Whether there's been a voting for the current byte. */
-    bool is_byte_voted;
+    /** The current symbol's votes, `data_values_count` long. */
+    int* symbol_votes;
 
-    /** Array of buffer structs, each one contains a packet and it's state. */
-    struct packet_buffer packet_buffers[MAX_FRAMES_COUNT];
+    /** Whether there's been a voting for the current symbol. */
+    bool is_symbol_voted;
 
-    /** The index of the packet buffer that's currently being written. */
-    int packet_write_index;
+    /** The received bits not yet completing a byte, the last `pending_bits_count` bits. */
+    uint32_t pending_bits;
 
-    /** The index of the packet buffer that's to be read when ready. */
-    int packet_read_index;
+    /** Bit i is set if bit i of `pending_bits` is unreliable. */
+    uint32_t pending_erased_bits;
+
+    /** The amount of received bits not yet completing a byte. */
+    uint32_t pending_bits_count;
+
+    /** The feedback signal detected in the last analysis windows. */
+    enum physical_layer_feedback feedback_candidate;
+
+    /** The amount of consecutive analysis windows `feedback_candidate` has been detected in. */
+    uint32_t feedback_windows;
+
+    /** The socket's last transmission time when `feedback_candidate` was first detected. */
+    uint64_t feedback_candidate_sent_nanoseconds;
+
+    /**
+     * The last feedback received, as the monotonic time it was detected at shifted left once, ored with 1 for a NACK.
+     * Zero if no feedback was ever received.
+     */
+    atomic_uint_fast64_t feedback_event;
+
+    /** The detection time of the last feedback returned to the reader, owned by the reader. */
+    uint64_t feedback_consumed_nanoseconds;
+
+    /** The monotonic time the last waited transmission finished at, older feedback can't be a response to it. */
+    atomic_uint_fast64_t last_sent_nanoseconds;
+
+    /**
+     * The received frames ring, a single-producer/single-consumer ring between the decode worker and the reader.
+     * The frame at position `p` is held at index `p % frame_ring_capacity`.
+     */
+    struct packet_buffer* frame_ring;
+
+    /** The amount of frames the ring can hold. */
+    uint32_t frame_ring_capacity;
+
+    /**
+     * The amount of frames ever received, the position of the frame currently being written, owned by the decode worker.
+     * Published with release semantics so the reader sees the frame before the position.
+     */
+    _Atomic uint64_t frame_ring_write_position;
+
+    /**
+     * The amount of frames ever popped, the position of the frame to be read, owned by the reader.
+     * Published with release semantics so the decode worker won't overwrite a frame still being read.
+     */
+    _Atomic uint64_t frame_ring_read_position;
 
     /** The configured timeout for recv operation. */
-    int recv_timeout_seconds;
+    int recv_timeout_milliseconds;
+
+    /** Protects waiting on `packet_ready`. */
+    pthread_mutex_t packet_ready_lock;
+
+    /** Signaled by the decode worker whenever a packet buffer becomes ready. */
+    pthread_cond_t packet_ready;
+
+    /** What the reader waits for, protected by `packet_ready_lock`, for a lock-step medium's idle check. */
+    enum reader_wait_e reader_wait;
+
+    /** A semaphore eventfd counting the frames in the frame ring, readable while there's a frame to read. */
+    int ready_fd;
+
+    /** The decode worker, consumes the capture ring and runs the receive state machine. */
+    pthread_t decode_thread;
+
+    /** Whether `decode_thread` has been started (and has to be joined). */
+    bool is_decode_thread_started;
+
+    /** Cleared to ask the decode worker to exit. */
+    atomic_bool is_decode_running;
+
+    /** Posted by the capture callback after each recording to wake the decode worker. */
+    sem_t capture_ready;
+
+    /** Set by the decode worker while it sleeps, having decoded every complete window. */
+    atomic_bool is_decode_idle;
+
+    /** The WAV file the decode worker writes every decoded capture sample into (the tap), or NULL. */
+    wav_writer_t* capture_tap;
+
+    /** The stream index of the first capture sample not yet written into the tap. */
+    uint64_t capture_tap_position;
+
+    /** The amount of recording callbacks handled. */
+    atomic_uint_fast64_t capture_callbacks;
+
+    /** The amount of recorded samples dropped since the capture ring was full. */
+    atomic_uint_fast64_t capture_overrun_samples;
+
+    /** The highest capture ring fill seen by the capture callback. */
+    atomic_uint_fast64_t capture_queue_max_depth;
+
+    /** The longest time spent inside the capture callback. */
+    atomic_uint_fast64_t capture_callback_max_nanoseconds;
+
+    /** The amount of analysis windows decoded by the worker. */
+    atomic_uint_fast64_t windows_decoded;
+
+    /** The amount of frames dropped since the frame ring was full. */
+    atomic_uint_fast64_t frame_ring_overflows;
+
+    /** The highest frame ring fill seen by the decode worker. */
+    atomic_uint_fast64_t frame_ring_max_depth;
+
+    /** The amount of data symbols registered by the decode worker. */
+    atomic_uint_fast64_t symbols_received;
+
+    /** The amount of registered data symbols without a majority winner. */
+    atomic_uint_fast64_t symbols_erased;
 };
 
+/**
+ * Gets the frame currently being written by the decode worker.
+ *
+ * @param socket The socket.
+ * @return The frame being written, or NULL if the frame ring is full.
+ */
+static struct packet_buffer* get_write_frame(audio_physical_layer_socket_t* socket) {
+    /* Only the decode worker changes the write position, so a relaxed load is enough. */
+    uint64_t write_position = atomic_load_explicit(&socket->frame_ring_write_position, memory_order_relaxed);
+    uint64_t read_position = atomic_load_explicit(&socket->frame_ring_read_position, memory_order_acquire);
+    if (write_position - read_position >= socket->frame_ring_capacity) {
+        return NULL;
+    }
+
+    return &socket->frame_ring[write_position % socket->frame_ring_capacity];
+}
+
+/**
+ * Publishes the frame being written by the decode worker to the reader, and wakes any waiting reader.
+ *
+ * @param socket The socket.
+ */
+static void publish_write_frame(audio_physical_layer_socket_t* socket) {
+    uint64_t write_position = atomic_load_explicit(&socket->frame_ring_write_position, memory_order_relaxed) + 1;
+    uint64_t read_position = atomic_load_explicit(&socket->frame_ring_read_position, memory_order_relaxed);
+
+    /* Only the decode worker updates the maximum, so there's no need for a compare-exchange. */
+    uint64_t depth = write_position - read_position;
+    if (depth > atomic_load_explicit(&socket->frame_ring_max_depth, memory_order_relaxed)) {
+        atomic_store_explicit(&socket->frame_ring_max_depth, depth, memory_order_relaxed);
+    }
+
+    /* The readiness descriptor is counted before the frame is published, so a pop never finds it empty. */
+    uint64_t frame_count = 1;
+    if (write(socket->ready_fd, &frame_count, sizeof(frame_count)) != sizeof(frame_count)) {
+        LOG_ERROR("Failed to signal readiness descriptor");
+    }
+
+    pthread_mutex_lock(&socket->packet_ready_lock);
+    atomic_store_explicit(&socket->frame_ring_write_position, write_position, memory_order_release);
+    pthread_cond_broadcast(&socket->packet_ready);
+    pthread_mutex_unlock(&socket->packet_ready_lock);
+}
+
+/**
+ * Gets the oldest received frame, to be read by the reader.
+ *
+ * @param socket The socket.
+ * @return The frame to read, or NULL if the frame ring is empty.
+ */
+static struct packet_buffer* get_read_frame(audio_physical_layer_socket_t* socket) {
+    /* Only the reader changes the read position, so a relaxed load is enough. */
+    uint64_t read_position = atomic_load_explicit(&socket->frame_ring_read_position, memory_order_relaxed);
+    uint64_t write_position = atomic_load_explicit(&socket->frame_ring_write_position, memory_order_acquire);
+    if (read_position == write_position) {
+        return NULL;
+    }
+
+    return &socket->frame_ring[read_position % socket->frame_ring_capacity];
+}
+
+static uint64_t monotonic_nanoseconds(void);
+
+/**
+ * Publishes a detected feedback signal to the reader, and wakes any waiting reader.
+ *
+ * @param socket The socket.
+ * @param feedback The detected feedback.
+ */
+static void publish_feedback(audio_physical_layer_socket_t* socket, enum physical_layer_feedback feedback) {
+    uint64_t event = (monotonic_nanoseconds() << 1) | (feedback == PHYSICAL_LAYER_FEEDBACK_NACK);
+
+    pthread_mutex_lock(&socket->packet_ready_lock);
+    atomic_store_explicit(&socket->feedback_event, event, memory_order_release);
+    pthread_cond_broadcast(&socket->packet_ready);
+    pthread_mutex_unlock(&socket->packet_ready_lock);
+}
+
+/**
+ * Checks whether a feedback was received since the reader's last transmission (and last consumed feedback).
+ *
+ * @param socket The socket.
+ * @param event The last feedback event.
+ * @return Whether the feedback is new to the reader.
+ */
+static bool is_feedback_pending(audio_physical_layer_socket_t* socket, uint64_t event) {
+    uint64_t detected_nanoseconds = event >> 1;
+    return detected_nanoseconds > socket->feedback_consumed_nanoseconds &&
+           detected_nanoseconds > atomic_load_explicit(&socket->last_sent_nanoseconds, memory_order_acquire);
+}
+
+/**
+ * Gets the feedback received since the reader's last transmission (and last consumed feedback), consuming it.
+ *
+ * @param socket The socket.
+ * @param feedback Returns the feedback.
+ * @return true if there was a new feedback, false otherwise.
+ */
+static bool consume_feedback(audio_physical_layer_socket_t* socket, enum physical_layer_feedback* feedback) {
+    uint64_t event = atomic_load_explicit(&socket->feedback_event, memory_order_acquire);
+    if (!is_feedback_pending(socket, event)) {
+        return false;
+    }
+
+    socket->feedback_consumed_nanoseconds = event >> 1;
+    *feedback = (event & 1) ? PHYSICAL_LAYER_FEEDBACK_NACK : PHYSICAL_LAYER_FEEDBACK_ACK;
+    return true;
+}
+
 /**
  * Takes a recording and tries to decode it's frequencies into an integer value.
  *
- * @param fft The FFT engine for getting frequencies from the recording.
+ * @param socket The socket, holding the configured detector for getting frequencies from the recording.
  * @param recorded_frame The recorded sound data.
  * @param size The length of the recorded data buffer.
  * @param value_out Returns the decoded value from the recoded data.
  * @return 0 on Success, -1 on Failure.
  */
-static int decode_recording(fft_t* fft, const float* recorded_frame, size_t size, uint64_t* value_out) {
+static int decode_recording(audio_physical_layer_socket_t* socket, const float* recorded_frame, size_t size, uint64_t* value_out) {
     int ret;
     size_t count_frequencies;
     struct frequency_and_magnitude* frequencies = NULL;
+    bool is_squared;
+
+    /* Get the frequencies in from the recording using the configured detector,
+     * both detectors own their output buffers so nothing is allocated per window. */
+    switch (socket->detector) {
+        case PHYSICAL_LAYER_DETECTOR_GOERTZEL:
+            ret = GOERTZEL__calculate(socket->goertzel, recorded_frame, size, &frequencies, &count_frequencies);
+            is_squared = false;
+            break;
+        case PHYSICAL_LAYER_DETECTOR_FFT:
+        default:
+            /* Ordering by power is the same as by magnitude, so we can skip the per-bin square root. */
+            ret = FFT__execute(socket->fft, recorded_frame, size, true, &frequencies, &count_frequencies);
+            is_squared = true;
+            break;
+    }
+    if (ret != 0) {
+        LOG_ERROR("Failed to calculate frequencies on provided sound frame");
+        return -1;
+    }
+
+    /* Decode the recording. */
+    if (is_squared) {
+        ret = AUDIO_ENCODING__decode_frequency_powers(socket->encoding, value_out, count_frequencies, frequencies);
+    } else {
+        ret = AUDIO_ENCODING__decode_frequencies(socket->encoding, value_out, count_frequencies, frequencies);
+    }
+    if (ret == AUDIO_DECODE_RET_QUIET) {
+        LOG_VERBOSE("Quiet");
+    } else if (ret != 0) {
+        LOG_ERROR("Failed to decode frequencies");
+    }
+
+    return ret;
+}
+
+/**
+ * Gets the kind of symbol a decoded value is.
+ *
+ * @param socket The socket, holding the channel plan's symbol values.
+ * @param value The decoded value.
+ * @return The kind of symbol.
+ */
+static enum symbol_kind classify_symbol(audio_physical_layer_socket_t* socket, uint64_t value) {
+    if (value < socket->data_values_count) {
+        return SYMBOL_DATA;
+    } else if (value > socket->signal_max) {
+        return SYMBOL_UNKNOWN;
+    }
+
+    uint64_t offset = value - socket->data_values_count;
+    if (offset < SIGNAL_ACK) {
+        return SYMBOL_UNKNOWN;
+    } else if (offset < SIGNAL_NACK) {
+        return SYMBOL_ACK;
+    } else if (offset < SIGNAL_PREAMBLE) {
+        return SYMBOL_NACK;
+    } else if (offset < SIGNAL_SEP) {
+        return SYMBOL_PREAMBLE;
+    } else if (offset < SIGNAL_POST) {
+        return SYMBOL_SEP;
+    } else if (offset < SIGNAL_POST_TRIM) {
+        return SYMBOL_POST;
+    }
+
+    /* The last signal also owns the maximal value. */
+    return (socket->symbol_bits > MIN_SYMBOL_BITS) ? SYMBOL_POST_TRIM : SYMBOL_POST;
+}
+
+/**
+ * Gets the value a signal is sent as.
+ * We defined some tolerances for the signaling symbols, a +1 will give better results.
+ *
+ * @param socket The socket, holding the channel plan's symbol values.
+ * @param signal The signal.
+ * @return The value to send.
+ */
+static uint64_t get_signal_value(audio_physical_layer_socket_t* socket, enum signals signal) {
+    return socket->data_values_count + signal + 1;
+}
+
+/**
+ * Clears the current symbol's votes.
+ *
+ * @param socket The socket whose votes are cleared.
+ */
+static void clear_symbol_votes(audio_physical_layer_socket_t* socket) {
+    memset(socket->symbol_votes, 0, socket->data_values_count * sizeof(int));
+    socket->is_symbol_voted = false;
+}
+
+/**
+ * Starts receiving a new frame into the frame being written.
+ *
+ * @param socket The socket.
+ * @param buffer The frame being written.
+ */
+static void start_frame(audio_physical_layer_socket_t* socket, struct packet_buffer* buffer) {
+    buffer->packet_size = 0;
+    buffer->erasures = 0;
+    socket->pending_bits = 0;
+    socket->pending_erased_bits = 0;
+    socket->pending_bits_count = 0;
+}
+
+/**
+ * Registers the winner of the current symbol vote as the next bits of the frame being written,
+ * appending every byte the symbol completes.
+ * A symbol whose winner doesn't hold a majority of the votes marks the bytes it's bits are in as erased,
+ * for the link layer's error correction.
+ *
+ * @param socket The socket whose votes are registered.
+ * @param buffer The frame being written.
+ * @return 0 On Success, -1 if the symbol doesn't fit in the frame.
+ */
+static int register_symbol_vote(audio_physical_layer_socket_t* socket, struct packet_buffer* buffer) {
+    /* Validate the frame size. */
+    uint32_t bits_count = socket->pending_bits_count + socket->symbol_bits;
+    if (buffer->packet_size + bits_count / 8 > FRAME_BUFFER_SIZE) {
+        return -1;
+    }
+
+    int total_votes = 0;
+    for (uint32_t i = 0; i < socket->data_values_count; ++i) {
+        total_votes += socket->symbol_votes[i];
+    }
+
+    int winner = find_max_index(socket->data_values_count, socket->symbol_votes);
+    uint32_t erased_bits = (socket->symbol_votes[winner] * 2 <= total_votes) ? (1U << socket->symbol_bits) - 1 : 0;
+    atomic_fetch_add_explicit(&socket->symbols_received, 1, memory_order_relaxed);
+    if (erased_bits != 0) {
+        atomic_fetch_add_explicit(&socket->symbols_erased, 1, memory_order_relaxed);
+    }
+
+    /* Append the symbol's bits, most significant first, and emit every byte they complete. */
+    socket->pending_bits = (socket->pending_bits << socket->symbol_bits) | (uint32_t)winner;
+    socket->pending_erased_bits = (socket->pending_erased_bits << socket->symbol_bits) | erased_bits;
+    socket->pending_bits_count = bits_count;
+    while (socket->pending_bits_count >= 8) {
+        socket->pending_bits_count -= 8;
+        if ((uint8_t)(socket->pending_erased_bits >> socket->pending_bits_count) != 0) {
+            buffer->erasures |= (uint16_t)(1 << buffer->packet_size);
+        }
+
+        buffer->buffer[buffer->packet_size] = (uint8_t)(socket->pending_bits >> socket->pending_bits_count);
+        LOG_DEBUG("data: %hhu (%c)", buffer->buffer[buffer->packet_size], buffer->buffer[buffer->packet_size]);
+        buffer->packet_size++;
+    }
+
+    return 0;
+}
+
+/**
+ * Finishes the frame being written on a post signal, publishing it to the reader.
+ * Bits left over from the last symbol are it's padding and are dropped.
+ *
+ * @param socket The socket.
+ * @param is_trimmed Whether the post signals that the padding made for an extra byte.
+ */
+static void finish_frame(audio_physical_layer_socket_t* socket, bool is_trimmed) {
+    struct packet_buffer* buffer = get_write_frame(socket);
+    if (is_trimmed && buffer->packet_size > 0) {
+        buffer->packet_size--;
+        buffer->erasures &= (uint16_t)~(1 << buffer->packet_size);
+    }
+
+    if (buffer->packet_size > PHYSICAL_LAYER_MTU) {
+        LOG_DEBUG("Frame too long -> dropping");
+    } else if (buffer->packet_size > 0) {
+        publish_write_frame(socket);
+    }
+}
+
+/**
+ * Closes the symbol slot currently voted on in the timed framing, registering the vote winner into the frame.
+ * A slot no window voted on is still registered (as an erased zero), keeping the following symbols aligned.
+ *
+ * @param socket The socket to update.
+ */
+static void close_timed_symbol(audio_physical_layer_socket_t* socket) {
+    /* The write frame was reserved on the preamble. */
+    struct packet_buffer* buffer = get_write_frame(socket);
+
+    if (!socket->is_symbol_voted) {
+        LOG_DEBUG("No votes for symbol %u", socket->symbol_index);
+    }
+
+    /* A frame longer than the MTU can't be valid, it's timing is lost so we wait for the next preamble. */
+    if (register_symbol_vote(socket, buffer) != 0) {
+        LOG_DEBUG("Timed frame too long -> dropping");
+        socket->state = STATE_PREAMBLE;
+    }
+
+    /* Clear the votes. */
+    clear_symbol_votes(socket);
+    socket->symbol_index++;
+}
+
+/**
+ * Executes the timed framing state machine step for a decoded analysis window.
+ * The symbols are delimited by time, symbol `i` sounds `symbol_length_samples` samples from `i` symbols after the
+ * preamble's end, so only windows (mostly) inside a symbol's slot vote on it.
+ *
+ * @param socket The socket to update.
+ * @param value The value decoded from the window.
+ * @param kind The kind of symbol the value is.
+ * @param center The stream position of the window's center.
+ */
+static void handle_timed_symbol(audio_physical_layer_socket_t* socket, uint64_t value, enum symbol_kind kind,
+                                uint64_t center) {
+    bool is_preamble = (kind == SYMBOL_PREAMBLE);
+    bool is_post = (kind == SYMBOL_POST || kind == SYMBOL_POST_TRIM);
+
+    switch (socket->state) {
+        case STATE_PREAMBLE:
+            if (is_preamble) {
+                LOG_DEBUG("Preamble");
+                struct packet_buffer* buffer = get_write_frame(socket);
+                if (buffer == NULL) {
+                    /* The frame ring is full and there's nowhere to receive into, start discarding. */
+                    LOG_DEBUG("Preamble with full frame ring -> discarding");
+                    atomic_fetch_add_explicit(&socket->frame_ring_overflows, 1, memory_order_relaxed);
+                    socket->state = STATE_DISCARDING;
+                } else {
+                    /* Starting new buffer, wait for the preamble to end. */
+                    start_frame(socket, buffer);
+                    socket->preamble_last_center = center;
+                    socket->sync_data_windows = 0;
+                    socket->state = STATE_SYNC;
+                }
+            }
+            return;
+
+        case STATE_SYNC:
+            if (is_preamble) {
+                socket->preamble_last_center = center;
+                socket->sync_data_windows = 0;
+                return;
+            } else if (kind != SYMBOL_DATA) {
+                /* Windows straddling the preamble's end may decode as anything, but data must follow shortly. */
+                socket->sync_data_windows = 0;
+                if (center - socket->preamble_last_center > socket->preamble_length_samples) {
+                    socket->state = STATE_PREAMBLE;
+                }
+                return;
+            }
+
+            /* A single data window may be a misdetection within the preamble, the data must be heard consistently. */
+            if (socket->sync_data_windows == 0) {
+                socket->sync_data_center = center;
+            }
+            socket->sync_data_windows++;
+            if (socket->sync_data_windows < TIMED_FRAMING_SYNC_WINDOWS) {
+                return;
+            }
+
+            /* The first symbol starts between the last window that heard the preamble and the first that didn't. */
+            socket->frame_start = (socket->preamble_last_center + socket->sync_data_center) / 2;
+            socket->symbol_index = 0;
+            clear_symbol_votes(socket);
+            socket->state = STATE_WORD;
+            break;
+
+        case STATE_WORD:
+            /* A preamble heard right after the frame started means the sync happened on noise ahead of it, resync. */
+            if (is_preamble && center < socket->frame_start + socket->preamble_length_samples) {
+                start_frame(socket, get_write_frame(socket));
+                socket->preamble_last_center = center;
+                socket->sync_data_windows = 0;
+                socket->state = STATE_SYNC;
+                return;
+            }
+            break;
+
+        case STATE_DISCARDING:
+        default:
+            if (is_post) {
+                socket->state = STATE_PREAMBLE;
+            }
+            return;
+    }
+
+    /* Windows straddling the preamble's end don't vote. */
+    if (center < socket->frame_start) {
+        return;
+    }
+    uint64_t offset = center - socket->frame_start;
+
+    if (is_post) {
+        LOG_DEBUG("Post");
+
+        /* The post starts right after the last symbol, close every symbol up to it and publish the frame. */
+        uint64_t symbols_count = (offset + ANALYSIS_WINDOW_SIZE / 2) / socket->symbol_length_samples;
+        while (socket->state == STATE_WORD && socket->symbol_index < symbols_count) {
+            close_timed_symbol(socket);
+        }
+
+        if (socket->state == STATE_WORD) {
+            finish_frame(socket, kind == SYMBOL_POST_TRIM);
+        }
+        socket->state = STATE_PREAMBLE;
+        return;
+    }
+
+    /* Close the symbols the window has moved past. */
+    uint64_t slot = offset / socket->symbol_length_samples;
+    while (socket->state == STATE_WORD && socket->symbol_index < slot) {
+        close_timed_symbol(socket);
+    }
+    if (socket->state != STATE_WORD) {
+        return;
+    }
+
+    /* Only a window (mostly) inside the slot votes on the symbol. */
+    uint64_t slot_offset = offset - slot * socket->symbol_length_samples;
+    if (kind == SYMBOL_DATA &&
+            slot_offset + TIMED_FRAMING_SLOT_GUARD >= ANALYSIS_WINDOW_SIZE / 2 &&
+            slot_offset <= socket->symbol_length_samples - ANALYSIS_WINDOW_SIZE / 2 + TIMED_FRAMING_SLOT_GUARD) {
+        socket->is_symbol_voted = true;
+        socket->symbol_votes[value]++;
+    }
+}
+
+/**
+ * Decodes a single analysis window and executes the state machine step,
+ * updating relevant packet buffers.
+ *
+ * @param socket The socket to update.
+ * @param window The analysis window to decode, as emitted by the socket's reframer.
+ * @param position The stream position of the window's first sample.
+ */
+static void handle_window(audio_physical_layer_socket_t* socket, const float* window, uint64_t position) {
+    /* Band-limit and decimate the window, the detector only needs the channels' band. */
+    const float* detector_input = window;
+    if (socket->decimator != NULL) {
+        DECIMATOR__process(socket->decimator, window, socket->detector_window_size, socket->detector_window);
+        detector_input = socket->detector_window;
+    }
+
+    /* Try to decoded the audio window. */
+    uint64_t value;
+    int ret = decode_recording(socket, detector_input, socket->detector_window_size, &value);
+    if (ret != 0) {
+        socket->feedback_windows = 0;
+        return;
+    }
+
+    /* A feedback signal between frames is reported once it's been detected in enough consecutive windows. */
+    enum symbol_kind kind = classify_symbol(socket, value);
+    if ((kind == SYMBOL_ACK || kind == SYMBOL_NACK) && socket->state == STATE_PREAMBLE) {
+        enum physical_layer_feedback feedback = (kind == SYMBOL_ACK) ?
+                PHYSICAL_LAYER_FEEDBACK_ACK : PHYSICAL_LAYER_FEEDBACK_NACK;
+        /* Nothing is recorded while transmitting (half duplex), so a transmission separates two feedback signals. */
+        uint64_t sent_nanoseconds = atomic_load_explicit(&socket->last_sent_nanoseconds, memory_order_acquire);
+        if (socket->feedback_windows == 0 || feedback != socket->feedback_candidate ||
+                sent_nanoseconds != socket->feedback_candidate_sent_nanoseconds) {
+            socket->feedback_candidate = feedback;
+            socket->feedback_candidate_sent_nanoseconds = sent_nanoseconds;
+            socket->feedback_windows = 0;
+        }
+
+        socket->feedback_windows++;
+        if (socket->feedback_windows == FEEDBACK_MIN_WINDOWS) {
+            LOG_DEBUG("Feedback %s", (feedback == PHYSICAL_LAYER_FEEDBACK_ACK) ? "ACK" : "NACK");
+            publish_feedback(socket, feedback);
+        }
+        return;
+    }
+    socket->feedback_windows = 0;
+
+    /* The timed framing delimits bytes by the window's position instead of separators. */
+    if (socket->framing == PHYSICAL_LAYER_FRAMING_TIMED) {
+        handle_timed_symbol(socket, value, kind, position + socket->window_center_offset);
+        return;
+    }
+
+    /* Depending on the value decoded and the current state machine status, make a step and updates. */
+    switch (kind) {
+        /* These values signify data, updates the votes (only in WORD state). */
+        case SYMBOL_DATA:
+            if (socket->state == STATE_WORD) {
+                /* Update the votes, and flag that the current symbol has been voted at least once. */
+                socket->is_symbol_voted = true;
+                socket->symbol_votes[value]++;
+            }
+            break;
+
+        /* Feedback signals are only expected between frames (handled above). */
+        case SYMBOL_ACK:
+        case SYMBOL_NACK:
+            break;
+
+        /* Handle a preamble signal depending on the current state. */
+        case SYMBOL_PREAMBLE:
+            if (socket->state == STATE_PREAMBLE) {
+                LOG_DEBUG("Preamble");
+                struct packet_buffer* buffer = get_write_frame(socket);
+                if (buffer == NULL) {
+                    /* The frame ring is full and there's nowhere to receive into, start discarding. */
+                    LOG_DEBUG("Preamble with full frame ring -> discarding");
+                    atomic_fetch_add_explicit(&socket->frame_ring_overflows, 1, memory_order_relaxed);
+                    socket->state = STATE_DISCARDING;
+                } else {
+                    /* Starting new buffer, expect data. */
+                    socket->state = STATE_WORD;
+                    start_frame(socket, buffer);
+                }
+            }
+            break;
+
+        /* Handle a seperator signal depending on the current state. */
+        case SYMBOL_SEP:
+            if (socket->state == STATE_WORD && socket->is_symbol_voted) {
+                /* We finished a symbol vote.
+                 * The write frame was reserved on the preamble, and only the decode worker may fill the ring. */
+                struct packet_buffer* buffer = get_write_frame(socket);
+
+                /* Register the vote winner, advancing the buffer size index, unless the frame is too long. */
+                if (register_symbol_vote(socket, buffer) != 0) {
+                    socket->state = STATE_DISCARDING;
+                }
+
+                /* Clear the votes. */
+                clear_symbol_votes(socket);
+                LOG_DEBUG("Sep");
+            }
+            break;
+
+        /* Handle a post signal depending on the current state. */
+        case SYMBOL_POST:
+        case SYMBOL_POST_TRIM:
+            if (socket->state == STATE_DISCARDING || socket->state == STATE_PREAMBLE) {
+                /* Restart packet, the write frame is reset on the next preamble. */
+                socket->state = STATE_PREAMBLE;
+            } else {
+                LOG_DEBUG("Post");
+
+                /* Finalize the packet buffer and publish it to the reader. */
+                finish_frame(socket, kind == SYMBOL_POST_TRIM);
+
+                /* Clear the votes. */
+                clear_symbol_votes(socket);
+                socket->state = STATE_PREAMBLE;
+            }
+            break;
+
+        case SYMBOL_UNKNOWN:
+        default:
+            LOG_WARNING("Unknown signal %llu", value);
+            break;
+    }
+}
+
+/**
+ * Gets the current monotonic time.
+ *
+ * @return The monotonic time in nanoseconds.
+ */
+static uint64_t monotonic_nanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * Raises an atomic counter to the given value if it's currently lower.
+ *
+ * @param counter The counter to raise.
+ * @param value The value to raise it to.
+ */
+static void atomic_store_max(atomic_uint_fast64_t* counter, uint64_t value) {
+    uint_fast64_t current = atomic_load_explicit(counter, memory_order_relaxed);
+    while (current < value &&
+           !atomic_compare_exchange_weak_explicit(counter, &current, value, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/**
+ * This function will be registered as an audio listener for the audio module.
+ * It runs on the real-time audio thread so it only copies the recording into the capture ring
+ * and wakes the decode worker, it never blocks, allocates or logs.
+ * The recording may be of any size, the worker takes care of reframing it into analysis windows.
+ *
+ * @param socket The socket context for the callback.
+ * @param recorded_frame The audio frame recorded.
+ * @param size The size of the recorded frame.
+ */
+static void listen_callback(audio_physical_layer_socket_t* socket, const float* recorded_frame, size_t size) {
+    uint64_t start = monotonic_nanoseconds();
+
+    /* Copy the recording, whatever doesn't fit is counted as an overrun. */
+    size_t written = REFRAMER__write(socket->reframer, recorded_frame, size);
+    if (written < size) {
+        atomic_fetch_add_explicit(&socket->capture_overrun_samples, size - written, memory_order_relaxed);
+    }
+
+    /* Wake the decode worker. */
+    sem_post(&socket->capture_ready);
+
+    /* Update the counters proving the callback's time budget. */
+    atomic_fetch_add_explicit(&socket->capture_callbacks, 1, memory_order_relaxed);
+    atomic_store_max(&socket->capture_queue_max_depth, REFRAMER__get_fill(socket->reframer));
+    atomic_store_max(&socket->capture_callback_max_nanoseconds, monotonic_nanoseconds() - start);
+}
+
+/**
+ * Writes the samples of an analysis window not written yet (consecutive windows may overlap) into the capture tap.
+ * The tap is written by the decode worker, off the audio callback.
+ *
+ * @param socket The socket.
+ * @param window The analysis window.
+ * @param position The stream index of the window's first sample.
+ */
+static void write_capture_tap(audio_physical_layer_socket_t* socket, const float* window, uint64_t position) {
+    uint64_t window_end = position + REFRAMER__get_window_size(socket->reframer);
+    if (socket->capture_tap == NULL || window_end <= socket->capture_tap_position) {
+        return;
+    }
+
+    size_t offset = (socket->capture_tap_position > position) ? socket->capture_tap_position - position : 0;
+    if (WAV_WRITER__write(socket->capture_tap, window + offset, window_end - position - offset) != 0) {
+        LOG_ERROR("Failed to write capture tap, stopping tap");
+        WAV_WRITER__free(socket->capture_tap);
+        socket->capture_tap = NULL;
+        return;
+    }
+    socket->capture_tap_position = window_end;
+}
+
+/**
+ * This function will be registered as the audio idle callback, for a lock-step medium.
+ * The socket is idle once the decode worker has decoded every complete window, and the reader is either waiting for
+ * a playback or for a frame (or feedback) that hasn't arrived yet.
+ *
+ * @param socket The socket context for the callback.
+ * @return Whether the socket is idle.
+ */
+static bool idle_callback(audio_physical_layer_socket_t* socket) {
+    if (!atomic_load(&socket->is_decode_idle) ||
+            REFRAMER__get_fill(socket->reframer) >= REFRAMER__get_window_size(socket->reframer)) {
+        return false;
+    }
+
+    if (AUDIO__is_waiting_playback(socket->audio)) {
+        return true;
+    }
+
+    pthread_mutex_lock(&socket->packet_ready_lock);
+    bool is_idle = false;
+    switch (socket->reader_wait) {
+        case READER_WAIT_FRAME:
+            is_idle = get_read_frame(socket) == NULL;
+            break;
+        case READER_WAIT_FEEDBACK:
+            is_idle = get_read_frame(socket) == NULL &&
+                      !is_feedback_pending(socket, atomic_load_explicit(&socket->feedback_event, memory_order_acquire));
+            break;
+        default:
+            break;
+    }
+    pthread_mutex_unlock(&socket->packet_ready_lock);
+
+    return is_idle;
+}
+
+/**
+ * The decode worker thread.
+ * Waits for the capture callback to signal new recordings and decodes every complete analysis window.
+ *
+ * @param context The physical layer socket.
+ * @return Always NULL.
+ */
+static void* decode_thread_main(void* context) {
+    audio_physical_layer_socket_t* socket = context;
+
+    while (atomic_load(&socket->is_decode_running)) {
+        /* Sleep until there's a new recording (or we are asked to exit). */
+        atomic_store(&socket->is_decode_idle, true);
+        if (sem_wait(&socket->capture_ready) != 0) {
+            continue;
+        }
+        atomic_store(&socket->is_decode_idle, false);
+
+        /* Drain every window collected so far. */
+        uint64_t position;
+        while (REFRAMER__read_window(socket->reframer, socket->analysis_window, &position)) {
+            write_capture_tap(socket, socket->analysis_window, position);
+            handle_window(socket, socket->analysis_window, position);
+            atomic_fetch_add_explicit(&socket->windows_decoded, 1, memory_order_relaxed);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Gets the top band edge of the channel plan's channels.
+ *
+ * @param plan The channel plan.
+ * @return The top band edge frequency.
+ */
+static double get_top_frequency(const struct physical_layer_channel_plan* plan) {
+    return plan->base_frequency + (double)plan->channels_count * plan->band_width;
+}
+
+/**
+ * Chooses the decimation factor for the channel plan.
+ * Everything above the top channel's band edge is irrelevant to decoding, so we decimate as far as
+ * the guard ratio allows, while keeping the factor a divisor of the window so the frequency resolution is unchanged.
+ *
+ * @param plan The channel plan.
+ * @return The decimation factor.
+ */
+static uint32_t choose_decimation_factor(const struct physical_layer_channel_plan* plan) {
+    double top_frequency = get_top_frequency(plan);
+    uint32_t factor = (uint32_t)(SAMPLE_RATE_48000 / (2 * top_frequency * DECIMATION_GUARD_RATIO));
+    while (factor > 1 && ANALYSIS_WINDOW_SIZE % factor != 0) {
+        factor--;
+    }
+
+    return max(factor, 1);
+}
+
+/**
+ * Gets the window size and sample rate the detector analyzes at with the given configuration.
+ *
+ * @param config The socket configuration.
+ * @param window_size Returns the amount of samples the detector analyzes per window.
+ * @param sample_rate Returns the sample rate the detector analyzes at.
+ */
+static void get_detector_format(const struct physical_layer_config* config, uint32_t* window_size, float* sample_rate) {
+    uint32_t factor = config->decimate ? choose_decimation_factor(&config->channel_plan) : 1;
+    *window_size = ANALYSIS_WINDOW_SIZE / factor;
+    *sample_rate = (float)SAMPLE_RATE_48000 / factor;
+}
+
+/**
+ * Allocates an analysis window buffer, aligned so the detectors may use it directly.
+ *
+ * @param samples_count The amount of samples in the window.
+ * @return The allocated buffer, or NULL on failure.
+ */
+static float* allocate_analysis_window(size_t samples_count) {
+    /* The size must be a whole number of alignment units. */
+    size_t size = samples_count * sizeof(float);
+    size = ((size + ANALYSIS_WINDOW_ALIGNMENT - 1) / ANALYSIS_WINDOW_ALIGNMENT) * ANALYSIS_WINDOW_ALIGNMENT;
+    return aligned_alloc(ANALYSIS_WINDOW_ALIGNMENT, size);
+}
+
+/**
+ * Initializes the decimator front end and the analysis window buffers of the socket.
+ *
+ * @param socket The socket, with it's detector format already set.
+ * @param config The socket configuration.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int initialize_analysis(audio_physical_layer_socket_t* socket, const struct physical_layer_config* config) {
+    size_t window_size = ANALYSIS_WINDOW_SIZE;
+
+    /* A channel plan reaching close to the Nyquist frequency leaves nothing to decimate. */
+    uint32_t factor = ANALYSIS_WINDOW_SIZE / socket->detector_window_size;
+    if (factor > 1) {
+        /* Aliases only matter when they fold into the channels' band,
+         * so the transition band spans from the top band edge to it's alias. */
+        double top_frequency = get_top_frequency(&config->channel_plan);
+        double transition_width = (socket->detector_sample_rate - 2 * top_frequency) / SAMPLE_RATE_48000;
+        socket->decimator = DECIMATOR__initialize(factor, (float)transition_width);
+        if (socket->decimator == NULL) {
+            LOG_ERROR("Failed to initialize decimator");
+            return -1;
+        }
+
+        socket->detector_window = allocate_analysis_window(socket->detector_window_size);
+        if (socket->detector_window == NULL) {
+            LOG_ERROR("Failed to allocate detector window");
+            return -1;
+        }
+
+        /* Each window carries the filter's history ahead of the decimated samples. */
+        window_size += DECIMATOR__get_history_size(socket->decimator);
+    }
+
+    /* The filter delays each decimated sample by half the history, so the analyzed samples are centered after it. */
+    socket->window_center_offset = (window_size - ANALYSIS_WINDOW_SIZE) / 2 + ANALYSIS_WINDOW_SIZE / 2;
+
+    /* Initialize the capture reframer and its window buffer. */
+    socket->reframer = REFRAMER__initialize(window_size, config->analysis_hop_size, CAPTURE_RING_CAPACITY);
+    if (socket->reframer == NULL) {
+        LOG_ERROR("Failed to initialize reframer");
+        return -1;
+    }
+
+    socket->analysis_window = allocate_analysis_window(window_size);
+    if (socket->analysis_window == NULL) {
+        LOG_ERROR("Failed to allocate analysis window");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Initializes the packet ready event of the socket,
+ * the condition waits on the monotonic clock so timeouts aren't affected by wall clock changes.
+ *
+ * @param socket The socket.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int initialize_packet_ready_event(audio_physical_layer_socket_t* socket) {
+    pthread_condattr_t attributes;
+    if (pthread_condattr_init(&attributes) != 0) {
+        return -1;
+    }
+
+    int ret = -1;
+    if (pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC) != 0) {
+        goto l_cleanup;
+    }
+
+    if (pthread_cond_init(&socket->packet_ready, &attributes) != 0) {
+        goto l_cleanup;
+    }
+
+    if (pthread_mutex_init(&socket->packet_ready_lock, NULL) != 0) {
+        pthread_cond_destroy(&socket->packet_ready);
+        goto l_cleanup;
+    }
+
+    ret = 0;
+l_cleanup:
+    pthread_condattr_destroy(&attributes);
+    return ret;
+}
+
+/**
+ * Initializes the configured detector of the socket.
+ *
+ * @param socket The socket, with it's `detector` and channel plan already set.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int initialize_detector(audio_physical_layer_socket_t* socket) {
+    switch (socket->detector) {
+        case PHYSICAL_LAYER_DETECTOR_FFT:
+            socket->fft = FFT__initialize(socket->detector_window_size, socket->detector_sample_rate,
+                                          socket->fft_wisdom_path);
+            if (socket->fft == NULL) {
+                LOG_ERROR("Failed to initialize fft");
+                return -1;
+            }
+            return 0;
+
+        case PHYSICAL_LAYER_DETECTOR_GOERTZEL: {
+            /* The bank only needs to listen to the channel carriers. */
+            float carriers[CHANNEL_TUPLES_MAX_CHANNELS];
+            for (unsigned int channel = 0; channel < socket->channels_count; ++channel) {
+                carriers[channel] = (float)AUDIO_ENCODING__get_channel_frequency(socket->encoding, channel);
+            }
+
+            socket->goertzel = GOERTZEL__initialize(socket->detector_window_size, socket->detector_sample_rate,
+                                                    socket->channels_count, carriers);
+            if (socket->goertzel == NULL) {
+                LOG_ERROR("Failed to initialize goertzel filter bank");
+                return -1;
+            }
+            return 0;
+        }
+    }
+
+    LOG_ERROR("Unknown detector %d", socket->detector);
+    return -1;
+}
+
+/**
+ * Initializes the channel plan's encoding of the socket,
+ * and chooses how many bits the data symbols carry by the amount of values the plan has.
+ *
+ * @param socket The socket.
+ * @param plan The channel plan.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int initialize_channel_plan(audio_physical_layer_socket_t* socket, const struct physical_layer_channel_plan* plan) {
+    socket->encoding = AUDIO_ENCODING__initialize(plan->base_frequency, plan->band_width,
+                                                  plan->channels_count, plan->concurrent_channels_count);
+    if (socket->encoding == NULL) {
+        LOG_ERROR("Failed to initialize audio encoding");
+        return -1;
+    }
+
+    /* Data symbols carry as many bits as the values left for the signals allow,
+     * symbols of more than a byte also need the post signal of trimmed frames. */
+    uint64_t values_count = AUDIO_ENCODING__get_values_count(socket->encoding);
+    if (values_count < ((uint64_t)1 << MIN_SYMBOL_BITS) + SIGNALS_SPAN) {
+        LOG_ERROR("The channel plan has only %" PRIu64 " symbol values, at least %d are needed",
+                  values_count, (1 << MIN_SYMBOL_BITS) + SIGNALS_SPAN);
+        return -1;
+    }
+
+    socket->symbol_bits = MIN_SYMBOL_BITS;
+    while (socket->symbol_bits < PHYSICAL_LAYER_MAX_SYMBOL_BITS &&
+           ((uint64_t)1 << (socket->symbol_bits + 1)) + SIGNALS_SPAN_WITH_TRIM <= values_count) {
+        socket->symbol_bits++;
+    }
+    socket->data_values_count = 1U << socket->symbol_bits;
+    socket->signal_max = socket->data_values_count - 1 +
+            ((socket->symbol_bits > MIN_SYMBOL_BITS) ? SIGNALS_SPAN_WITH_TRIM : SIGNALS_SPAN);
+    socket->channels_count = plan->channels_count;
+    LOG_DEBUG("Channel plan of %u out of %u channels, %u bits per symbol",
+              plan->concurrent_channels_count, plan->channels_count, socket->symbol_bits);
+
+    /* Allocate the symbol votes. */
+    socket->symbol_votes = calloc(socket->data_values_count, sizeof(int));
+    if (socket->symbol_votes == NULL) {
+        LOG_ERROR("Failed to allocate symbol votes");
+        return -1;
+    }
+
+    return 0;
+}
+
+void PHYSICAL_LAYER__get_default_config(struct physical_layer_config* config) {
+    config->channel_plan.base_frequency = PHYSICAL_LAYER_DEFAULT_BASE_FREQUENCY;
+    config->channel_plan.band_width = PHYSICAL_LAYER_DEFAULT_BAND_WIDTH;
+    config->channel_plan.channels_count = PHYSICAL_LAYER_DEFAULT_CHANNELS_COUNT;
+    config->channel_plan.concurrent_channels_count = PHYSICAL_LAYER_DEFAULT_CONCURRENT_CHANNELS_COUNT;
+    config->channel_plan.symbol_length_milliseconds = PHYSICAL_LAYER_DEFAULT_SYMBOL_LENGTH_MILLISECONDS;
+    config->detector = PHYSICAL_LAYER_DETECTOR_FFT;
+    config->analysis_hop_size = ANALYSIS_HOP_SIZE;
+    config->framing = PHYSICAL_LAYER_FRAMING_SEPARATED;
+    config->decimate = true;
+    config->frame_ring_capacity = PHYSICAL_LAYER_DEFAULT_FRAME_RING_CAPACITY;
+    config->fft_wisdom_path = PHYSICAL_LAYER_DEFAULT_FFT_WISDOM_PATH;
+    config->audio_medium = NULL;
+    config->audio_wav = NULL;
+    config->capture_tap_path = NULL;
+}
 
-    /* Get the frequencies in from the recording. */
-    ret = FFT__calculate(fft, recorded_frame, size, &frequencies, &count_frequencies);
-    if (ret != 0) {
-        LOG_ERROR("Failed to calculate fft on provided sound frame");
+int PHYSICAL_LAYER__warm_cache(const struct physical_layer_config* config) {
+    /* Use the default configuration if none is given. */
+    struct physical_layer_config default_config;
+    if (config == NULL) {
+        PHYSICAL_LAYER__get_default_config(&default_config);
+        config = &default_config;
+    }
+
+    if (config->fft_wisdom_path == NULL) {
+        LOG_ERROR("No FFTW wisdom cache file configured");
         return -1;
     }
 
-    /* Decode the recording. */
-    ret = AUDIO_ENCODING__decode_frequencies(value_out, count_frequencies, frequencies);
-    free(frequencies);
-    if (ret == AUDIO_DECODE_RET_QUIET) {
-        LOG_VERBOSE("Quiet");
-    } else if (ret != 0) {
-        LOG_ERROR("Failed to decode frequencies");
+    /* Measure the detector window FFT into the wisdom cache. */
+    uint32_t window_size;
+    float sample_rate;
+    get_detector_format(config, &window_size, &sample_rate);
+    LOG_INFO("Warming FFTW wisdom cache %s", config->fft_wisdom_path);
+    if (FFT__warm_wisdom((int)window_size, config->fft_wisdom_path) != 0) {
+        LOG_ERROR("Failed to warm FFTW wisdom cache");
+        return -1;
     }
 
-    return ret;
+    return 0;
 }
 
-
 /**
- * This function will be registered as an audio listener for the audio module.
- * For each recording given, will decoded the audio frame and execute the state machine step,
- * updating relevant packet buffers.
+ * Allocates a socket and initializes it's receive path, everything but the audio interface and the decode worker.
  *
- * @param socket The socket context for the callback.
- * @param recorded_frame The audio frame recorded.
- * @param size The size of the recorded frame.
+ * @param config The socket configuration.
+ * @return The allocated socket, or NULL on failure.
  */
-static void listen_callback(audio_physical_layer_socket_t* socket, const float* recorded_frame, size_t size) {
-    /* Try to decoded the audio frame. */
-    uint64_t value;
-    int ret = decode_recording(socket->fft, recorded_frame, size, &value);
-    if (ret != 0) {
-        return;
+static audio_physical_layer_socket_t* allocate_socket(const struct physical_layer_config* config) {
+    /* Validate the configuration. */
+    if (config->frame_ring_capacity == 0) {
+        LOG_ERROR("Invalid frame ring capacity");
+        return NULL;
+    }
+    if (config->framing == PHYSICAL_LAYER_FRAMING_TIMED && config->analysis_hop_size > PHYSICAL_LAYER_TIMED_FRAMING_MAX_HOP_SIZE) {
+        LOG_ERROR("The timed framing requires an analysis hop of at most %d samples (got %u)",
+                  PHYSICAL_LAYER_TIMED_FRAMING_MAX_HOP_SIZE, config->analysis_hop_size);
+        return NULL;
+    }
+    uint64_t symbol_length_samples = (uint64_t)config->channel_plan.symbol_length_milliseconds * SAMPLE_RATE_48000 / 1000;
+    if (symbol_length_samples < ANALYSIS_WINDOW_SIZE) {
+        LOG_ERROR("A symbol must be at least as long as the analysis window (got %ums)",
+                  config->channel_plan.symbol_length_milliseconds);
+        return NULL;
+    }
+    if (get_top_frequency(&config->channel_plan) >= SAMPLE_RATE_48000 / 2) {
+        LOG_ERROR("The channel plan's band must end below the Nyquist frequency (got %.0fHz)",
+                  get_top_frequency(&config->channel_plan));
+        return NULL;
     }
 
-    /* Depending on the value decoded and the current state machine status, make a step and updates. */
-    switch (value) {
-        /* These values signify data, updates the votes (only in WORD state). */
-        case 0 ... 255:
-            if (socket->state == STATE_WORD) {
-                /* Update the votes, and flag that the current byte has been voted at least once. */
-                socket->is_byte_voted = true;
-                socket->byte_votes[value]++;
-            }
-            break;
+    /* Allocate a socket struct. */
+    audio_physical_layer_socket_t* socket = malloc(sizeof(audio_physical_layer_socket_t));
+    if (socket == NULL) {
+        LOG_ERROR("Failed to initialize Audio Socket");
+        return NULL;
+    }
 
-        /* Handle a preamble signal depending on the current state. */
-        case SIGNAL_PREAMBLE ... SIGNAL_SEP-1:
-            if (socket->state == STATE_PREAMBLE) {
-                LOG_DEBUG("Preamble");
-                if (socket->packet_buffers[socket->packet_write_index].is_ready) {
-                    /* The current buffer is ready and wasn't finished properly, start discarding. */
-                    LOG_DEBUG("Preamble with full buffer -> discarding");
-                    socket->state = STATE_DISCARDING;
-                } else {
-                    /* Starting new buffer, expect data. */
-                    socket->state = STATE_WORD;
-                    socket->packet_buffers[socket->packet_write_index].packet_size = 0;
-                }
-            }
-            break;
+    /* Initialize socket fields. */
+    socket->framing = config->framing;
+    socket->window_center_offset = ANALYSIS_WINDOW_SIZE / 2;
+    socket->state = STATE_PREAMBLE;
+    socket->preamble_last_center = 0;
+    socket->sync_data_center = 0;
+    socket->sync_data_windows = 0;
+    socket->frame_start = 0;
+    socket->symbol_index = 0;
+    socket->symbol_votes = NULL;
+    socket->feedback_guard.samples = NULL;
+    socket->feedback_guard.samples_count = 0;
+    socket->is_symbol_voted = false;
+    socket->pending_bits = 0;
+    socket->pending_erased_bits = 0;
+    socket->pending_bits_count = 0;
+    socket->feedback_candidate = PHYSICAL_LAYER_FEEDBACK_ACK;
+    socket->feedback_windows = 0;
+    socket->feedback_candidate_sent_nanoseconds = 0;
+    atomic_init(&socket->feedback_event, 0);
+    socket->feedback_consumed_nanoseconds = 0;
+    atomic_init(&socket->last_sent_nanoseconds, 0);
+    socket->frame_ring = NULL;
+    socket->ready_fd = -1;
+    socket->frame_ring_capacity = config->frame_ring_capacity;
+    atomic_init(&socket->frame_ring_write_position, 0);
+    atomic_init(&socket->frame_ring_read_position, 0);
+    socket->recv_timeout_milliseconds = RECV_TIMEOUT_MILLISECONDS;
+    socket->audio = NULL;
+    socket->symbol_cache = NULL;
+    socket->encoding = NULL;
+    socket->symbol_length_milliseconds = config->channel_plan.symbol_length_milliseconds;
+    socket->symbol_length_samples = symbol_length_samples;
+    socket->preamble_length_samples = symbol_length_samples * PREAMBLE_SYMBOL_LENGTHS;
+    socket->detector = config->detector;
+    socket->fft_wisdom_path = config->fft_wisdom_path;
+    socket->fft = NULL;
+    socket->goertzel = NULL;
+    socket->reframer = NULL;
+    socket->analysis_window = NULL;
+    socket->decimator = NULL;
+    socket->detector_window = NULL;
+    get_detector_format(config, &socket->detector_window_size, &socket->detector_sample_rate);
+    socket->is_decode_thread_started = false;
+    atomic_init(&socket->is_decode_running, true);
+    atomic_init(&socket->is_decode_idle, true);
+    socket->reader_wait = READER_WAIT_NONE;
+    socket->capture_tap = NULL;
+    socket->capture_tap_position = 0;
+    atomic_init(&socket->capture_callbacks, 0);
+    atomic_init(&socket->capture_overrun_samples, 0);
+    atomic_init(&socket->capture_queue_max_depth, 0);
+    atomic_init(&socket->capture_callback_max_nanoseconds, 0);
+    atomic_init(&socket->windows_decoded, 0);
+    atomic_init(&socket->frame_ring_overflows, 0);
+    atomic_init(&socket->frame_ring_max_depth, 0);
+    atomic_init(&socket->symbols_received, 0);
+    atomic_init(&socket->symbols_erased, 0);
+
+    /* Initialize the semaphore waking the decode worker. */
+    if (sem_init(&socket->capture_ready, 0, 0) != 0) {
+        LOG_ERROR("Failed to initialize capture semaphore");
+        free(socket);
+        return NULL;
+    }
 
-        /* Handle a seperator signal depending on the current state. */
-        case SIGNAL_SEP ... SIGNAL_POST - 1:
-            if (socket->state == STATE_WORD && socket->is_byte_voted) {
-                /* We finished a byte vote. */
-                socket->is_byte_voted = false;
-                struct packet_buffer* buffer = &socket->packet_buffers[socket->packet_write_index];
-
-                /* Validate the packet size. */
-                if (buffer->packet_size >= PHYSICAL_LAYER_MTU) {
-                    socket->state = STATE_DISCARDING;
-                } else {
-                    /* Register the vote winner, and advance the buffer size index. */
-                    buffer->buffer[buffer->packet_size] = find_max_index(256, socket->byte_votes);
-                    LOG_DEBUG("data: %hhu (%c)", buffer->buffer[buffer->packet_size], buffer->buffer[buffer->packet_size]);
-                    buffer->packet_size++;
-                }
+    /* Initialize the event waking the readers. */
+    if (initialize_packet_ready_event(socket) != 0) {
+        LOG_ERROR("Failed to initialize packet ready event");
+        sem_destroy(&socket->capture_ready);
+        free(socket);
+        return NULL;
+    }
 
-                /* Clear the votes. */
-                memset(socket->byte_votes, 0, sizeof(socket->byte_votes));
-                LOG_DEBUG("Sep");
-            }
-            break;
+    /* Initialize the readiness descriptor, so sockets can be multiplexed with poll/epoll. */
+    socket->ready_fd = eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK | EFD_CLOEXEC);
+    if (socket->ready_fd < 0) {
+        LOG_ERROR("Failed to create readiness descriptor");
+        PHYSICAL_LAYER__free(socket);
+        return NULL;
+    }
 
-        /* Handle a post signal depending on the current state. */
-        case SIGNAL_POST ... SIGNAL_MAX:
-            if (socket->state == STATE_DISCARDING || socket->state == STATE_PREAMBLE) {
-                /* Restart packet */
-                if (!socket->packet_buffers[socket->packet_write_index].is_ready) {
-                    socket->packet_buffers[socket->packet_write_index].packet_size = 0;
-                }
-                socket->state = STATE_PREAMBLE;
-            } else {
-                LOG_DEBUG("Post");
+    /* Allocate the received frames ring. */
+    socket->frame_ring = calloc(socket->frame_ring_capacity, sizeof(struct packet_buffer));
+    if (socket->frame_ring == NULL) {
+        LOG_ERROR("Failed to allocate frame ring of %u frames", socket->frame_ring_capacity);
+        PHYSICAL_LAYER__free(socket);
+        return NULL;
+    }
 
-                /* Finalize the packet buffer and advance the write index. */
-                struct packet_buffer* buffer = &socket->packet_buffers[socket->packet_write_index];
-                if (buffer->packet_size > 0) {
-                    socket->packet_write_index = (socket->packet_write_index + 1) % MAX_FRAMES_COUNT;
-                    buffer->is_ready = true;
-                }
+    /* Initialize the channel plan's encoding. */
+    if (initialize_channel_plan(socket, &config->channel_plan) != 0) {
+        PHYSICAL_LAYER__free(socket);
+        return NULL;
+    }
 
-                /* Clear the votes. */
-                memset(socket->byte_votes, 0, sizeof(socket->byte_votes));
-                socket->is_byte_voted = false;
-                socket->state = STATE_PREAMBLE;
-            }
-            break;
+    /* Initialize the decimator front end, the capture reframer and the window buffers. */
+    if (initialize_analysis(socket, config) != 0) {
+        PHYSICAL_LAYER__free(socket);
+        return NULL;
+    }
 
-        default:
-            LOG_WARNING("Unknown signal %llu", value);
-            break;
+    /* Initialize the detector module. */
+    if (initialize_detector(socket) != 0) {
+        PHYSICAL_LAYER__free(socket);
+        return NULL;
     }
+
+    return socket;
 }
 
-audio_physical_layer_socket_t* PHYSICAL_LAYER__initialize() {
-    /* Allocate a socket struct. */
-    audio_physical_layer_socket_t* socket = malloc(sizeof(audio_physical_layer_socket_t));
+audio_physical_layer_socket_t* PHYSICAL_LAYER__initialize(const struct physical_layer_config* config) {
+    /* Use the default configuration if none is given. */
+    struct physical_layer_config default_config;
+    if (config == NULL) {
+        PHYSICAL_LAYER__get_default_config(&default_config);
+        config = &default_config;
+    }
+
+    /* Validate the audio configuration. */
+    if (config->audio_medium != NULL && AUDIO_MEDIUM__get_sample_rate(config->audio_medium) != SAMPLE_RATE_48000) {
+        LOG_ERROR("The simulated medium must run at %dHz", SAMPLE_RATE_48000);
+        return NULL;
+    }
+    if (config->audio_wav != NULL && (config->audio_medium != NULL || config->audio_wav->sample_rate != SAMPLE_RATE_48000)) {
+        LOG_ERROR("The WAV files must be replayed at %dHz, without a simulated medium", SAMPLE_RATE_48000);
+        return NULL;
+    }
+
+    /* Initialize the receive path. */
+    audio_physical_layer_socket_t* socket = allocate_socket(config);
     if (socket == NULL) {
-        LOG_ERROR("Failed to initialize Audio Socket");
         return NULL;
     }
 
-    /* Initialize socket fields. */
-    socket->state = STATE_PREAMBLE;
-    memset(socket->byte_votes, 0, sizeof(socket->byte_votes));
-    socket->is_byte_voted = false;
-    memset(socket->packet_buffers, 0, sizeof(socket->packet_buffers));
-    socket->packet_write_index = 0;
-    socket->packet_read_index = 0;
-    socket->recv_timeout_seconds = RECV_TIMEOUT_SECONDS;
-
-    /* Initialize the FFT module. */
-    socket->fft = FFT__initialize(SAMPLE_RATE_48000_SAMPLE_SIZE, SAMPLE_RATE_48000);
-    if (socket->fft == NULL) {
-        LOG_ERROR("Failed to initialize fft");
-        free(socket);
+    /* Initialize the transmitted symbols cache, every symbol sent by `PHYSICAL_LAYER__send` and the feedback.
+     * The signals come first so they're always pre-rendered, the data symbols are if the plan has few enough. */
+    uint32_t symbol_length = socket->symbol_length_milliseconds;
+    struct symbol_cache_range symbol_ranges[] = {
+            {get_signal_value(socket, SIGNAL_PREAMBLE), 1, symbol_length * PREAMBLE_SYMBOL_LENGTHS},
+            {get_signal_value(socket, SIGNAL_SEP), 1, symbol_length * SEP_SYMBOL_LENGTHS},
+            {get_signal_value(socket, SIGNAL_POST), 1, symbol_length * POST_SYMBOL_LENGTHS},
+            {get_signal_value(socket, SIGNAL_ACK), 1, symbol_length * FEEDBACK_SYMBOL_LENGTHS},
+            {get_signal_value(socket, SIGNAL_NACK), 1, symbol_length * FEEDBACK_SYMBOL_LENGTHS},
+            {0, socket->data_values_count, symbol_length},
+            {get_signal_value(socket, SIGNAL_POST_TRIM), 1, symbol_length * POST_SYMBOL_LENGTHS}
+    };
+    size_t symbol_ranges_count = sizeof(symbol_ranges) / sizeof(symbol_ranges[0]);
+    if (socket->symbol_bits == MIN_SYMBOL_BITS) {
+        /* Byte symbols are never trimmed, the trimmed post signal isn't part of the plan. */
+        symbol_ranges_count--;
+    }
+
+    /* Data symbols rendered on send stay queued until their frame is played, with up to a full playback queue
+     * of frames queued before it. */
+    size_t frame_symbols_count = (PHYSICAL_LAYER_MTU * 8 + socket->symbol_bits - 1) / socket->symbol_bits;
+    socket->symbol_cache = SYMBOL_CACHE__initialize(socket->encoding, SAMPLE_RATE_48000,
+                                                    symbol_ranges, symbol_ranges_count,
+                                                    (AUDIO_PLAYBACK_QUEUE_CAPACITY + 1) * frame_symbols_count);
+    if (socket->symbol_cache == NULL) {
+        LOG_ERROR("Failed to initialize symbol cache");
+        PHYSICAL_LAYER__free(socket);
+        return NULL;
+    }
+
+    /* Allocate the silence before the feedback symbols. */
+    socket->feedback_guard.samples_count =
+            SAMPLE_RATE_48000 / 1000 * socket->symbol_length_milliseconds * FEEDBACK_GUARD_SYMBOL_LENGTHS;
+    socket->feedback_guard.samples = calloc(socket->feedback_guard.samples_count, sizeof(float));
+    if (socket->feedback_guard.samples == NULL) {
+        LOG_ERROR("Failed to allocate feedback guard of %u samples", socket->feedback_guard.samples_count);
+        PHYSICAL_LAYER__free(socket);
         return NULL;
     }
 
-    /* Initialize Audio module. */
-    socket->audio = AUDIO__initialize(SAMPLE_RATE_48000, false);
+    /* Initialize Audio module, over the simulated medium or the WAV files if given. */
+    if (config->audio_medium != NULL) {
+        socket->audio = AUDIO__initialize_simulated(config->audio_medium, false);
+    } else if (config->audio_wav != NULL) {
+        socket->audio = AUDIO__initialize_wav(config->audio_wav, false);
+    } else {
+        socket->audio = AUDIO__initialize(SAMPLE_RATE_48000, false);
+    }
     if (socket->audio == NULL) {
         LOG_ERROR("Failed to initialize audio");
-        FFT__free(socket->fft);
-        free(socket);
+        PHYSICAL_LAYER__free(socket);
+        return NULL;
+    }
+
+    /* Tap the capture before the first recorded sample. */
+    if (config->capture_tap_path != NULL) {
+        socket->capture_tap = WAV_WRITER__initialize(config->capture_tap_path, SAMPLE_RATE_48000);
+        if (socket->capture_tap == NULL) {
+            LOG_ERROR("Failed to create capture tap");
+            PHYSICAL_LAYER__free(socket);
+            return NULL;
+        }
+    }
+
+    /* Start the decode worker before any recording arrives. */
+    if (pthread_create(&socket->decode_thread, NULL, decode_thread_main, socket) != 0) {
+        LOG_ERROR("Failed to start decode thread");
+        PHYSICAL_LAYER__free(socket);
         return NULL;
     }
+    socket->is_decode_thread_started = true;
 
     /* Set the listening callback and start listening. */
     LOG_DEBUG("Starting Audio");
     AUDIO__set_recording_callback(socket->audio, (recording_callback_t) listen_callback, socket);
+    AUDIO__set_idle_callback(socket->audio, (idle_callback_t) idle_callback, socket);
     int status = AUDIO__start(socket->audio);
     if (status != 0) {
         LOG_ERROR("Failed to start audio");
@@ -284,6 +1631,40 @@ audio_physical_layer_socket_t* PHYSICAL_LAYER__initialize() {
     return socket;
 }
 
+audio_physical_layer_socket_t* PHYSICAL_LAYER__initialize_decoder(const struct physical_layer_config* config) {
+    /* Use the default configuration if none is given. */
+    struct physical_layer_config default_config;
+    if (config == NULL) {
+        PHYSICAL_LAYER__get_default_config(&default_config);
+        config = &default_config;
+    }
+
+    /* The decoder has only the receive path, the recordings are passed by the user. */
+    return allocate_socket(config);
+}
+
+int PHYSICAL_LAYER__decode(audio_physical_layer_socket_t* socket, const float* samples, size_t samples_count) {
+    /* Validate parameters. */
+    if (samples == NULL || socket->audio != NULL) {
+        LOG_ERROR("Invalid parameters");
+        return -1;
+    }
+
+    /* Reframe the recording a capture ring at a time, decoding every window, so nothing is dropped. */
+    size_t decoded = 0;
+    while (decoded < samples_count) {
+        decoded += REFRAMER__write(socket->reframer, samples + decoded, samples_count - decoded);
+
+        uint64_t position;
+        while (REFRAMER__read_window(socket->reframer, socket->analysis_window, &position)) {
+            handle_window(socket, socket->analysis_window, position);
+            atomic_fetch_add_explicit(&socket->windows_decoded, 1, memory_order_relaxed);
+        }
+    }
+
+    return 0;
+}
+
 void PHYSICAL_LAYER__free(audio_physical_layer_socket_t* socket) {
     /* Stop and free the audio module. */
     if (socket->audio != NULL) {
@@ -292,40 +1673,118 @@ void PHYSICAL_LAYER__free(audio_physical_layer_socket_t* socket) {
         socket->audio = NULL;
     }
 
+    /* With the recordings stopped, wake the decode worker and wait for it to exit. */
+    if (socket->is_decode_thread_started) {
+        atomic_store(&socket->is_decode_running, false);
+        sem_post(&socket->capture_ready);
+        pthread_join(socket->decode_thread, NULL);
+        socket->is_decode_thread_started = false;
+    }
+
+    /* Complete the capture tap, with the decode worker gone. */
+    WAV_WRITER__free(socket->capture_tap);
+    socket->capture_tap = NULL;
+
+    /* Free the transmitted symbols cache. */
+    if (socket->symbol_cache != NULL) {
+        SYMBOL_CACHE__free(socket->symbol_cache);
+        socket->symbol_cache = NULL;
+    }
+    free((float*)socket->feedback_guard.samples);
+    socket->feedback_guard.samples = NULL;
+
+    /* Free the channel plan's encoding and votes. */
+    if (socket->encoding != NULL) {
+        AUDIO_ENCODING__free(socket->encoding);
+        socket->encoding = NULL;
+    }
+
+    free(socket->symbol_votes);
+    socket->symbol_votes = NULL;
+
     /* Free the FFT module. */
     if (socket->fft != NULL) {
         FFT__free(socket->fft);
         socket->fft = NULL;
     }
 
+    /* Free the Goertzel filter bank. */
+    if (socket->goertzel != NULL) {
+        GOERTZEL__free(socket->goertzel);
+        socket->goertzel = NULL;
+    }
+
+    /* Free the capture reframer. */
+    if (socket->reframer != NULL) {
+        REFRAMER__free(socket->reframer);
+        socket->reframer = NULL;
+    }
+
+    if (socket->analysis_window != NULL) {
+        free(socket->analysis_window);
+        socket->analysis_window = NULL;
+    }
+
+    /* Free the decimator front end. */
+    if (socket->decimator != NULL) {
+        DECIMATOR__free(socket->decimator);
+        socket->decimator = NULL;
+    }
+
+    if (socket->detector_window != NULL) {
+        free(socket->detector_window);
+        socket->detector_window = NULL;
+    }
+
+    /* Free the received frames ring. */
+    free(socket->frame_ring);
+    socket->frame_ring = NULL;
+
+    /* Close the readiness descriptor. */
+    if (socket->ready_fd >= 0) {
+        close(socket->ready_fd);
+        socket->ready_fd = -1;
+    }
+
     /* Free the socket struct. */
+    pthread_cond_destroy(&socket->packet_ready);
+    pthread_mutex_destroy(&socket->packet_ready_lock);
+    sem_destroy(&socket->capture_ready);
     free(socket);
 }
 
 /**
- * Sets a sound to the encoded frequencies of a given integer value.
+ * Gets the value of a data symbol of a frame, the frame's bits are split into symbols most significant first.
  *
- * @param sound The sound to set.
- * @param length_milliseconds The sound length to set.
- * @param number_of_frequencies The number of frequencies in the sound.
- * @param value The integer value to set.
- * @return 0 On Success, -1 On Failure.
+ * @param frame The frame.
+ * @param size The size of the frame.
+ * @param symbol_bits The amount of bits each symbol carries.
+ * @param symbol_index The index of the symbol in the frame, bits past the frame's end are zeros.
+ * @return The symbol's value.
  */
-static int set_sound_by_value(struct sound_s* sound, uint32_t length_milliseconds, uint32_t number_of_frequencies, int64_t value) {
-    /* Set fields. */
-    sound->length_milliseconds = length_milliseconds;
-    sound->number_of_frequencies = number_of_frequencies;
-
-    /* Encode the integer value to sound frequencies. */
-    int status = AUDIO_ENCODING__encode_frequencies(value, number_of_frequencies, sound->frequencies);
-    if (status != 0) {
-        LOG_ERROR("Failed to encode frequencies for value %lld", value);
+static uint64_t get_frame_symbol(const uint8_t* frame, size_t size, uint32_t symbol_bits, size_t symbol_index) {
+    uint64_t value = 0;
+    for (size_t position = symbol_index * symbol_bits; position < (symbol_index + 1) * symbol_bits; ++position) {
+        uint8_t byte = (position / 8 < size) ? frame[position / 8] : 0;
+        value = (value << 1) | ((byte >> (7 - position % 8)) & 1);
     }
 
-    return status;
+    return value;
 }
 
-int PHYSICAL_LAYER__send(audio_physical_layer_socket_t* socket, void* frame, size_t size) {
+/**
+ * Sets what the reader waits for.
+ *
+ * @param socket The socket.
+ * @param reader_wait What the reader waits for.
+ */
+static void set_reader_wait(audio_physical_layer_socket_t* socket, enum reader_wait_e reader_wait) {
+    pthread_mutex_lock(&socket->packet_ready_lock);
+    socket->reader_wait = reader_wait;
+    pthread_mutex_unlock(&socket->packet_ready_lock);
+}
+
+int PHYSICAL_LAYER__send_async(audio_physical_layer_socket_t* socket, void* frame, size_t size, uint64_t* ticket) {
     int status = -1;
 
     /* Validate parameters. */
@@ -334,80 +1793,197 @@ int PHYSICAL_LAYER__send(audio_physical_layer_socket_t* socket, void* frame, siz
         return -1;
     }
 
-    /* The maximum amount of sounds we need to sound in order to send a frame,
-     * is double the MTU (1 sound for data, 1 sound for sep, for each byte) plus 2 (PRE + POST).  */
-    struct sound_s sounds_packet[2 + 2 * PHYSICAL_LAYER_MTU];
+    /* The reader is sending, so it isn't waiting for a frame. */
+    set_reader_wait(socket, READER_WAIT_NONE);
 
-    /* Set the PREAMBLE sound.
-     * We defined some tolerances for the signaling sounds, a +1 will give better results */
-    status = set_sound_by_value(&sounds_packet[0], PREAMBLE_SYMBOL_LENGTH_MILLISECONDS,
-                                NUMBER_OF_CONCURRENT_CHANNELS,SIGNAL_PREAMBLE+1);
+    /* The maximum amount of symbols we need to sound in order to send a frame,
+     * is double the MTU (1 symbol for data, 1 symbol for sep, for each byte) plus 2 (PRE + POST).  */
+    struct pcm_segment_s symbols_packet[2 + 2 * PHYSICAL_LAYER_MTU];
+
+    /* Set the PREAMBLE symbol. */
+    status = SYMBOL_CACHE__get(socket->symbol_cache, get_signal_value(socket, SIGNAL_PREAMBLE),
+                               socket->symbol_length_milliseconds * PREAMBLE_SYMBOL_LENGTHS, &symbols_packet[0]);
     if (status != 0) {
         return status;
     }
 
-    /* For each byte, set the data sound and the SEP sound.
-     * +1 for the tolerance enhancement as before. */
-    for (int frame_index = 0, packet_index = 1; frame_index < size; frame_index++, packet_index+=2) {
-        status = set_sound_by_value(&sounds_packet[packet_index], SYMBOL_LENGTH_MILLISECONDS,
-                                    NUMBER_OF_CONCURRENT_CHANNELS, ((uint8_t*)frame)[frame_index]);
+    /* The frame is sent `symbol_bits` bits per symbol, the last symbol's bits are padded with zeros.
+     * If the padding makes for an extra byte, the receiver is told to trim it by the post signal. */
+    size_t symbols_count = (size * 8 + socket->symbol_bits - 1) / socket->symbol_bits;
+    bool is_trimmed = (symbols_count * socket->symbol_bits) / 8 > size;
+
+    /* For each symbol, set the data symbol and the SEP symbol (unless timed framing, where symbols are back to back). */
+    size_t packet_index = 1;
+    for (size_t symbol_index = 0; symbol_index < symbols_count; symbol_index++) {
+        uint64_t value = get_frame_symbol(frame, size, socket->symbol_bits, symbol_index);
+        status = SYMBOL_CACHE__get(socket->symbol_cache, value, socket->symbol_length_milliseconds,
+                                   &symbols_packet[packet_index++]);
         if (status != 0) {
             return status;
         }
 
-        status = set_sound_by_value(&sounds_packet[packet_index + 1], SEP_SYMBOL_LENGTH_MILLISECONDS,
-                                    NUMBER_OF_CONCURRENT_CHANNELS, SIGNAL_SEP+1);
-        if (status != 0) {
-            return status;
+        if (socket->framing == PHYSICAL_LAYER_FRAMING_SEPARATED) {
+            status = SYMBOL_CACHE__get(socket->symbol_cache, get_signal_value(socket, SIGNAL_SEP),
+                                       socket->symbol_length_milliseconds * SEP_SYMBOL_LENGTHS,
+                                       &symbols_packet[packet_index++]);
+            if (status != 0) {
+                return status;
+            }
         }
     }
 
-    /* Set the POST sound (+1 as before). */
-    status = set_sound_by_value(&sounds_packet[1 + 2 * size], POST_SYMBOL_LENGTH_MILLISECONDS,
-                                NUMBER_OF_CONCURRENT_CHANNELS, SIGNAL_POST+1);
+    /* Set the POST symbol. */
+    status = SYMBOL_CACHE__get(socket->symbol_cache,
+                               get_signal_value(socket, is_trimmed ? SIGNAL_POST_TRIM : SIGNAL_POST),
+                               socket->symbol_length_milliseconds * POST_SYMBOL_LENGTHS,
+                               &symbols_packet[packet_index++]);
     if (status != 0) {
         return status;
     }
 
-    /* Play the sounds, effectively sending the frame. */
-    status = AUDIO__play_sounds(socket->audio, sounds_packet, 2+size*2);
+    /* Queue the pre-rendered symbols to be played, effectively sending the frame. */
+    status = AUDIO__enqueue_pcm(socket->audio, symbols_packet, packet_index, ticket);
     if (status != 0) {
-        LOG_ERROR("Failed to play sounds");
+        LOG_ERROR("Failed to queue symbols");
         return status;
     }
 
     return 0;
 }
 
-ssize_t PHYSICAL_LAYER__peek(audio_physical_layer_socket_t* socket, void* frame, size_t size, bool blocking) {
+int PHYSICAL_LAYER__wait_sent(audio_physical_layer_socket_t* socket, uint64_t ticket) {
+    int status = AUDIO__wait_playback(socket->audio, ticket);
+    if (status != 0) {
+        LOG_ERROR("Failed to play symbols");
+        return status;
+    }
+
+    /* Feedback heard until now (e.g. our own) can't be a response to what was just sent. */
+    atomic_store_explicit(&socket->last_sent_nanoseconds, monotonic_nanoseconds(), memory_order_release);
+    return 0;
+}
+
+int PHYSICAL_LAYER__send(audio_physical_layer_socket_t* socket, void* frame, size_t size) {
+    uint64_t ticket;
+    int status = PHYSICAL_LAYER__send_async(socket, frame, size, &ticket);
+    if (status != 0) {
+        return status;
+    }
+
+    return PHYSICAL_LAYER__wait_sent(socket, ticket);
+}
+
+int PHYSICAL_LAYER__send_feedback_async(audio_physical_layer_socket_t* socket, enum physical_layer_feedback feedback,
+                                        uint64_t* ticket) {
+    set_reader_wait(socket, READER_WAIT_NONE);
+
+    /* The feedback is a single symbol, after the guard silence. */
+    struct pcm_segment_s segments[2] = {socket->feedback_guard};
+    uint64_t value = get_signal_value(socket, (feedback == PHYSICAL_LAYER_FEEDBACK_ACK) ? SIGNAL_ACK : SIGNAL_NACK);
+    int status = SYMBOL_CACHE__get(socket->symbol_cache, value,
+                                   socket->symbol_length_milliseconds * FEEDBACK_SYMBOL_LENGTHS, &segments[1]);
+    if (status != 0) {
+        return status;
+    }
+
+    status = AUDIO__enqueue_pcm(socket->audio, segments, 2, ticket);
+    if (status != 0) {
+        LOG_ERROR("Failed to queue feedback symbol");
+        return status;
+    }
+
+    return 0;
+}
+
+int PHYSICAL_LAYER__send_feedback(audio_physical_layer_socket_t* socket, enum physical_layer_feedback feedback) {
+    uint64_t ticket;
+    int status = PHYSICAL_LAYER__send_feedback_async(socket, feedback, &ticket);
+    if (status != 0) {
+        return status;
+    }
+
+    return PHYSICAL_LAYER__wait_sent(socket, ticket);
+}
+
+int PHYSICAL_LAYER__recv_feedback(audio_physical_layer_socket_t* socket, enum physical_layer_feedback* feedback) {
     /* Validate parameters. */
-    if (size < PHYSICAL_LAYER_MTU || frame == NULL) {
+    if (feedback == NULL) {
         LOG_ERROR("Invalid parameters");
         return -1;
     }
 
-    /* Get the current read packet buffer, and check repeatedly (up to timeout) whether it's ready. */
-    struct packet_buffer *packet = &socket->packet_buffers[socket->packet_read_index];
-    for (int i = 0; i <= socket->recv_timeout_seconds; ++i) {
-        if (i > 0) {
-            /* Sleep a single second. */
-            sleep(1);
+    /* Wait (up to timeout) for the decode worker to signal a feedback or a frame. */
+    uint64_t deadline = monotonic_nanoseconds() + (uint64_t)socket->recv_timeout_milliseconds * 1000000ULL;
+    struct timespec deadline_time = {
+        .tv_sec = (time_t)(deadline / 1000000000ULL),
+        .tv_nsec = (long)(deadline % 1000000000ULL)
+    };
+
+    int ret = RECV_TIMEOUT_RET_CODE;
+    pthread_mutex_lock(&socket->packet_ready_lock);
+    socket->reader_wait = READER_WAIT_FEEDBACK;
+    while (true) {
+        if (consume_feedback(socket, feedback)) {
+            ret = 0;
+            break;
+        } else if (get_read_frame(socket) != NULL) {
+            ret = RECV_FRAME_PENDING_RET_CODE;
+            break;
+        } else if (pthread_cond_timedwait(&socket->packet_ready, &socket->packet_ready_lock, &deadline_time) != 0) {
+            break;
         }
+    }
+    socket->reader_wait = READER_WAIT_NONE;
+    pthread_mutex_unlock(&socket->packet_ready_lock);
 
-        /* If the buffer is ready we can return it. */
-        if (packet->is_ready) {
-            uint32_t packet_size = min(packet->packet_size, PHYSICAL_LAYER_MTU);
-            memcpy(frame, packet->buffer, packet_size);
-            return packet_size;
-        }
+    if (ret == RECV_TIMEOUT_RET_CODE) {
+        LOG_INFO("Timed out on physical layer feedback");
+    }
+    return ret;
+}
 
-        if (!blocking) {
-            /* There's no buffer and timeout is irrelevant,
-             * this isn't an error state so we return 0 just to signify there's no ready buffers.
-             * If there were, they'd have a positive size. */
-            return 0;
+ssize_t PHYSICAL_LAYER__peek(audio_physical_layer_socket_t* socket, void* frame, size_t size, bool blocking) {
+    /* Validate parameters. */
+    if (size < PHYSICAL_LAYER_MTU || frame == NULL) {
+        LOG_ERROR("Invalid parameters");
+        return -1;
+    }
+
+    /* Get the current read packet buffer. */
+    struct packet_buffer *packet = get_read_frame(socket);
+    if (packet == NULL && !blocking) {
+        /* There's no buffer and timeout is irrelevant,
+         * this isn't an error state so we return 0 just to signify there's no ready buffers.
+         * If there were, they'd have a positive size. The reader goes on to wait for the readiness descriptor. */
+        set_reader_wait(socket, READER_WAIT_FRAME);
+        return 0;
+    }
+
+    /* Wait (up to timeout) for the decode worker to signal a buffer is ready. */
+    uint64_t deadline = monotonic_nanoseconds() + (uint64_t)socket->recv_timeout_milliseconds * 1000000ULL;
+    struct timespec deadline_time = {
+        .tv_sec = (time_t)(deadline / 1000000000ULL),
+        .tv_nsec = (long)(deadline % 1000000000ULL)
+    };
+
+    /* The ring is checked again under the lock, so a frame published since the check above can't be missed. */
+    pthread_mutex_lock(&socket->packet_ready_lock);
+    socket->reader_wait = READER_WAIT_FRAME;
+    while ((packet = get_read_frame(socket)) == NULL) {
+        if (pthread_cond_timedwait(&socket->packet_ready, &socket->packet_ready_lock, &deadline_time) != 0) {
+            packet = get_read_frame(socket);
+            break;
         }
     }
+    socket->reader_wait = READER_WAIT_NONE;
+    pthread_mutex_unlock(&socket->packet_ready_lock);
+
+    /* If the buffer is ready we can return it. */
+    if (packet != NULL) {
+        uint32_t packet_size = min(packet->packet_size, PHYSICAL_LAYER_MTU);
+        memcpy(frame, packet->buffer, packet_size);
+        return packet_size;
+    }
 
     /* Timeout reached. */
     LOG_ERROR("Timed out on physical layer peek");
@@ -415,12 +1991,16 @@ ssize_t PHYSICAL_LAYER__peek(audio_physical_layer_socket_t* socket, void* frame,
 }
 
 int PHYSICAL_LAYER__pop(audio_physical_layer_socket_t* socket) {
-    /* If there's a ready read packet, set it as not ready and advance the index. */
-    struct packet_buffer *packet = &socket->packet_buffers[socket->packet_read_index];
-    if (packet->is_ready) {
-        packet->packet_size = 0;
-        packet->is_ready = false;
-        socket->packet_read_index = (socket->packet_read_index + 1) % MAX_FRAMES_COUNT;
+    /* If there's a ready read packet, release it back to the decode worker. */
+    if (get_read_frame(socket) != NULL) {
+        /* Consume the frame's count on the readiness descriptor. */
+        uint64_t frame_count;
+        if (read(socket->ready_fd, &frame_count, sizeof(frame_count)) != sizeof(frame_count)) {
+            LOG_ERROR("Failed to consume readiness descriptor");
+        }
+
+        uint64_t read_position = atomic_load_explicit(&socket->frame_ring_read_position, memory_order_relaxed);
+        atomic_store_explicit(&socket->frame_ring_read_position, read_position + 1, memory_order_release);
         return 0;
     }
 
@@ -428,6 +2008,17 @@ int PHYSICAL_LAYER__pop(audio_physical_layer_socket_t* socket) {
     return -1;
 }
 
+int PHYSICAL_LAYER__peek_erasures(audio_physical_layer_socket_t* socket, uint16_t* erasures) {
+    /* Only a ready read packet has it's erasures settled. */
+    struct packet_buffer* packet = get_read_frame(socket);
+    if (packet == NULL) {
+        return -1;
+    }
+
+    *erasures = packet->erasures;
+    return 0;
+}
+
 ssize_t PHYSICAL_LAYER__recv(audio_physical_layer_socket_t* socket, void* frame, size_t size) {
     /* Validate parameters. */
     if (size < PHYSICAL_LAYER_MTU || frame == NULL) {
@@ -448,3 +2039,42 @@ ssize_t PHYSICAL_LAYER__recv(audio_physical_layer_socket_t* socket, void* frame,
     return ret;
 }
 
+ssize_t PHYSICAL_LAYER__recv_nonblocking(audio_physical_layer_socket_t* socket, void* frame, size_t size) {
+    /* Validate parameters. */
+    if (size < PHYSICAL_LAYER_MTU || frame == NULL) {
+        LOG_ERROR("Invalid parameters");
+        return -1;
+    }
+
+    /* Peek for a packet without waiting, and receive it if there's one. */
+    ssize_t ret = PHYSICAL_LAYER__peek(socket, frame, size, false);
+    if (ret < 0) {
+        return ret;
+    } else if (ret == 0) {
+        return RECV_WOULD_BLOCK_RET_CODE;
+    }
+
+    PHYSICAL_LAYER__pop(socket);
+    return ret;
+}
+
+int PHYSICAL_LAYER__get_ready_fd(audio_physical_layer_socket_t* socket) {
+    return socket->ready_fd;
+}
+
+void PHYSICAL_LAYER__get_stats(audio_physical_layer_socket_t* socket, struct physical_layer_stats* stats) {
+    stats->capture_callbacks = atomic_load_explicit(&socket->capture_callbacks, memory_order_relaxed);
+    stats->capture_overrun_samples = atomic_load_explicit(&socket->capture_overrun_samples, memory_order_relaxed);
+    stats->capture_queue_depth = REFRAMER__get_fill(socket->reframer);
+    stats->capture_queue_max_depth = atomic_load_explicit(&socket->capture_queue_max_depth, memory_order_relaxed);
+    stats->capture_callback_max_nanoseconds = atomic_load_explicit(&socket->capture_callback_max_nanoseconds, memory_order_relaxed);
+    stats->windows_decoded = atomic_load_explicit(&socket->windows_decoded, memory_order_relaxed);
+    stats->frames_received = atomic_load_explicit(&socket->frame_ring_write_position, memory_order_relaxed);
+    stats->frame_ring_depth = stats->frames_received -
+                              atomic_load_explicit(&socket->frame_ring_read_position, memory_order_relaxed);
+    stats->frame_ring_max_depth = atomic_load_explicit(&socket->frame_ring_max_depth, memory_order_relaxed);
+    stats->frame_ring_overflows = atomic_load_explicit(&socket->frame_ring_overflows, memory_order_relaxed);
+    stats->symbols_received = atomic_load_explicit(&socket->symbols_received, memory_order_relaxed);
+    stats->symbols_erased = atomic_load_explicit(&socket->symbols_erased, memory_order_relaxed);
+    stats->symbol_bits = socket->symbol_bits;
+}
\ No newline at end of file
@@ -7,8 +7,11 @@
 #define AUDIONET_PHYSICAL_LAYER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <sys/types.h>
 
+#include "audio/audio.h"
+
 /**
  * Configures the packet size of a single audio packet.
  */
@@ -17,24 +20,270 @@
 /**
  * The configured timeout until receive timeout failure.
  */
-#define RECV_TIMEOUT_SECONDS (6)
+#define RECV_TIMEOUT_MILLISECONDS (6000)
 
 /**
  * The error code for receive timeout.
  */
 #define RECV_TIMEOUT_RET_CODE (-2)
 
+/**
+ * The error code for a non-blocking receive with nothing to receive yet.
+ */
+#define RECV_WOULD_BLOCK_RET_CODE (-4)
+
+/**
+ * The return code of `PHYSICAL_LAYER__recv_feedback` when a frame has arrived instead of a feedback signal.
+ */
+#define RECV_FRAME_PENDING_RET_CODE (1)
+
+/**
+ * The default amount of received frames held until read.
+ */
+#define PHYSICAL_LAYER_DEFAULT_FRAME_RING_CAPACITY (50)
+
+/**
+ * The default FFTW wisdom cache file, relative to the working directory.
+ */
+#define PHYSICAL_LAYER_DEFAULT_FFT_WISDOM_PATH ("audionet.wisdom")
+
+/**
+ * The available detectors for finding the transmitted frequencies in a recording.
+ */
+enum physical_layer_detector {
+    /** A full spectrum FFT, the loudest bins are searched for the channel carriers. */
+    PHYSICAL_LAYER_DETECTOR_FFT,
+
+    /** A Goertzel filter bank evaluating only the channel carriers, much cheaper per window. */
+    PHYSICAL_LAYER_DETECTOR_GOERTZEL,
+};
+
+/**
+ * The largest analysis hop the timed framing works with (half the 3600 samples analysis window),
+ * each byte symbol must be fully covered by a few analysis windows.
+ */
+#define PHYSICAL_LAYER_TIMED_FRAMING_MAX_HOP_SIZE (1800)
+
+/**
+ * The recommended analysis hop for the timed framing (a quarter of the analysis window).
+ */
+#define PHYSICAL_LAYER_TIMED_FRAMING_HOP_SIZE (900)
+
+/**
+ * The ways frames are delimited into bytes, both peers must use the same framing.
+ */
+enum physical_layer_framing {
+    /** Every byte symbol is followed by a separator symbol, delimiting the bytes' votes. */
+    PHYSICAL_LAYER_FRAMING_SEPARATED,
+
+    /**
+     * Byte symbols are sent back to back, the receiver recovers the symbol timing from the end of the preamble.
+     * Nearly doubles the throughput, requires an analysis hop of at most `PHYSICAL_LAYER_TIMED_FRAMING_MAX_HOP_SIZE`.
+     */
+    PHYSICAL_LAYER_FRAMING_TIMED,
+};
+
+/**
+ * The feedback signals, each a single short symbol sent without a frame around it,
+ * so acknowledging a frame costs a fraction of a second instead of a whole frame.
+ */
+enum physical_layer_feedback {
+    /** Positive acknowledgement. */
+    PHYSICAL_LAYER_FEEDBACK_ACK,
+
+    /** Negative acknowledgement. */
+    PHYSICAL_LAYER_FEEDBACK_NACK,
+};
+
+/**
+ * The default lowest frequency transmitted.
+ */
+#define PHYSICAL_LAYER_DEFAULT_BASE_FREQUENCY (100)
+
+/**
+ * The default separation width between transmitted frequencies.
+ */
+#define PHYSICAL_LAYER_DEFAULT_BAND_WIDTH (150)
+
+/**
+ * The default number of different frequency channels.
+ */
+#define PHYSICAL_LAYER_DEFAULT_CHANNELS_COUNT (13)
+
+/**
+ * The default number of frequency channels that are used simultaneously.
+ */
+#define PHYSICAL_LAYER_DEFAULT_CONCURRENT_CHANNELS_COUNT (3)
+
+/**
+ * The default length of time each value symbol sounds.
+ */
+#define PHYSICAL_LAYER_DEFAULT_SYMBOL_LENGTH_MILLISECONDS (150)
+
+/**
+ * The most bits a single data symbol carries, whatever the channel plan.
+ */
+#define PHYSICAL_LAYER_MAX_SYMBOL_BITS (16)
+
+/**
+ * The channel plan, the carriers and timing symbols are sent with, both peers must use the same plan.
+ * Each symbol sounds `concurrent_channels_count` of the `channels_count` carriers, so a plan has
+ * C(channels_count, concurrent_channels_count) symbol values. A few dozen values are reserved for the signals,
+ * and data symbols carry as many bits as the rest allow (8 to `PHYSICAL_LAYER_MAX_SYMBOL_BITS`),
+ * e.g. the default 3 of 13 carries a byte per symbol, while 4 of 32 carries 15 bits per symbol.
+ */
+struct physical_layer_channel_plan {
+    /** The lowest frequency transmitted. */
+    uint32_t base_frequency;
+
+    /** The separation width between transmitted frequencies, wider bands are more robust to frequency smearing. */
+    uint32_t band_width;
+
+    /** The number of different frequency channels (up to 64). */
+    uint32_t channels_count;
+
+    /** The number of frequency channels that are used simultaneously. */
+    uint32_t concurrent_channels_count;
+
+    /** The length of time each value symbol sounds, at least the length of an analysis window (75 milliseconds). */
+    uint32_t symbol_length_milliseconds;
+};
+
+/**
+ * The physical layer configuration, chosen at socket initialization.
+ */
+struct physical_layer_config {
+    /** The channel plan symbols are sent and received with. */
+    struct physical_layer_channel_plan channel_plan;
+
+    /** The detector used to decode each analysis window. */
+    enum physical_layer_detector detector;
+
+    /** The amount of recorded samples between consecutive analysis windows, lower than the window size for overlap. */
+    uint32_t analysis_hop_size;
+
+    /** The framing frames are sent and received with. */
+    enum physical_layer_framing framing;
+
+    /** Whether to low-pass and decimate the recording down to the channels' band before the detector. */
+    bool decimate;
+
+    /** The amount of received frames held until read, further frames are dropped (see `frame_ring_overflows`). */
+    uint32_t frame_ring_capacity;
+
+    /** The FFTW wisdom cache file for fast FFT planning (see `PHYSICAL_LAYER__warm_cache`), or NULL to always measure. */
+    const char* fft_wisdom_path;
+
+    /**
+     * The simulated medium to connect the socket to instead of the sound card (see `audio_medium.h`), or NULL.
+     * A lock-step medium waits for the socket whenever it's user isn't blocked in a receive, a feedback or a send
+     * (a non-blocking receive that would block counts until the next call), so a socket that's done with should be freed.
+     */
+    audio_medium_t* audio_medium;
+
+    /** The WAV files to replay the recording from and write the playback into instead of the sound card, or NULL. */
+    const struct audio_wav_config* audio_wav;
+
+    /** A WAV file to record every captured sample the socket decodes into (up to the last analysis window),
+     *  written by the decode worker, or NULL. It can be replayed through `audio_wav` or decoded offline. */
+    const char* capture_tap_path;
+};
+
 /**
  * The physical layer socket type.
  */
 typedef struct audio_physical_layer_socket_s audio_physical_layer_socket_t;
 
+/**
+ * Runtime counters of the physical layer receive path.
+ */
+struct physical_layer_stats {
+    /** The amount of recording callbacks handled by the audio thread. */
+    uint64_t capture_callbacks;
+
+    /** The amount of recorded samples dropped because the decode worker fell behind. */
+    uint64_t capture_overrun_samples;
+
+    /** The amount of recorded samples currently waiting for the decode worker. */
+    uint64_t capture_queue_depth;
+
+    /** The highest amount of recorded samples seen waiting for the decode worker. */
+    uint64_t capture_queue_max_depth;
+
+    /** The longest time the audio thread spent in the recording callback. */
+    uint64_t capture_callback_max_nanoseconds;
+
+    /** The amount of analysis windows decoded. */
+    uint64_t windows_decoded;
+
+    /** The amount of frames received. */
+    uint64_t frames_received;
+
+    /** The amount of received frames currently waiting to be read. */
+    uint64_t frame_ring_depth;
+
+    /** The highest amount of received frames seen waiting to be read. */
+    uint64_t frame_ring_max_depth;
+
+    /** The amount of frames dropped because the frame ring was full. */
+    uint64_t frame_ring_overflows;
+
+    /** The amount of data symbols registered into received frames. */
+    uint64_t symbols_received;
+
+    /** The amount of registered data symbols whose winner didn't hold a majority of the votes (their bytes are erased). */
+    uint64_t symbols_erased;
+
+    /** The amount of bits each data symbol carries, chosen by the channel plan. */
+    uint32_t symbol_bits;
+};
+
+/**
+ * Fills a configuration with the default physical layer settings.
+ *
+ * @param config The configuration to fill.
+ */
+void PHYSICAL_LAYER__get_default_config(struct physical_layer_config* config);
+
 /**
  * Allocates and initializes a new physical layer socket.
  *
+ * @param config The socket configuration, or NULL for the defaults.
  * @return The initialized socket, or NULL on failure.
  */
-audio_physical_layer_socket_t* PHYSICAL_LAYER__initialize();
+audio_physical_layer_socket_t* PHYSICAL_LAYER__initialize(const struct physical_layer_config* config);
+
+/**
+ * Allocates and initializes a physical layer decoder, the receive path of a socket without an audio interface.
+ * The recordings are passed with `PHYSICAL_LAYER__decode` and decoded on the calling thread (e.g recorded files),
+ * the frames are read with the non blocking receive functions.
+ * The audio configuration (the medium, WAV files and tap) is ignored.
+ *
+ * @param config The decoder configuration, or NULL for the defaults.
+ * @return The initialized decoder (freed with `PHYSICAL_LAYER__free`), or NULL on failure.
+ */
+audio_physical_layer_socket_t* PHYSICAL_LAYER__initialize_decoder(const struct physical_layer_config* config);
+
+/**
+ * Decodes recorded samples with a decoder, continuing the recording passed by the previous calls.
+ * Every frame completed is added to the received frames, frames beyond the frame ring's capacity are dropped,
+ * so they should be received between calls.
+ *
+ * @param socket The decoder, initialized by `PHYSICAL_LAYER__initialize_decoder`.
+ * @param samples The recorded samples, at 48kHz.
+ * @param samples_count The amount of samples.
+ * @return 0 On Success, -1 On Failure.
+ */
+int PHYSICAL_LAYER__decode(audio_physical_layer_socket_t* socket, const float* samples, size_t samples_count);
+
+/**
+ * Prepares the caches a socket with the given configuration uses, so later sockets start up quickly.
+ * Currently measures the FFT plans and saves them into the configured FFTW wisdom cache.
+ *
+ * @param config The socket configuration to prepare for, or NULL for the defaults.
+ * @return 0 On Success, -1 On Failure.
+ */
+int PHYSICAL_LAYER__warm_cache(const struct physical_layer_config* config);
 
 /**
  * Frees a physical layer socket.
@@ -53,6 +302,59 @@ void PHYSICAL_LAYER__free(audio_physical_layer_socket_t *socket);
  */
 int PHYSICAL_LAYER__send(audio_physical_layer_socket_t* socket, void* frame, size_t size);
 
+/**
+ * Queues a frame buffer to be sent over the physical layer socket without waiting for it to be sent,
+ * the size of the frame mustn't exceed `PHYSICAL_LAYER_MTU`.
+ * Frames queued back to back are sent without gaps between them.
+ *
+ * @param socket The socket over which to send the data.
+ * @param frame The frame buffer to send, may be reused once the function returns.
+ * @param size The size of the frame.
+ * @param ticket Returns the ticket of the queued frame, for `PHYSICAL_LAYER__wait_sent`.
+ * @return 0 On Success, -1 On Failure.
+ */
+int PHYSICAL_LAYER__send_async(audio_physical_layer_socket_t* socket, void* frame, size_t size, uint64_t* ticket);
+
+/**
+ * Waits until a queued frame (and all the frames queued before it) has been sent.
+ *
+ * @param socket The socket the frame was queued on.
+ * @param ticket The ticket returned by `PHYSICAL_LAYER__send_async`.
+ * @return 0 On Success, -1 On Failure.
+ */
+int PHYSICAL_LAYER__wait_sent(audio_physical_layer_socket_t* socket, uint64_t ticket);
+
+/**
+ * Queues a feedback signal to be sent over the physical layer socket without waiting for it to be sent.
+ *
+ * @param socket The socket over which to send the feedback.
+ * @param feedback The feedback to send.
+ * @param ticket Returns the ticket of the queued feedback, for `PHYSICAL_LAYER__wait_sent`.
+ * @return 0 On Success, -1 On Failure.
+ */
+int PHYSICAL_LAYER__send_feedback_async(audio_physical_layer_socket_t* socket, enum physical_layer_feedback feedback,
+                                        uint64_t* ticket);
+
+/**
+ * Sends a feedback signal over the physical layer socket.
+ *
+ * @param socket The socket over which to send the feedback.
+ * @param feedback The feedback to send.
+ * @return 0 On Success, -1 On Failure.
+ */
+int PHYSICAL_LAYER__send_feedback(audio_physical_layer_socket_t* socket, enum physical_layer_feedback feedback);
+
+/**
+ * Waits to receive a feedback signal, one detected after the socket's last waited send (`PHYSICAL_LAYER__wait_sent`).
+ * Since the peer may answer with a full frame instead, the wait also ends once there's a frame to receive.
+ *
+ * @param socket The socket over which to receive the feedback.
+ * @param feedback Returns the received feedback.
+ * @return 0 if a feedback was received, `RECV_FRAME_PENDING_RET_CODE` if there's a frame to receive instead,
+ *         `RECV_TIMEOUT_RET_CODE` on timeout, or another negative code on error.
+ */
+int PHYSICAL_LAYER__recv_feedback(audio_physical_layer_socket_t* socket, enum physical_layer_feedback* feedback);
+
 /**
  * Waits to receive a frame buffer over the physical layer socket,
  * the size of the frame buffer must be at least `PHYSICAL_LAYER_MTU`.
@@ -65,10 +367,31 @@ int PHYSICAL_LAYER__send(audio_physical_layer_socket_t* socket, void* frame, siz
  */
 ssize_t PHYSICAL_LAYER__recv(audio_physical_layer_socket_t* socket, void* frame, size_t size);
 
+/**
+ * Receives a frame buffer over the physical layer socket if there's one, without waiting.
+ *
+ * @param socket The socket over which to receive data.
+ * @param frame The buffer to save the incoming frame into.
+ * @param size The size of the frame buffer.
+ * @return The number of bytes in the read buffer on success,
+ *         `RECV_WOULD_BLOCK_RET_CODE` if there's no frame yet, or another negative code on error.
+ */
+ssize_t PHYSICAL_LAYER__recv_nonblocking(audio_physical_layer_socket_t* socket, void* frame, size_t size);
+
+/**
+ * Gets the socket's readiness descriptor, for multiplexing sockets with poll/select/epoll.
+ * The descriptor is readable (level-triggered) while there are received frames waiting to be read.
+ * It's owned by the socket, the user shouldn't read from or close it.
+ *
+ * @param socket The socket.
+ * @return The readiness file descriptor.
+ */
+int PHYSICAL_LAYER__get_ready_fd(audio_physical_layer_socket_t* socket);
+
 /**
  * Checks whether a frame has been recorded by the socket.
  * This call will allow the user to get the frame data without considering it as handled.
- * Can also be required to wait in a blocking manner for a frame to arrive upto a timeout of `RECV_TIMEOUT_SECONDS`.
+ * Can also be required to wait in a blocking manner for a frame to arrive upto a timeout of `RECV_TIMEOUT_MILLISECONDS`.
  *
  * @param socket The socket to peek from.
  * @param frame The buffer to save the incoming frame into, optional.
@@ -78,6 +401,16 @@ ssize_t PHYSICAL_LAYER__recv(audio_physical_layer_socket_t* socket, void* frame,
  */
 ssize_t PHYSICAL_LAYER__peek(audio_physical_layer_socket_t* socket, void* frame, size_t size, bool blocking);
 
+/**
+ * Gets the erasures of the recorded frame, the bytes whose vote had no majority winner and are likely wrong.
+ * The erasures belong to the frame returned by the last `PHYSICAL_LAYER__peek`, so should be read before popping it.
+ *
+ * @param socket The socket to peek from.
+ * @param erasures Returns the erasures, bit i is set if byte i of the frame is unreliable.
+ * @return 0 On Success, -1 if there's no recorded frame.
+ */
+int PHYSICAL_LAYER__peek_erasures(audio_physical_layer_socket_t* socket, uint16_t* erasures);
+
 /**
  * If there's a recorded frame, removes it.
  *
@@ -86,4 +419,12 @@ ssize_t PHYSICAL_LAYER__peek(audio_physical_layer_socket_t* socket, void* frame,
  */
 int PHYSICAL_LAYER__pop(audio_physical_layer_socket_t* socket);
 
+/**
+ * Gets a snapshot of the socket's receive path counters.
+ *
+ * @param socket The socket to query.
+ * @param stats Returns the counters.
+ */
+void PHYSICAL_LAYER__get_stats(audio_physical_layer_socket_t* socket, struct physical_layer_stats* stats);
+
 #endif //AUDIONET_PHYSICAL_LAYER_H
@@ -0,0 +1,136 @@
+#include <malloc.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "reframer.h"
+#include "utils/logger.h"
+#include "utils/utils.h"
+
+struct reframer_s {
+    /** The ring storage, `capacity` samples long. */
+    float* samples;
+
+    /** The ring size, always a power of two so positions can be masked into indices. */
+    size_t capacity;
+
+    /** The amount of samples in each emitted window. */
+    size_t window_size;
+
+    /** The amount of samples the read position advances per window. */
+    size_t hop_size;
+
+    /**
+     * The total amount of samples ever written, owned by the producer.
+     * Published with release semantics so the consumer sees the samples before the position.
+     */
+    _Atomic uint64_t write_position;
+
+    /**
+     * The stream index of the next window's first sample, owned by the consumer.
+     * Published with release semantics so the producer won't overwrite samples still being copied.
+     */
+    _Atomic uint64_t read_position;
+};
+
+reframer_t* REFRAMER__initialize(size_t window_size, size_t hop_size, size_t capacity) {
+    /* Validate parameters. */
+    if (window_size == 0 || hop_size == 0 || hop_size > window_size) {
+        LOG_ERROR("Invalid reframer window %zu / hop %zu", window_size, hop_size);
+        return NULL;
+    }
+
+    /* Allocate the reframer struct. */
+    reframer_t* reframer = malloc(sizeof(reframer_t));
+    if (reframer == NULL) {
+        LOG_ERROR("Failed to allocate reframer");
+        return NULL;
+    }
+
+    /* Round the capacity up to a power of two that can hold at least a single window. */
+    reframer->capacity = 1;
+    while (reframer->capacity < max(capacity, window_size)) {
+        reframer->capacity <<= 1;
+    }
+
+    reframer->window_size = window_size;
+    reframer->hop_size = hop_size;
+    atomic_init(&reframer->write_position, 0);
+    atomic_init(&reframer->read_position, 0);
+
+    /* Allocate the ring storage. */
+    reframer->samples = malloc(reframer->capacity * sizeof(float));
+    if (reframer->samples == NULL) {
+        LOG_ERROR("Failed to allocate reframer ring of %zu samples", reframer->capacity);
+        free(reframer);
+        return NULL;
+    }
+
+    return reframer;
+}
+
+void REFRAMER__free(reframer_t* reframer) {
+    if (reframer == NULL) {
+        return;
+    }
+
+    free(reframer->samples);
+    free(reframer);
+}
+
+size_t REFRAMER__write(reframer_t* reframer, const float* samples, size_t count) {
+    /* Only the producer changes the write position, so a relaxed load is enough. */
+    uint64_t write_position = atomic_load_explicit(&reframer->write_position, memory_order_relaxed);
+    uint64_t read_position = atomic_load_explicit(&reframer->read_position, memory_order_acquire);
+
+    /* Write as much as there's free room for. */
+    size_t free_space = reframer->capacity - (size_t)(write_position - read_position);
+    size_t to_write = min(count, free_space);
+    if (to_write == 0) {
+        return 0;
+    }
+
+    /* Copy in up to two parts, in case we wrap around the end of the ring. */
+    size_t start = write_position & (reframer->capacity - 1);
+    size_t first_part = min(to_write, reframer->capacity - start);
+    memcpy(reframer->samples + start, samples, first_part * sizeof(float));
+    memcpy(reframer->samples, samples + first_part, (to_write - first_part) * sizeof(float));
+
+    /* Publish the samples to the consumer. */
+    atomic_store_explicit(&reframer->write_position, write_position + to_write, memory_order_release);
+    return to_write;
+}
+
+bool REFRAMER__read_window(reframer_t* reframer, float* window, uint64_t* position) {
+    /* Only the consumer changes the read position, so a relaxed load is enough. */
+    uint64_t read_position = atomic_load_explicit(&reframer->read_position, memory_order_relaxed);
+    uint64_t write_position = atomic_load_explicit(&reframer->write_position, memory_order_acquire);
+
+    /* Wait until a full window has been collected. */
+    if (write_position - read_position < reframer->window_size) {
+        return false;
+    }
+
+    /* Copy out in up to two parts, in case the window wraps around the end of the ring. */
+    size_t start = read_position & (reframer->capacity - 1);
+    size_t first_part = min(reframer->window_size, reframer->capacity - start);
+    memcpy(window, reframer->samples + start, first_part * sizeof(float));
+    memcpy(window + first_part, reframer->samples, (reframer->window_size - first_part) * sizeof(float));
+
+    if (position != NULL) {
+        *position = read_position;
+    }
+
+    /* Release only the hop, the rest of the window is the overlap of the next one. */
+    atomic_store_explicit(&reframer->read_position, read_position + reframer->hop_size, memory_order_release);
+    return true;
+}
+
+size_t REFRAMER__get_fill(reframer_t* reframer) {
+    uint64_t read_position = atomic_load_explicit(&reframer->read_position, memory_order_acquire);
+    uint64_t write_position = atomic_load_explicit(&reframer->write_position, memory_order_acquire);
+    return (size_t)(write_position - read_position);
+}
+
+size_t REFRAMER__get_window_size(reframer_t* reframer) {
+    return reframer->window_size;
+}
@@ -0,0 +1,76 @@
+/**
+ * Defines the capture reframer of the physical layer.
+ * The audio backend hands us recordings in whatever period size it chooses, while the decoder needs
+ * fixed size analysis windows. The reframer is a lock-free single-producer/single-consumer sample ring
+ * that collects the recorded samples and emits fixed size windows, advancing by a configurable hop.
+ */
+
+#ifndef AUDIONET_REFRAMER_H
+#define AUDIONET_REFRAMER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The reframer type.
+ */
+typedef struct reframer_s reframer_t;
+
+/**
+ * Allocates and initializes a new reframer.
+ * A hop smaller than the window size makes consecutive windows overlap.
+ *
+ * @param window_size The amount of samples in each emitted window.
+ * @param hop_size The amount of samples between the starts of consecutive windows (0 < hop_size <= window_size).
+ * @param capacity The minimal amount of samples the ring can hold, rounded up to a power of two (at least window_size).
+ * @return The initialized reframer, or NULL on failure.
+ */
+reframer_t* REFRAMER__initialize(size_t window_size, size_t hop_size, size_t capacity);
+
+/**
+ * Frees a reframer previously initialized with REFRAMER__initialize.
+ *
+ * @param reframer The reframer to free.
+ */
+void REFRAMER__free(reframer_t* reframer);
+
+/**
+ * Producer side - appends recorded samples to the ring.
+ * Never blocks, writes as many samples as there's room for.
+ *
+ * @param reframer The reframer to write into.
+ * @param samples The recorded samples.
+ * @param count The amount of samples.
+ * @return The amount of samples actually written.
+ */
+size_t REFRAMER__write(reframer_t* reframer, const float* samples, size_t count);
+
+/**
+ * Consumer side - takes the next analysis window if enough samples were collected.
+ * The window is copied out and the ring advances by the hop size.
+ *
+ * @param reframer The reframer to read from.
+ * @param window The buffer to copy the window into, must hold at least the window size.
+ * @param position Returns the stream index of the window's first sample, optional.
+ * @return Whether a window was read.
+ */
+bool REFRAMER__read_window(reframer_t* reframer, float* window, uint64_t* position);
+
+/**
+ * Gets the amount of samples currently held in the ring.
+ *
+ * @param reframer The reframer.
+ * @return The amount of unread samples.
+ */
+size_t REFRAMER__get_fill(reframer_t* reframer);
+
+/**
+ * Gets the window size the reframer emits.
+ *
+ * @param reframer The reframer.
+ * @return The window size in samples.
+ */
+size_t REFRAMER__get_window_size(reframer_t* reframer);
+
+#endif //AUDIONET_REFRAMER_H
@@ -0,0 +1,258 @@
+#include <inttypes.h>
+#include <malloc.h>
+#include <math.h>
+#include <string.h>
+
+#include "symbol_cache.h"
+#include "channel_tuples.h"
+#include "utils/logger.h"
+
+/**
+ * A symbol range held by the cache.
+ */
+struct cached_range {
+    /** The range's values and length. */
+    struct symbol_cache_range range;
+
+    /** The amount of samples in each of the range's symbols. */
+    uint32_t samples_count;
+
+    /** The range's pre-rendered symbols back to back, ordered by value, or NULL if they are rendered on use. */
+    float* symbols;
+};
+
+struct symbol_cache_s {
+    /** The encoding the symbols are rendered with. */
+    audio_encoding_t* encoding;
+
+    /** The sample rate the symbols are rendered at. */
+    uint32_t sample_rate;
+
+    /** The symbol ranges the cache holds. */
+    struct cached_range* ranges;
+
+    /** The amount of symbol ranges. */
+    size_t ranges_count;
+
+    /** The ring of symbols rendered on use, `scratch_symbols_count` slots of `scratch_slot_size` samples, or NULL. */
+    float* scratch;
+
+    /** The amount of slots in the scratch ring. */
+    size_t scratch_symbols_count;
+
+    /** The amount of samples in each scratch slot, enough for the longest range rendered on use. */
+    uint32_t scratch_slot_size;
+
+    /** The next scratch slot to render into. */
+    size_t scratch_next;
+};
+
+/**
+ * Renders a symbol's PCM, the encoded frequencies overlaid with a simple average,
+ * each starting at phase zero.
+ *
+ * @param cache The symbol cache.
+ * @param value The symbol value.
+ * @param samples_count The amount of samples to render.
+ * @param samples Returns the rendered samples.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int render_symbol(symbol_cache_t* cache, uint64_t value, uint32_t samples_count, float* samples) {
+    uint32_t frequencies_count = AUDIO_ENCODING__get_concurrent_channels_count(cache->encoding);
+    uint32_t frequencies[CHANNEL_TUPLES_MAX_CHANNELS];
+    if (AUDIO_ENCODING__encode_frequencies(cache->encoding, value, frequencies_count, frequencies) != 0) {
+        LOG_ERROR("Failed to encode frequencies for value %" PRIu64, value);
+        return -1;
+    }
+
+    for (uint32_t n = 0; n < samples_count; ++n) {
+        double sample = 0;
+        for (uint32_t i = 0; i < frequencies_count; ++i) {
+            sample += sin(2 * M_PI * frequencies[i] * n / cache->sample_rate);
+        }
+
+        samples[n] = (float)(sample / frequencies_count);
+    }
+
+    return 0;
+}
+
+/**
+ * Checks whether a range repeats the values and length of an earlier range.
+ *
+ * @param ranges The ranges.
+ * @param index The index of the checked range.
+ * @return Whether the range is a duplicate.
+ */
+static bool is_duplicate_range(const struct symbol_cache_range* ranges, size_t index) {
+    for (size_t i = 0; i < index; ++i) {
+        if (ranges[i].first_value == ranges[index].first_value &&
+                ranges[i].values_count == ranges[index].values_count &&
+                ranges[i].length_milliseconds == ranges[index].length_milliseconds) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Pre-renders every symbol of a range.
+ *
+ * @param cache The symbol cache.
+ * @param cached The range to render, it's symbols are allocated.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int render_range(symbol_cache_t* cache, struct cached_range* cached) {
+    cached->symbols = malloc(cached->range.values_count * cached->samples_count * sizeof(float));
+    if (cached->symbols == NULL) {
+        LOG_ERROR("Failed to allocate %" PRIu64 " symbols of %u samples",
+                  cached->range.values_count, cached->samples_count);
+        return -1;
+    }
+
+    for (uint64_t i = 0; i < cached->range.values_count; ++i) {
+        if (render_symbol(cache, cached->range.first_value + i, cached->samples_count,
+                          cached->symbols + i * cached->samples_count) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+symbol_cache_t* SYMBOL_CACHE__initialize(audio_encoding_t* encoding, uint32_t sample_rate,
+                                         const struct symbol_cache_range* ranges, size_t ranges_count,
+                                         size_t scratch_symbols_count) {
+    /* Validate parameters. */
+    if (encoding == NULL || sample_rate == 0 || ranges == NULL || ranges_count == 0 || scratch_symbols_count == 0) {
+        LOG_ERROR("Invalid symbol cache parameters");
+        return NULL;
+    }
+
+    /* Allocate the symbol cache struct. */
+    symbol_cache_t* cache = malloc(sizeof(symbol_cache_t));
+    if (cache == NULL) {
+        LOG_ERROR("Failed to allocate symbol cache");
+        return NULL;
+    }
+
+    cache->encoding = encoding;
+    cache->sample_rate = sample_rate;
+    cache->ranges_count = 0;
+    cache->scratch = NULL;
+    cache->scratch_symbols_count = scratch_symbols_count;
+    cache->scratch_slot_size = 0;
+    cache->scratch_next = 0;
+    cache->ranges = calloc(ranges_count, sizeof(struct cached_range));
+    if (cache->ranges == NULL) {
+        LOG_ERROR("Failed to allocate symbol cache ranges");
+        SYMBOL_CACHE__free(cache);
+        return NULL;
+    }
+
+    /* Pre-render the ranges while they fit, the rest are rendered on use. */
+    uint64_t cached_bytes = 0;
+    for (size_t i = 0; i < ranges_count; ++i) {
+        if (is_duplicate_range(ranges, i)) {
+            continue;
+        }
+
+        struct cached_range* cached = &cache->ranges[cache->ranges_count++];
+        cached->range = ranges[i];
+        cached->samples_count = sample_rate / 1000 * ranges[i].length_milliseconds;
+        cached->symbols = NULL;
+
+        uint64_t range_bytes = ranges[i].values_count * cached->samples_count * sizeof(float);
+        if (cached_bytes + range_bytes > SYMBOL_CACHE_MAX_BYTES) {
+            LOG_INFO("Symbols %" PRIu64 "-%" PRIu64 " of %ums don't fit in the cache, rendering them on use",
+                     ranges[i].first_value, ranges[i].first_value + ranges[i].values_count - 1,
+                     ranges[i].length_milliseconds);
+            if (cached->samples_count > cache->scratch_slot_size) {
+                cache->scratch_slot_size = cached->samples_count;
+            }
+            continue;
+        }
+
+        if (render_range(cache, cached) != 0) {
+            SYMBOL_CACHE__free(cache);
+            return NULL;
+        }
+        cached_bytes += range_bytes;
+    }
+
+    /* Allocate the scratch ring for the ranges rendered on use. */
+    if (cache->scratch_slot_size > 0) {
+        cache->scratch = malloc(scratch_symbols_count * cache->scratch_slot_size * sizeof(float));
+        if (cache->scratch == NULL) {
+            LOG_ERROR("Failed to allocate %zu scratch symbols of %u samples",
+                      scratch_symbols_count, cache->scratch_slot_size);
+            SYMBOL_CACHE__free(cache);
+            return NULL;
+        }
+    }
+
+    return cache;
+}
+
+void SYMBOL_CACHE__free(symbol_cache_t* cache) {
+    if (cache == NULL) {
+        return;
+    }
+
+    if (cache->ranges != NULL) {
+        for (size_t i = 0; i < cache->ranges_count; ++i) {
+            free(cache->ranges[i].symbols);
+        }
+    }
+
+    free(cache->ranges);
+    free(cache->scratch);
+    free(cache);
+}
+
+/**
+ * Finds the range holding a symbol of the given length.
+ *
+ * @param cache The symbol cache.
+ * @param value The symbol value.
+ * @param length_milliseconds The symbol length.
+ * @return The range, or NULL if the cache doesn't hold the symbol.
+ */
+static struct cached_range* find_range(symbol_cache_t* cache, uint64_t value, uint32_t length_milliseconds) {
+    for (size_t i = 0; i < cache->ranges_count; ++i) {
+        const struct symbol_cache_range* range = &cache->ranges[i].range;
+        if (range->length_milliseconds == length_milliseconds && value >= range->first_value &&
+                value - range->first_value < range->values_count) {
+            return &cache->ranges[i];
+        }
+    }
+
+    return NULL;
+}
+
+int SYMBOL_CACHE__get(symbol_cache_t* cache, uint64_t value, uint32_t length_milliseconds,
+                      struct pcm_segment_s* segment) {
+    /* Validate parameters. */
+    struct cached_range* cached = find_range(cache, value, length_milliseconds);
+    if (cached == NULL) {
+        LOG_ERROR("Symbol %" PRIu64 " of %ums is not cacheable", value, length_milliseconds);
+        return -1;
+    }
+
+    segment->samples_count = cached->samples_count;
+    if (cached->symbols != NULL) {
+        segment->samples = cached->symbols + (value - cached->range.first_value) * cached->samples_count;
+        return 0;
+    }
+
+    /* Render the symbol into the oldest scratch slot. */
+    float* slot = cache->scratch + cache->scratch_next * cache->scratch_slot_size;
+    cache->scratch_next = (cache->scratch_next + 1) % cache->scratch_symbols_count;
+    if (render_symbol(cache, value, cached->samples_count, slot) != 0) {
+        return -1;
+    }
+
+    segment->samples = slot;
+    return 0;
+}
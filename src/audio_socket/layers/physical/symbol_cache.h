@@ -0,0 +1,78 @@
+/**
+ * Defines the transmit symbol cache of the physical layer.
+ * There are a handful of symbol lengths and the symbols sent are mostly a few hundred distinct ones, so instead of
+ * synthesizing the sines of each symbol on every send, the symbols are rendered into PCM once (at initialization)
+ * and reused. Plans with too many symbol values to hold fall back to rendering each symbol as it's sent.
+ * Every symbol is rendered starting at phase zero, same as a freshly initialized waveform would.
+ */
+
+#ifndef AUDIONET_SYMBOL_CACHE_H
+#define AUDIONET_SYMBOL_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "audio/audio.h"
+#include "audio_encoding.h"
+
+/** The most memory the cache pre-renders symbols into, the ranges past it are rendered on use. */
+#define SYMBOL_CACHE_MAX_BYTES (64 * 1024 * 1024)
+
+/**
+ * The symbol cache type.
+ */
+typedef struct symbol_cache_s symbol_cache_t;
+
+/**
+ * A range of consecutive symbol values sent at a single length.
+ */
+struct symbol_cache_range {
+    /** The first symbol value of the range. */
+    uint64_t first_value;
+
+    /** The amount of symbol values in the range. */
+    uint64_t values_count;
+
+    /** The length the range's symbols are sent at. */
+    uint32_t length_milliseconds;
+};
+
+/**
+ * Allocates and initializes a new symbol cache, pre-rendering the given ranges in order while they fit in
+ * `SYMBOL_CACHE_MAX_BYTES`. A range repeating the values and length of an earlier one is ignored.
+ * The ranges that don't fit are rendered on use into a ring of scratch symbols.
+ *
+ * @param encoding The encoding the symbols are rendered with, must outlive the cache.
+ * @param sample_rate The sample rate to render the symbols at.
+ * @param ranges The symbol ranges that may be requested, the most used first.
+ * @param ranges_count The amount of symbol ranges.
+ * @param scratch_symbols_count The amount of symbols rendered on use that have to stay valid at once.
+ * @return The initialized symbol cache, or NULL on failure.
+ */
+symbol_cache_t* SYMBOL_CACHE__initialize(audio_encoding_t* encoding, uint32_t sample_rate,
+                                         const struct symbol_cache_range* ranges, size_t ranges_count,
+                                         size_t scratch_symbols_count);
+
+/**
+ * Frees a symbol cache previously initialized with SYMBOL_CACHE__initialize.
+ *
+ * @param cache The symbol cache to free.
+ */
+void SYMBOL_CACHE__free(symbol_cache_t* cache);
+
+/**
+ * Gets the rendered PCM of a symbol.
+ * A pre-rendered symbol is valid until the cache is freed, and getting it is thread safe.
+ * A symbol rendered on use is valid until `scratch_symbols_count` more are, and should only be rendered from
+ * the sending thread.
+ *
+ * @param cache The symbol cache.
+ * @param value The symbol value.
+ * @param length_milliseconds The symbol length, the value has to be in one of the cache's ranges of that length.
+ * @param segment Returns the symbol's PCM segment, owned by the cache.
+ * @return 0 On Success, -1 On Failure.
+ */
+int SYMBOL_CACHE__get(symbol_cache_t* cache, uint64_t value, uint32_t length_milliseconds,
+                      struct pcm_segment_s* segment);
+
+#endif //AUDIONET_SYMBOL_CACHE_H
@@ -8,22 +8,34 @@
 #include "utils/utils.h"
 
 
-struct audio_transport_layer_socket_s {
-    /** The transport layer uses the link layer to send packets. */
-    audio_link_layer_socket_t* link_layer;
+/**
+ * The flags of a transport packet.
+ */
+enum transport_packet_flags {
+    /** The packet is the first of a message, it's data starts with the message length as uint32_t. */
+    TRANSPORT_FLAG_FIRST = 1 << 0,
 
-    /** The current expected sequence number. */
-    uint8_t seq;
+    /** The last packet of a window, the sender waits for an ack after it. */
+    TRANSPORT_FLAG_POLL = 1 << 1,
+
+    /** The packet is a selective ack, carrying `struct transport_ack_s`. */
+    TRANSPORT_FLAG_ACK = 1 << 2,
 };
 
 /**
  * The header for each transport packet.
  */
 struct transport_packet_header_s {
-    /** The sequence number of the packet. */
-    uint8_t seq;
+    /** The sequence number of the packet, kept running across messages. */
+    uint16_t seq;
+
+    /** The packet's `enum transport_packet_flags`. */
+    uint8_t flags;
 } __attribute__((packed));
 
+/** The maximal amount of data carried by each transport packet, the link layer's error correction may lower it. */
+#define TRANSPORT_PACKET_DATA_SIZE (LINK_LAYER_MTU - sizeof(struct transport_packet_header_s))
+
 /**
  * The transport layer packet structure.
  */
@@ -32,10 +44,115 @@ struct transport_packet_s {
     struct transport_packet_header_s header;
 
     /** The data carried by each packet */
-    uint8_t data[LINK_LAYER_MTU - sizeof(struct transport_packet_header_s)];
+    uint8_t data[TRANSPORT_PACKET_DATA_SIZE];
+} __attribute__((packed));
+
+/**
+ * The selective ack, the data of a packet with the `TRANSPORT_FLAG_ACK` flag.
+ */
+struct transport_ack_s {
+    /** The next sequence number expected in order, every packet before it has been received. */
+    uint16_t base;
+
+    /** Bit i is set if packet `base + i` has been received (out of order). */
+    uint32_t bitmap;
 } __attribute__((packed));
 
-audio_transport_layer_socket_t *TRANSPORT_LAYER__initialize() {
+/**
+ * The state of the message currently being received, kept across non-blocking receives.
+ */
+struct transport_recv_state {
+    /** The sequence number of the message's first packet. */
+    uint16_t first_seq;
+
+    /** The length of the message, read from the first packet. */
+    uint32_t data_length;
+
+    /** Whether the first packet (carrying the length) has been received. */
+    bool read_data_length;
+};
+
+struct audio_transport_layer_socket_s {
+    /** The transport layer uses the link layer to send packets. */
+    audio_link_layer_socket_t* link_layer;
+
+    /** The amount of packets sent before polling for an ack. */
+    uint32_t window_size;
+
+    /** The amount of data carried by each packet, fitting the link layer's MTU. */
+    size_t packet_data_size;
+
+    /** The sequence number of the next message's first packet. */
+    uint16_t send_seq;
+
+    /** The next sequence number expected in order. */
+    uint16_t recv_base;
+
+    /** Bit i is set if packet `recv_base + i` has been received ahead of order. */
+    uint32_t recv_bitmap;
+
+    /** The message currently being received. */
+    struct transport_recv_state recv_state;
+
+    /** The socket's counters. */
+    struct transport_layer_stats stats;
+};
+
+/**
+ * Gets the signed distance between two sequence numbers, correct as long as they're less than half the range apart.
+ *
+ * @param seq The sequence number.
+ * @param base The sequence number to measure from.
+ * @return The amount of packets `seq` is after `base` (negative if before).
+ */
+static int32_t seq_distance(uint16_t seq, uint16_t base) {
+    return (int16_t)(uint16_t)(seq - base);
+}
+
+/**
+ * Gets the amount of packets a message is split into, the first packet also carries the message length.
+ *
+ * @param socket The socket.
+ * @param size The length of the message.
+ * @return The amount of packets.
+ */
+static uint32_t get_packets_count(audio_transport_layer_socket_t *socket, uint32_t size) {
+    return (uint32_t)((size + sizeof(uint32_t) + socket->packet_data_size - 1) / socket->packet_data_size);
+}
+
+/**
+ * Gets the message offset of a packet's data, the first packet's data starts after the message length.
+ *
+ * @param socket The socket.
+ * @param index The index of the packet in the message.
+ * @return The message offset of the packet's data (after the length, for the first packet).
+ */
+static size_t get_packet_offset(audio_transport_layer_socket_t *socket, uint32_t index) {
+    return (index == 0) ? 0 : index * socket->packet_data_size - sizeof(uint32_t);
+}
+
+void TRANSPORT_LAYER__get_default_config(struct transport_layer_config* config) {
+    config->window_size = TRANSPORT_LAYER_DEFAULT_WINDOW_SIZE;
+}
+
+audio_transport_layer_socket_t *TRANSPORT_LAYER__initialize(
+        const struct physical_layer_config* physical_config,
+        const struct link_layer_config* link_config,
+        const struct transport_layer_config* config
+) {
+    /* Use the default configuration if none is given */
+    struct transport_layer_config default_config;
+    if (config == NULL) {
+        TRANSPORT_LAYER__get_default_config(&default_config);
+        config = &default_config;
+    }
+
+    /* Validate the configuration */
+    if (config->window_size == 0 || config->window_size > TRANSPORT_LAYER_MAX_WINDOW_SIZE) {
+        LOG_ERROR("Invalid transport window size %u (1 - %u)", config->window_size, TRANSPORT_LAYER_MAX_WINDOW_SIZE);
+        return NULL;
+    }
+
     /* Allocate the transport layer socket */
     audio_transport_layer_socket_t* socket = malloc(sizeof(audio_transport_layer_socket_t));
     if (socket == NULL) {
@@ -44,14 +161,28 @@ audio_transport_layer_socket_t *TRANSPORT_LAYER__initialize() {
     }
 
     /* Initialize the under laying link layer */
-    socket->link_layer = LINK_LAYER__initialize();
+    socket->link_layer = LINK_LAYER__initialize(physical_config, link_config);
     if (socket->link_layer == NULL) {
         LOG_ERROR("Failed to initialize audio link layer");
         free(socket);
         return NULL;
     }
 
-    socket->seq = 0;
+    /* The packets must fit the link layer's MTU, which it's error correction may lower */
+    socket->packet_data_size = LINK_LAYER__get_mtu(socket->link_layer) - sizeof(struct transport_packet_header_s);
+    if (socket->packet_data_size < sizeof(struct transport_ack_s)) {
+        LOG_ERROR("Link layer MTU too small for the transport layer: %zu", LINK_LAYER__get_mtu(socket->link_layer));
+        LINK_LAYER__free(socket->link_layer);
+        free(socket);
+        return NULL;
+    }
+
+    socket->window_size = config->window_size;
+    socket->send_seq = 0;
+    socket->recv_base = 0;
+    socket->recv_bitmap = 0;
+    memset(&socket->recv_state, 0, sizeof(socket->recv_state));
+    memset(&socket->stats, 0, sizeof(socket->stats));
     return socket;
 }
 
@@ -63,122 +194,359 @@ void TRANSPORT_LAYER__free(audio_transport_layer_socket_t *socket) {
     free(socket);
 }
 
+/**
+ * Fills a message's packet, the first packet starts with the length of the message.
+ *
+ * @param socket The socket sending the packet.
+ * @param packet The packet to fill.
+ * @param seq The sequence number of the message's first packet.
+ * @param index The index of the packet in the message.
+ * @param data The message.
+ * @param size The length of the message.
+ * @return The length of the packet.
+ */
+static size_t build_packet(audio_transport_layer_socket_t *socket, struct transport_packet_s* packet,
+                           uint16_t seq, uint32_t index, const uint8_t* data, uint32_t size) {
+    size_t offset = get_packet_offset(socket, index);
+    size_t length_size = 0;
+
+    packet->header.seq = (uint16_t)(seq + index);
+    packet->header.flags = 0;
+    if (index == 0) {
+        packet->header.flags |= TRANSPORT_FLAG_FIRST;
+        memcpy(packet->data, &size, sizeof(size));
+        length_size = sizeof(size);
+    }
+
+    size_t data_sending = min(size - offset, socket->packet_data_size - length_size);
+    memcpy(packet->data + length_size, data + offset, data_sending);
+    return sizeof(packet->header) + length_size + data_sending;
+}
+
+/**
+ * Receives a selective ack packet and marks the window's packets it acks.
+ * A missing, corrupted or stale ack isn't a failure, the unacked packets are simply retransmitted.
+ *
+ * @param socket The socket to receive the ack over.
+ * @param first_seq The sequence number of the message's first packet.
+ * @param base The index of the window's first packet in the message.
+ * @param window_end The index after the window's last packet in the message.
+ * @param acked The acked flag of each of the message's packets, updated by the ack.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int receive_ack(audio_transport_layer_socket_t *socket, uint16_t first_seq, uint32_t base, uint32_t window_end, bool* acked) {
+    struct transport_packet_s packet_in;
+    struct transport_ack_s ack;
+
+    /* Try to receive an ack */
+    ssize_t recv_ret = LINK_LAYER__recv(socket->link_layer, &packet_in, sizeof(packet_in));
+    if (recv_ret == RECV_TIMEOUT_RET_CODE) {
+        /* Timeout - Retransmit */
+        LOG_INFO("Timed out, retrying send");
+        socket->stats.polls_unanswered++;
+        return 0;
+    } else if (recv_ret == RECV_OUT_OF_SYNC_RET_CODE || recv_ret == RECV_UNCORRECTABLE_RET_CODE ||
+            recv_ret == RECV_CRC_MISMATCH_RET_CODE) {
+        /* Out-of-sync or corrupted - Retransmit */
+        LOG_INFO("Out of sync");
+        socket->stats.polls_unanswered++;
+        return 0;
+    } else if (recv_ret < 0) {
+        LOG_ERROR("Failed to recv ack on transport layer");
+        return -1;
+    }
+
+    if (!(packet_in.header.flags & TRANSPORT_FLAG_ACK) ||
+            (size_t)recv_ret < sizeof(packet_in.header) + sizeof(ack)) {
+        LOG_WARNING("Expected an ack, got a packet of seq %u", packet_in.header.seq);
+        socket->stats.polls_unanswered++;
+        return 0;
+    }
+    memcpy(&ack, packet_in.data, sizeof(ack));
+
+    /* An ack from before this message started is stale (the receiver already had the previous message) */
+    if (seq_distance(ack.base, first_seq) < 0) {
+        LOG_WARNING("Stale ack %u", ack.base);
+        socket->stats.polls_unanswered++;
+        return 0;
+    }
+    socket->stats.selective_acks_received++;
+
+    /* Mark the acked packets, everything before the ack's base and the bitmap's packets */
+    for (uint32_t i = base; i < window_end; ++i) {
+        int32_t distance = seq_distance((uint16_t)(first_seq + i), ack.base);
+        if (distance < 0 || (distance < TRANSPORT_LAYER_MAX_WINDOW_SIZE && (ack.bitmap >> distance) & 1)) {
+            acked[i] = true;
+        }
+    }
+
+    return 0;
+}
+
 int TRANSPORT_LAYER__send(audio_transport_layer_socket_t *socket, void *data, size_t size) {
     int ret = -1;
-    ssize_t recv_ret = -1;
-    size_t data_remaining = size + sizeof(uint32_t);
-    uint8_t* current_data_ptr = data;
     struct transport_packet_s packet_out;
-    struct transport_packet_s packet_in;
-    size_t data_sending;
-    size_t size_header_fix = sizeof(uint32_t);
-
-    /* Fill the first packet with the length of the data as uint32_t and the remaining space with data */
-    packet_out.header.seq = socket->seq;
-    data_sending = min(data_remaining, sizeof(packet_out.data));
-    *((uint32_t*)packet_out.data) = size;
-    memcpy(packet_out.data + sizeof(uint32_t), current_data_ptr, data_sending - sizeof(uint32_t));
-
-    /* While there's data to send, send it and wait for ack */
-    while (data_remaining > 0) {
-        /* Send the current packet */
-        ret = LINK_LAYER__send(socket->link_layer, &packet_out, sizeof(packet_out.header) + data_sending);
-        if (ret != 0) {
-            LOG_ERROR("Failed to send on link layer");
-            return -1;
+    enum physical_layer_feedback feedback;
+    uint16_t first_seq = socket->send_seq;
+    uint32_t base = 0;
+    uint32_t sent_end = 0;
+
+    /* The message length is sent as uint32_t */
+    if (size > UINT32_MAX - sizeof(uint32_t)) {
+        LOG_ERROR("Message too long for the transport layer: %zu", size);
+        return -1;
+    }
+
+    uint32_t packets_count = get_packets_count(socket, (uint32_t)size);
+    bool* acked = calloc(packets_count, sizeof(bool));
+    if (acked == NULL) {
+        LOG_ERROR("Failed to allocate transport acks of %u packets", packets_count);
+        return -1;
+    }
+
+    /* While there are unacked packets, send the window and wait for a selective ack */
+    while (base < packets_count) {
+        uint32_t window_end = min(base + socket->window_size, packets_count);
+
+        /* The receiver is polled for an ack after the window's last unacked packet */
+        uint32_t last = window_end - 1;
+        while (acked[last]) {
+            last--;
+        }
+
+        /* Queue the unacked packets back to back, waiting only for the last to be sent */
+        for (uint32_t i = base; i <= last; ++i) {
+            if (acked[i]) {
+                continue;
+            }
+
+            size_t packet_size = build_packet(socket, &packet_out, first_seq, i, data, (uint32_t)size);
+            if (i == last) {
+                packet_out.header.flags |= TRANSPORT_FLAG_POLL;
+                ret = LINK_LAYER__send(socket->link_layer, &packet_out, packet_size);
+            } else {
+                ret = LINK_LAYER__send_async(socket->link_layer, &packet_out, packet_size);
+            }
+            if (ret != 0) {
+                LOG_ERROR("Failed to send on link layer");
+                goto l_cleanup;
+            }
+
+            /* Packets before the furthest one sent so far are retransmissions */
+            socket->stats.packets_sent++;
+            if (i < sent_end) {
+                socket->stats.packets_retransmitted++;
+            } else {
+                sent_end = i + 1;
+            }
         }
+        socket->stats.polls_sent++;
 
-        /* Try to receive an ack */
-        recv_ret = LINK_LAYER__recv(socket->link_layer, &packet_in, sizeof(packet_in));
-        if (recv_ret == RECV_TIMEOUT_RET_CODE) {
+        /* Wait for the receiver's answer, a short ack signal if it got the whole window, or a selective ack packet */
+        ret = LINK_LAYER__recv_feedback(socket->link_layer, &feedback);
+        if (ret == 0) {
+            if (feedback == PHYSICAL_LAYER_FEEDBACK_ACK) {
+                for (uint32_t i = base; i <= last; ++i) {
+                    acked[i] = true;
+                }
+            } else {
+                LOG_INFO("Window nacked, retrying send");
+            }
+        } else if (ret == RECV_TIMEOUT_RET_CODE) {
             /* Timeout - Retransmit */
             LOG_INFO("Timed out, retrying send");
+            socket->stats.polls_unanswered++;
             continue;
-        } else if (recv_ret == RECV_OUT_OF_SYNC_RET_CODE) {
-            /* Out-of-sync - Retransmit */
-            LOG_INFO("Out of sync");
-            continue;
-        } else if (recv_ret < 0) {
-            LOG_ERROR("Failed to recv ack on transport layer");
-            return -1;
+        } else if (ret < 0) {
+            LOG_ERROR("Failed to recv feedback on transport layer");
+            goto l_cleanup;
+        } else if (receive_ack(socket, first_seq, base, window_end, acked) != 0) {
+            ret = -1;
+            goto l_cleanup;
         }
 
-        /* We managed to send the ack a packet, set the next one */
-        if (packet_in.header.seq == packet_out.header.seq) {
-            socket->seq++;
-            data_remaining -= data_sending;
-            current_data_ptr += data_sending - size_header_fix;
-            size_header_fix = 0;
-            data_sending = min(data_remaining, sizeof(packet_out.data));
-            packet_out.header.seq = socket->seq;
-            memcpy(packet_out.data, current_data_ptr, data_sending);
+        /* Slide the window over the acked packets */
+        while (base < packets_count && acked[base]) {
+            base++;
         }
+        LOG_DEBUG("Transport acked %u/%u packets", base, packets_count);
     }
 
-    return 0;
+    socket->send_seq = (uint16_t)(first_seq + packets_count);
+    socket->stats.messages_sent++;
+    ret = 0;
+
+l_cleanup:
+    free(acked);
+    return ret;
 }
 
-ssize_t TRANSPORT_LAYER__recv(audio_transport_layer_socket_t *socket, void *data, size_t size) {
-    int ret = -1;
+/**
+ * Copies a received packet's data into its place in the message buffer.
+ *
+ * @param socket The socket, holding the state of the message being received.
+ * @param index The index of the packet in the message.
+ * @param packet The received packet.
+ * @param data_length The length of the packet's data.
+ * @param data The message buffer.
+ * @param size The size of the message buffer.
+ */
+static void store_packet(
+        audio_transport_layer_socket_t *socket, uint32_t index,
+        const struct transport_packet_s* packet, size_t data_length,
+        uint8_t* data, size_t size
+) {
+    struct transport_recv_state* state = &socket->recv_state;
+    const uint8_t* packet_data = packet->data;
+    size_t offset = get_packet_offset(socket, index);
+
+    /* Read the length of the message from the first packet, then any data */
+    if (index == 0) {
+        if (data_length < sizeof(uint32_t)) {
+            LOG_WARNING("Transport first packet too short: %zu", data_length);
+            return;
+        }
+        memcpy(&state->data_length, packet_data, sizeof(uint32_t));
+        state->read_data_length = true;
+        packet_data += sizeof(uint32_t);
+        data_length -= sizeof(uint32_t);
+        LOG_DEBUG("transport layer recv packet size %d", state->data_length);
+    }
+
+    /* Data beyond the user's buffer is dropped */
+    if (offset < size) {
+        memcpy(data + offset, packet_data, min(data_length, size - offset));
+    }
+}
+
+/**
+ * Answers the sender's poll, with a short ack signal if every packet up to the poll has been received,
+ * otherwise with a selective ack of the packets received so far.
+ *
+ * @param socket The socket to send the ack over.
+ * @param poll_seq The sequence number of the polling packet.
+ * @param blocking Whether to wait for the ack to be sent, otherwise it's only queued.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int send_ack(audio_transport_layer_socket_t *socket, uint16_t poll_seq, bool blocking) {
+    if (seq_distance(poll_seq, socket->recv_base) < 0) {
+        return blocking ?
+                LINK_LAYER__send_feedback(socket->link_layer, PHYSICAL_LAYER_FEEDBACK_ACK) :
+                LINK_LAYER__send_feedback_async(socket->link_layer, PHYSICAL_LAYER_FEEDBACK_ACK);
+    }
+
+    struct transport_packet_header_s header;
+    struct transport_ack_s ack;
+    uint8_t packet_out[sizeof(header) + sizeof(ack)];
+
+    header.seq = socket->recv_base;
+    header.flags = TRANSPORT_FLAG_ACK;
+    ack.base = socket->recv_base;
+    ack.bitmap = socket->recv_bitmap;
+    memcpy(packet_out, &header, sizeof(header));
+    memcpy(packet_out + sizeof(header), &ack, sizeof(ack));
+
+    return blocking ?
+            LINK_LAYER__send(socket->link_layer, packet_out, sizeof(packet_out)) :
+            LINK_LAYER__send_async(socket->link_layer, packet_out, sizeof(packet_out));
+}
+
+/**
+ * Receives packets into the message currently being received until the message is complete,
+ * packets may arrive out of order and are placed directly in the buffer, the sender's polls are answered with selective acks.
+ * The receive state is kept only when returning `RECV_WOULD_BLOCK_RET_CODE`, otherwise the next call starts a new message.
+ *
+ * @param socket The socket to receive the message over.
+ * @param data The buffer to save the incoming message into, the same buffer must be given until the message completes.
+ * @param size The size of the buffer.
+ * @param blocking Whether to wait for each packet and ack, otherwise acks are queued without waiting.
+ * @return The length of the message on success, negative value on failure.
+ */
+static ssize_t recv_packets(audio_transport_layer_socket_t *socket, void *data, size_t size, bool blocking) {
+    struct transport_recv_state* state = &socket->recv_state;
     ssize_t recv_ret = -1;
-    struct transport_packet_header_s packet_out;
     struct transport_packet_s packet_in;
-    size_t index = 0;
-    uint32_t data_length = 0;
-    bool read_data_length = false;
 
-    while (index < size) {
+    while (!state->read_data_length ||
+            seq_distance(socket->recv_base, state->first_seq) < (int32_t)get_packets_count(socket, state->data_length)) {
         /* Try to receive a packet */
-        recv_ret = LINK_LAYER__recv(socket->link_layer, &packet_in, sizeof(packet_in));
-        if (recv_ret == RECV_TIMEOUT_RET_CODE) {
+        recv_ret = blocking ?
+                LINK_LAYER__recv(socket->link_layer, &packet_in, sizeof(packet_in)) :
+                LINK_LAYER__recv_nonblocking(socket->link_layer, &packet_in, sizeof(packet_in));
+        if (recv_ret == RECV_WOULD_BLOCK_RET_CODE) {
+            /* Keep the state, the message continues on the next call. */
+            return recv_ret;
+        } else if (recv_ret == RECV_TIMEOUT_RET_CODE) {
             /* Timeout - retry */
             LOG_WARNING("Timed out on transport recv");
             continue;
-        } else if (recv_ret == RECV_OUT_OF_SYNC_RET_CODE) {
-            /* Out-of-sync - retry */
+        } else if (recv_ret == RECV_OUT_OF_SYNC_RET_CODE || recv_ret == RECV_UNCORRECTABLE_RET_CODE ||
+                recv_ret == RECV_CRC_MISMATCH_RET_CODE) {
+            /* Out-of-sync or corrupted - retry, the sender retransmits what we don't ack */
             LOG_INFO("Out of sync");
             continue;
         } else if (recv_ret < 0) {
             LOG_ERROR("Failed to recv on transport layer: %zd", recv_ret);
-            return recv_ret;
+            goto l_cleanup;
+        } else if ((size_t)recv_ret < sizeof(packet_in.header) || (packet_in.header.flags & TRANSPORT_FLAG_ACK)) {
+            LOG_WARNING("Unexpected transport packet of %zd bytes", recv_ret);
+            continue;
         }
 
-        if (packet_in.header.seq < socket->seq) {
-            /* Drop the sequence down to re-ack */
-            socket->seq--;
-        } else if (packet_in.header.seq > socket->seq) {
-            /* Somehow the sequence number has advanced too much, cannot recover from this easily */
-            LOG_WARNING("Bad seq %d", packet_in.header.seq);
-            return -1;
-        } else {
-            if (!read_data_length) {
-                /* We havn't read the length of the data yet (from the first packet), read it first then any data */
-                data_length = *(uint32_t*)packet_in.data;
-                read_data_length = true;
-                memcpy(((uint8_t*)data) + index, packet_in.data + sizeof(uint32_t), min(recv_ret-sizeof(uint32_t), size - index));
-                index += min(recv_ret - sizeof(uint32_t), size - index);
-                LOG_DEBUG("transport layer recv packet size %d", data_length);
-            } else {
-                /* Read incoming data to the buffer */
-                memcpy(((uint8_t*)data) + index, packet_in.data, min(recv_ret, size - index));
-                index += min(recv_ret, size - index);
-            }
-        }
+        /* Packets before the base were already received (our ack was lost), only the ack is resent */
+        int32_t distance = seq_distance(packet_in.header.seq, socket->recv_base);
+        if (distance >= TRANSPORT_LAYER_MAX_WINDOW_SIZE) {
+            LOG_WARNING("Bad seq %u, expected up to %u", packet_in.header.seq, socket->recv_base);
+        } else if (distance >= 0 && !((socket->recv_bitmap >> distance) & 1)) {
+            uint32_t index = (uint32_t)seq_distance(packet_in.header.seq, state->first_seq);
+            store_packet(socket, index, &packet_in, recv_ret - sizeof(packet_in.header), data, size);
+            socket->recv_bitmap |= (uint32_t)1 << distance;
+            socket->stats.packets_received++;
 
-        /* Ack the incoming packet */
-        packet_out.seq = packet_in.header.seq;
-        socket->seq++;
-        ret = LINK_LAYER__send(socket->link_layer, &packet_out, sizeof(packet_out));
-        if (ret != 0) {
-            LOG_ERROR("Failed to send transport layer ack");
-            return -1;
+            /* Slide the base over the packets received in order */
+            while (socket->recv_bitmap & 1) {
+                socket->recv_bitmap >>= 1;
+                socket->recv_base++;
+            }
+        } else {
+            socket->stats.duplicate_packets_received++;
         }
 
-        /* Finished when we received all the data expected from the data_length */
-        if (read_data_length && index >= data_length) {
-            break;
+        /* Answer the sender's poll, a non-blocking receive only queues the ack. */
+        if (packet_in.header.flags & TRANSPORT_FLAG_POLL) {
+            if (send_ack(socket, packet_in.header.seq, blocking) != 0) {
+                LOG_ERROR("Failed to send transport layer ack");
+                recv_ret = -1;
+                goto l_cleanup;
+            }
+            socket->stats.acks_sent++;
         }
     }
 
-    return (ssize_t)index;
+    recv_ret = (ssize_t)min(state->data_length, size);
+    socket->stats.messages_received++;
+
+l_cleanup:
+    /* The message is done (or failed), the next call starts a new one from the next expected packet. */
+    memset(state, 0, sizeof(*state));
+    state->first_seq = socket->recv_base;
+    return recv_ret;
+}
+
+ssize_t TRANSPORT_LAYER__recv(audio_transport_layer_socket_t *socket, void *data, size_t size) {
+    return recv_packets(socket, data, size, true);
+}
+
+ssize_t TRANSPORT_LAYER__recv_nonblocking(audio_transport_layer_socket_t *socket, void *data, size_t size) {
+    return recv_packets(socket, data, size, false);
+}
+
+int TRANSPORT_LAYER__get_ready_fd(audio_transport_layer_socket_t *socket) {
+    return LINK_LAYER__get_ready_fd(socket->link_layer);
+}
+
+void TRANSPORT_LAYER__get_stats(audio_transport_layer_socket_t *socket, struct transport_layer_stats* stats,
+                                struct link_layer_stats* link_stats, struct physical_layer_stats* physical_stats) {
+    *stats = socket->stats;
+    LINK_LAYER__get_stats(socket->link_layer, link_stats, physical_stats);
 }
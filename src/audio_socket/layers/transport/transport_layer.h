@@ -7,17 +7,86 @@
 #define AUDIONET_TRANSPORT_LAYER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <sys/types.h>
+#include "audio_socket/layers/physical/physical_layer.h"
+#include "audio_socket/layers/link/link_layer.h"
+
+/** The maximal send window, bounded by the size of the selective ack's bitmap. */
+#define TRANSPORT_LAYER_MAX_WINDOW_SIZE (32)
+
+/** The default amount of packets sent before waiting for an ack. */
+#define TRANSPORT_LAYER_DEFAULT_WINDOW_SIZE (8)
 
 /** The transport layer socket type. */
 typedef struct audio_transport_layer_socket_s audio_transport_layer_socket_t;
 
+/**
+ * The transport layer configuration, chosen at socket initialization.
+ */
+struct transport_layer_config {
+    /**
+     * The amount of unacked packets sent back to back before polling the receiver for a selective ack
+     * (1 - 'TRANSPORT_LAYER_MAX_WINDOW_SIZE'), a window of 1 is stop-and-wait.
+     */
+    uint32_t window_size;
+};
+
+/**
+ * Runtime counters of the transport layer.
+ */
+struct transport_layer_stats {
+    /** The amount of messages sent and fully acked. */
+    uint64_t messages_sent;
+
+    /** The amount of packets sent, including retransmissions. */
+    uint64_t packets_sent;
+
+    /** The amount of packets sent again since they weren't acked. */
+    uint64_t packets_retransmitted;
+
+    /** The amount of windows the receiver was polled for an ack after. */
+    uint64_t polls_sent;
+
+    /** The amount of polls answered with a selective ack packet (some of the window was missed). */
+    uint64_t selective_acks_received;
+
+    /** The amount of polls left unanswered (timed out, or the ack was corrupted). */
+    uint64_t polls_unanswered;
+
+    /** The amount of messages received. */
+    uint64_t messages_received;
+
+    /** The amount of new packets received. */
+    uint64_t packets_received;
+
+    /** The amount of packets received again (their ack was lost). */
+    uint64_t duplicate_packets_received;
+
+    /** The amount of polls answered. */
+    uint64_t acks_sent;
+};
+
+/**
+ * Fills a configuration with the default transport layer settings.
+ *
+ * @param config The configuration to fill.
+ */
+void TRANSPORT_LAYER__get_default_config(struct transport_layer_config* config);
+
 /**
  * Allocates and initializes a new transport layer socket.
  *
+ * @param physical_config The configuration of the underlying physical layer, or NULL for the defaults.
+ * @param link_config The configuration of the underlying link layer, or NULL for the defaults.
+ * @param config The configuration of the transport layer, or NULL for the defaults.
  * @return The initialized socket, or NULL on failure.
  */
-audio_transport_layer_socket_t* TRANSPORT_LAYER__initialize();
+audio_transport_layer_socket_t* TRANSPORT_LAYER__initialize(
+        const struct physical_layer_config* physical_config,
+        const struct link_layer_config* link_config,
+        const struct transport_layer_config* config
+);
 
 /**
  * Frees a transport layer socket.
@@ -27,8 +96,9 @@ audio_transport_layer_socket_t* TRANSPORT_LAYER__initialize();
 void TRANSPORT_LAYER__free(audio_transport_layer_socket_t *socket);
 
 /**
- * Sends a packet over the transport layer socket,
- * success is returned only after acknowledgment is received.
+ * Sends a message over the transport layer socket,
+ * success is returned only after acknowledgment of every packet is received.
+ * The message's packets are sent a window at a time, only the packets the receiver misses are retransmitted.
  *
  * @param socket The socket to send data over.
  * @param data The data to send.
@@ -47,4 +117,36 @@ int TRANSPORT_LAYER__send(audio_transport_layer_socket_t* socket, void* data, si
  */
 ssize_t TRANSPORT_LAYER__recv(audio_transport_layer_socket_t* socket, void* data, size_t size);
 
+/**
+ * Receives the packets that have already arrived into the current message, without waiting.
+ * Each packet is acked by queueing the ack to be sent, without waiting for it to be sent.
+ * A message may take multiple calls to complete, the same buffer must be given to each call until it does.
+ *
+ * @param socket The socket to receive the message over.
+ * @param data The buffer to save the incoming message into.
+ * @param size The size of the buffer.
+ * @return The length of the message on success, `RECV_WOULD_BLOCK_RET_CODE` if the message isn't complete yet,
+ *         another negative value on failure.
+ */
+ssize_t TRANSPORT_LAYER__recv_nonblocking(audio_transport_layer_socket_t* socket, void* data, size_t size);
+
+/**
+ * Gets the socket's readiness descriptor, readable while there are received frames waiting to be handled.
+ *
+ * @param socket The socket.
+ * @return The readiness file descriptor.
+ */
+int TRANSPORT_LAYER__get_ready_fd(audio_transport_layer_socket_t* socket);
+
+/**
+ * Gets a snapshot of the socket's counters, along with those of the underlying layers.
+ *
+ * @param socket The socket to query.
+ * @param stats Returns the transport layer counters.
+ * @param link_stats Returns the link layer counters.
+ * @param physical_stats Returns the physical layer counters.
+ */
+void TRANSPORT_LAYER__get_stats(audio_transport_layer_socket_t* socket, struct transport_layer_stats* stats,
+                                struct link_layer_stats* link_stats, struct physical_layer_stats* physical_stats);
+
 #endif //AUDIONET_TRANSPORT_LAYER_H
@@ -0,0 +1,913 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <malloc.h>
+#include <math.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "utils/logger.h"
+#include "utils/utils.h"
+#include "fft/fft.h"
+#include "wav/wav_file.h"
+#include "audio/audio.h"
+#include "audio/internal/multi_waveform_data_source.h"
+#include "audio_socket/layers/physical/audio_encoding.h"
+#include "audio_socket/layers/physical/physical_layer.h"
+#include "audio_socket/layers/link/link_layer.h"
+
+/** The argument for choosing the baseline file to compare against */
+#define BASELINE_ARGUMENT "--baseline"
+
+/** The argument for choosing the allowed slowdown against the baseline */
+#define TOLERANCE_ARGUMENT "--tolerance"
+
+/** The argument for choosing which benchmarks run */
+#define FILTER_ARGUMENT "--filter"
+
+/** The usage string of the program */
+#define USAGE "AudioBench [" BASELINE_ARGUMENT " <path>] [" TOLERANCE_ARGUMENT " <percent>] [" FILTER_ARGUMENT " <prefix>]"
+
+/** The default allowed slowdown against the baseline, in percent. */
+#define DEFAULT_TOLERANCE_PERCENT (10)
+
+/** The longest benchmark name. */
+#define BENCHMARK_NAME_SIZE (64)
+
+/** The FFT sizes benchmarked, the analysis window and it's decimated sizes, and a power of two for reference. */
+static const uint32_t FFT_SIZES[] = {450, 900, 1800, 3600, 4096};
+
+/** The amount of FFTs timed per size. */
+#define FFT_ITERATIONS (2000)
+
+/** The amount of values encoded or decoded per timed run. */
+#define ENCODING_ITERATIONS (200000)
+
+/** The amount of distinct values decoded, each from it's own spectrum. */
+#define DECODED_VALUES_COUNT (16)
+
+/** The length of the synthesized symbols read per iteration (a default length symbol). */
+#define WAVEFORM_LENGTH_FRAMES (SAMPLE_RATE_48000 / 1000 * PHYSICAL_LAYER_DEFAULT_SYMBOL_LENGTH_MILLISECONDS)
+
+/** The amount of symbols synthesized per timed run. */
+#define WAVEFORM_ITERATIONS (2000)
+
+/** The amount of choose calculations per timed run. */
+#define COMB_ITERATIONS (1000000)
+
+/** The amount of frames in the recording decoded by the physical layer benchmark. */
+#define DECODED_FRAMES_COUNT (10)
+
+/** The amount of times the recording is decoded per timed run. */
+#define DECODE_ITERATIONS (10)
+
+/** The amount of samples decoded at once, as a sound card's period (10 milliseconds). */
+#define DECODE_BLOCK_SIZE (480)
+
+/** The link layer parity sizes benchmarked, without and with error correction. */
+static const uint32_t LINK_PARITY_BYTES[] = {0, 16};
+
+/** The amount of link layer packets sent per timed run. */
+#define LINK_SEND_ITERATIONS (10)
+
+/** How many times faster than real time the rendered audio is streamed, the playback isn't timed. */
+#define RENDER_SPEED (1000)
+
+/** The link layer parity of the received packet, a full packet with it spans the most frames. */
+#define LINK_RECV_PARITY_BYTES (16)
+
+/** The amount of frames of a full link layer packet with `LINK_RECV_PARITY_BYTES` parity. */
+#define LINK_RECV_FRAMES_COUNT (256)
+
+/** How many times faster than real time the recorded packet is replayed, the decoding has to keep up with it. */
+#define REPLAY_SPEED (50)
+
+/** How long to wait for the next frame before the replayed packet is given up on. */
+#define REPLAY_IDLE_MILLISECONDS (2000)
+
+/**
+ * A benchmark result read from the baseline file.
+ */
+struct baseline_entry {
+    /** The benchmark's name. */
+    char name[BENCHMARK_NAME_SIZE];
+
+    /** The benchmark's time per iteration, in nanoseconds. */
+    double nanoseconds;
+};
+
+/**
+ * The benchmarks run context.
+ */
+struct bench_context {
+    /** Only the benchmarks starting with the filter run, or NULL to run all. */
+    const char* filter;
+
+    /** The baseline results, or NULL if not comparing. */
+    struct baseline_entry* baseline;
+
+    /** The amount of baseline results. */
+    size_t baseline_count;
+
+    /** The allowed slowdown against the baseline, as a fraction. */
+    double tolerance;
+
+    /** The amount of benchmarks run. */
+    uint32_t benchmarks;
+
+    /** The amount of benchmarks that failed to run. */
+    uint32_t failures;
+
+    /** The amount of benchmarks slower than their baseline by more than the tolerance. */
+    uint32_t regressions;
+};
+
+/** Sink for the benchmarked results, so the compiler can't drop the timed calls. */
+static volatile uint64_t g_sink;
+
+/**
+ * Gets the CPU time consumed by the calling thread.
+ * Benchmarks are timed by CPU time, so time spent waiting (e.g for the playback of sent frames) isn't counted.
+ *
+ * @return The thread's CPU time in seconds.
+ */
+static double thread_cpu_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * Gets the CPU time consumed by all of the process's threads.
+ * Used where the timed work is done by the socket's own threads (e.g the decoding of received frames).
+ *
+ * @return The process's CPU time in seconds.
+ */
+static double process_cpu_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * Checks whether a benchmark is selected by the filter.
+ *
+ * @param context The run context.
+ * @param name The benchmark's name.
+ * @return Whether the benchmark should run.
+ */
+static bool is_selected(const struct bench_context* context, const char* name) {
+    return context->filter == NULL || strncmp(name, context->filter, strlen(context->filter)) == 0;
+}
+
+/**
+ * Finds a benchmark's baseline result.
+ *
+ * @param context The run context.
+ * @param name The benchmark's name.
+ * @return The baseline result, or NULL if there's none.
+ */
+static const struct baseline_entry* find_baseline(const struct bench_context* context, const char* name) {
+    for (size_t i = 0; i < context->baseline_count; ++i) {
+        if (strcmp(context->baseline[i].name, name) == 0) {
+            return &context->baseline[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Prints a benchmark's result as a single line JSON object, compared to it's baseline if there's one.
+ * The lines without a baseline comparison can be saved as a baseline file.
+ *
+ * @param context The run context.
+ * @param name The benchmark's name.
+ * @param iterations The amount of timed iterations.
+ * @param seconds The CPU time of all the iterations, negative if the benchmark failed.
+ */
+static void report(struct bench_context* context, const char* name, uint64_t iterations, double seconds) {
+    context->benchmarks++;
+    if (seconds < 0) {
+        context->failures++;
+        printf("{\"benchmark\":\"%s\",\"failed\":true}\n", name);
+        return;
+    }
+
+    double nanoseconds = seconds * 1e9 / (double)iterations;
+    printf("{\"benchmark\":\"%s\",\"iterations\":%" PRIu64 ",\"nanoseconds_per_iteration\":%.1f",
+           name, iterations, nanoseconds);
+
+    const struct baseline_entry* baseline = find_baseline(context, name);
+    if (baseline != NULL && baseline->nanoseconds > 0) {
+        double change = nanoseconds / baseline->nanoseconds - 1;
+        bool is_regressed = change > context->tolerance;
+        context->regressions += is_regressed;
+        printf(",\"baseline_nanoseconds_per_iteration\":%.1f,\"change\":%.4f,\"regressed\":%s",
+               baseline->nanoseconds, change, is_regressed ? "true" : "false");
+    }
+    printf("}\n");
+    fflush(stdout);
+}
+
+/**
+ * Reads the baseline results, the result lines of a previous run.
+ *
+ * @param context The run context, holding the read results.
+ * @param path The baseline file.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int read_baseline(struct bench_context* context, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        LOG_ERROR("Failed to open baseline %s", path);
+        return -1;
+    }
+
+    /* Lines that aren't results (e.g the summary or failed benchmarks) are skipped. */
+    char line[512];
+    struct baseline_entry entry;
+    uint64_t iterations;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "{\"benchmark\":\"%63[^\"]\",\"iterations\":%" SCNu64 ",\"nanoseconds_per_iteration\":%lf",
+                   entry.name, &iterations, &entry.nanoseconds) != 3) {
+            continue;
+        }
+
+        struct baseline_entry* baseline = realloc(context->baseline,
+                                                  (context->baseline_count + 1) * sizeof(struct baseline_entry));
+        if (baseline == NULL) {
+            LOG_ERROR("Failed to allocate baseline");
+            fclose(file);
+            return -1;
+        }
+        context->baseline = baseline;
+        context->baseline[context->baseline_count++] = entry;
+    }
+
+    fclose(file);
+    return 0;
+}
+
+/**
+ * Initializes the encoding of the default channel plan.
+ *
+ * @return The encoding, or NULL on failure.
+ */
+static audio_encoding_t* initialize_default_encoding(void) {
+    return AUDIO_ENCODING__initialize(PHYSICAL_LAYER_DEFAULT_BASE_FREQUENCY, PHYSICAL_LAYER_DEFAULT_BAND_WIDTH,
+                                      PHYSICAL_LAYER_DEFAULT_CHANNELS_COUNT,
+                                      PHYSICAL_LAYER_DEFAULT_CONCURRENT_CHANNELS_COUNT);
+}
+
+/**
+ * Synthesizes the samples of a symbol, the sum of it's channels' carriers.
+ *
+ * @param encoding The encoding.
+ * @param value The symbol's value.
+ * @param samples Returns the samples.
+ * @param samples_count The amount of samples.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int synthesize_symbol(audio_encoding_t* encoding, uint64_t value, float* samples, size_t samples_count) {
+    uint32_t frequencies[PHYSICAL_LAYER_DEFAULT_CONCURRENT_CHANNELS_COUNT];
+    if (AUDIO_ENCODING__encode_frequencies(encoding, value, PHYSICAL_LAYER_DEFAULT_CONCURRENT_CHANNELS_COUNT,
+                                           frequencies) != 0) {
+        return -1;
+    }
+
+    for (size_t n = 0; n < samples_count; ++n) {
+        float sample = 0;
+        for (int i = 0; i < PHYSICAL_LAYER_DEFAULT_CONCURRENT_CHANNELS_COUNT; ++i) {
+            sample += sinf(2 * (float)M_PI * (float)frequencies[i] * (float)n / SAMPLE_RATE_48000);
+        }
+        samples[n] = sample / PHYSICAL_LAYER_DEFAULT_CONCURRENT_CHANNELS_COUNT;
+    }
+
+    return 0;
+}
+
+/**
+ * Benchmarks `FFT__calculate` of a symbol, per window size.
+ * The plans are measured (as with a warm FFTW wisdom cache), so they're the ones the decoder runs.
+ *
+ * @param context The run context.
+ */
+static void bench_fft(struct bench_context* context) {
+    for (size_t i = 0; i < sizeof(FFT_SIZES) / sizeof(FFT_SIZES[0]); ++i) {
+        char name[BENCHMARK_NAME_SIZE];
+        snprintf(name, sizeof(name), "fft_calculate/%u", FFT_SIZES[i]);
+        if (!is_selected(context, name)) {
+            continue;
+        }
+
+        double seconds = -1;
+        audio_encoding_t* encoding = initialize_default_encoding();
+        fft_t* fft = FFT__initialize((int)FFT_SIZES[i], SAMPLE_RATE_48000, NULL);
+        float* samples = malloc(FFT_SIZES[i] * sizeof(float));
+        if (encoding == NULL || fft == NULL || samples == NULL ||
+            synthesize_symbol(encoding, 0, samples, FFT_SIZES[i]) != 0) {
+            LOG_ERROR("Failed to prepare %s", name);
+            goto l_next;
+        }
+
+        double start = thread_cpu_seconds();
+        for (uint64_t iteration = 0; iteration < FFT_ITERATIONS; ++iteration) {
+            struct frequency_and_magnitude* frequencies;
+            size_t frequencies_count;
+            if (FFT__calculate(fft, samples, FFT_SIZES[i], &frequencies, &frequencies_count) != 0) {
+                LOG_ERROR("Failed to calculate FFT");
+                goto l_next;
+            }
+            g_sink += frequencies_count;
+            free(frequencies);
+        }
+        seconds = thread_cpu_seconds() - start;
+
+l_next:
+        report(context, name, FFT_ITERATIONS, seconds);
+        free(samples);
+        if (fft != NULL) {
+            FFT__free(fft);
+        }
+        if (encoding != NULL) {
+            AUDIO_ENCODING__free(encoding);
+        }
+    }
+}
+
+/**
+ * Benchmarks `AUDIO_ENCODING__encode_frequencies` over every value of the default channel plan.
+ *
+ * @param context The run context.
+ */
+static void bench_encode(struct bench_context* context) {
+    const char* name = "encode_frequencies";
+    if (!is_selected(context, name)) {
+        return;
+    }
+
+    double seconds = -1;
+    audio_encoding_t* encoding = initialize_default_encoding();
+    if (encoding == NULL) {
+        LOG_ERROR("Failed to prepare %s", name);
+        goto l_cleanup;
+    }
+
+    uint64_t values_count = AUDIO_ENCODING__get_values_count(encoding);
+    uint32_t frequencies[PHYSICAL_LAYER_DEFAULT_CONCURRENT_CHANNELS_COUNT];
+    double start = thread_cpu_seconds();
+    for (uint64_t iteration = 0; iteration < ENCODING_ITERATIONS; ++iteration) {
+        if (AUDIO_ENCODING__encode_frequencies(encoding, iteration % values_count,
+                                               PHYSICAL_LAYER_DEFAULT_CONCURRENT_CHANNELS_COUNT, frequencies) != 0) {
+            LOG_ERROR("Failed to encode frequencies");
+            goto l_cleanup;
+        }
+        g_sink += frequencies[0];
+    }
+    seconds = thread_cpu_seconds() - start;
+
+l_cleanup:
+    report(context, name, ENCODING_ITERATIONS, seconds);
+    if (encoding != NULL) {
+        AUDIO_ENCODING__free(encoding);
+    }
+}
+
+/**
+ * Benchmarks `AUDIO_ENCODING__decode_frequencies` of analysis window spectra, each decoded value is verified.
+ *
+ * @param context The run context.
+ */
+static void bench_decode(struct bench_context* context) {
+    const char* name = "decode_frequencies";
+    if (!is_selected(context, name)) {
+        return;
+    }
+
+    double seconds = -1;
+    struct frequency_and_magnitude* spectra[DECODED_VALUES_COUNT] = {NULL};
+    size_t spectrum_length = 0;
+    audio_encoding_t* encoding = initialize_default_encoding();
+    fft_t* fft = FFT__initialize(SAMPLE_RATE_48000_SAMPLE_SIZE, SAMPLE_RATE_48000, NULL);
+    float* samples = malloc(SAMPLE_RATE_48000_SAMPLE_SIZE * sizeof(float));
+    if (encoding == NULL || fft == NULL || samples == NULL) {
+        LOG_ERROR("Failed to prepare %s", name);
+        goto l_cleanup;
+    }
+
+    /* The spectra of analysis windows of symbols spread over the values. */
+    uint64_t values_step = AUDIO_ENCODING__get_values_count(encoding) / DECODED_VALUES_COUNT;
+    for (uint64_t i = 0; i < DECODED_VALUES_COUNT; ++i) {
+        if (synthesize_symbol(encoding, i * values_step, samples, SAMPLE_RATE_48000_SAMPLE_SIZE) != 0 ||
+            FFT__calculate(fft, samples, SAMPLE_RATE_48000_SAMPLE_SIZE, &spectra[i], &spectrum_length) != 0) {
+            LOG_ERROR("Failed to prepare %s", name);
+            goto l_cleanup;
+        }
+    }
+
+    double start = thread_cpu_seconds();
+    for (uint64_t iteration = 0; iteration < ENCODING_ITERATIONS; ++iteration) {
+        uint64_t index = iteration % DECODED_VALUES_COUNT;
+        uint64_t value;
+        if (AUDIO_ENCODING__decode_frequencies(encoding, &value, spectrum_length, spectra[index]) != 0 ||
+            value != index * values_step) {
+            LOG_ERROR("Failed to decode value %" PRIu64, index * values_step);
+            goto l_cleanup;
+        }
+        g_sink += value;
+    }
+    seconds = thread_cpu_seconds() - start;
+
+l_cleanup:
+    report(context, name, ENCODING_ITERATIONS, seconds);
+    for (int i = 0; i < DECODED_VALUES_COUNT; ++i) {
+        free(spectra[i]);
+    }
+    free(samples);
+    if (fft != NULL) {
+        FFT__free(fft);
+    }
+    if (encoding != NULL) {
+        AUDIO_ENCODING__free(encoding);
+    }
+}
+
+/**
+ * Benchmarks reading a whole symbol from a multi waveform data source (the synthesized playback of a symbol).
+ *
+ * @param context The run context.
+ */
+static void bench_multi_waveform(struct bench_context* context) {
+    const char* name = "multi_waveform_read";
+    if (!is_selected(context, name)) {
+        return;
+    }
+
+    double seconds = -1;
+    struct multi_waveform_data_source* source = NULL;
+    audio_encoding_t* encoding = initialize_default_encoding();
+    float* samples = malloc(WAVEFORM_LENGTH_FRAMES * sizeof(float));
+    uint32_t frequencies[PHYSICAL_LAYER_DEFAULT_CONCURRENT_CHANNELS_COUNT];
+    if (encoding == NULL || samples == NULL ||
+        AUDIO_ENCODING__encode_frequencies(encoding, 0, PHYSICAL_LAYER_DEFAULT_CONCURRENT_CHANNELS_COUNT,
+                                           frequencies) != 0 ||
+        multi_waveform_data_source_init(&source, ma_format_f32, 1, SAMPLE_RATE_48000, frequencies,
+                                        PHYSICAL_LAYER_DEFAULT_CONCURRENT_CHANNELS_COUNT,
+                                        WAVEFORM_LENGTH_FRAMES) != MA_SUCCESS) {
+        LOG_ERROR("Failed to prepare %s", name);
+        goto l_cleanup;
+    }
+
+    double start = thread_cpu_seconds();
+    for (uint64_t iteration = 0; iteration < WAVEFORM_ITERATIONS; ++iteration) {
+        ma_uint64 frames_read = 0;
+        if (ma_data_source_seek_to_pcm_frame(source, 0) != MA_SUCCESS ||
+            ma_data_source_read_pcm_frames(source, samples, WAVEFORM_LENGTH_FRAMES, &frames_read) != MA_SUCCESS) {
+            LOG_ERROR("Failed to read multi waveform");
+            goto l_cleanup;
+        }
+        g_sink += frames_read;
+    }
+    seconds = thread_cpu_seconds() - start;
+
+l_cleanup:
+    report(context, name, WAVEFORM_ITERATIONS, seconds);
+    if (source != NULL) {
+        multi_waveform_data_source_uninit(source);
+    }
+    free(samples);
+    if (encoding != NULL) {
+        AUDIO_ENCODING__free(encoding);
+    }
+}
+
+/**
+ * Benchmarks `comb` over the channel plans' sizes (up to 64 channels, up to 8 concurrent).
+ *
+ * @param context The run context.
+ */
+static void bench_comb(struct bench_context* context) {
+    const char* name = "comb";
+    if (!is_selected(context, name)) {
+        return;
+    }
+
+    double start = thread_cpu_seconds();
+    for (uint64_t iteration = 0; iteration < COMB_ITERATIONS; ++iteration) {
+        g_sink += comb((int)(iteration % 64) + 1, (int)(iteration % 8) + 1);
+    }
+    report(context, name, COMB_ITERATIONS, thread_cpu_seconds() - start);
+}
+
+/**
+ * Renders the playback of physical layer frames into a recording, through the WAV file backend.
+ *
+ * @param samples Returns the recording, freed by the caller.
+ * @param samples_count Returns the amount of samples.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int render_frames(float** samples, size_t* samples_count) {
+    int ret = -1;
+    audio_physical_layer_socket_t* socket = NULL;
+    wav_reader_t* reader = NULL;
+    *samples = NULL;
+
+    char path[] = "/tmp/audiobench-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create temporary recording");
+        return -1;
+    }
+    close(fd);
+
+    /* Play the frames into the WAV file. */
+    struct audio_wav_config wav_config = {
+        .sample_rate = SAMPLE_RATE_48000, .capture_path = NULL, .playback_path = path,
+        .speed = RENDER_SPEED, .block_size = DECODE_BLOCK_SIZE
+    };
+    struct physical_layer_config config;
+    PHYSICAL_LAYER__get_default_config(&config);
+    config.audio_wav = &wav_config;
+    socket = PHYSICAL_LAYER__initialize(&config);
+    if (socket == NULL) {
+        LOG_ERROR("Failed to initialize rendering socket");
+        goto l_cleanup;
+    }
+
+    uint8_t frame[PHYSICAL_LAYER_MTU];
+    for (int i = 0; i < DECODED_FRAMES_COUNT; ++i) {
+        for (size_t j = 0; j < sizeof(frame); ++j) {
+            frame[j] = (uint8_t)(i * 31 + j * 7);
+        }
+        if (PHYSICAL_LAYER__send(socket, frame, sizeof(frame)) != 0) {
+            LOG_ERROR("Failed to render frame");
+            goto l_cleanup;
+        }
+    }
+
+    /* Completes the WAV file. */
+    PHYSICAL_LAYER__free(socket);
+    socket = NULL;
+
+    /* Read the recording back. */
+    reader = WAV_READER__initialize(path);
+    if (reader == NULL) {
+        LOG_ERROR("Failed to open rendered recording");
+        goto l_cleanup;
+    }
+    *samples_count = WAV_READER__get_samples_count(reader);
+    *samples = malloc(*samples_count * sizeof(float));
+    if (*samples == NULL || WAV_READER__read(reader, *samples, *samples_count) != *samples_count) {
+        LOG_ERROR("Failed to read rendered recording");
+        free(*samples);
+        *samples = NULL;
+        goto l_cleanup;
+    }
+
+    ret = 0;
+
+l_cleanup:
+    if (socket != NULL) {
+        PHYSICAL_LAYER__free(socket);
+    }
+    WAV_READER__free(reader);
+    unlink(path);
+    return ret;
+}
+
+/**
+ * Benchmarks the physical layer's receive path (the framing state machine fed by the recording callback),
+ * decoding a recording of frames a sound card period at a time. Every frame must be recovered.
+ *
+ * @param context The run context.
+ */
+static void bench_physical_decode(struct bench_context* context) {
+    const char* name = "physical_decode";
+    if (!is_selected(context, name)) {
+        return;
+    }
+
+    double seconds = -1;
+    float* samples = NULL;
+    size_t samples_count;
+    audio_physical_layer_socket_t* decoder = NULL;
+    if (render_frames(&samples, &samples_count) != 0) {
+        LOG_ERROR("Failed to prepare %s", name);
+        goto l_cleanup;
+    }
+
+    /* The plan is measured, as with a warm FFTW wisdom cache. */
+    struct physical_layer_config config;
+    PHYSICAL_LAYER__get_default_config(&config);
+    config.fft_wisdom_path = NULL;
+    decoder = PHYSICAL_LAYER__initialize_decoder(&config);
+    if (decoder == NULL) {
+        LOG_ERROR("Failed to prepare %s", name);
+        goto l_cleanup;
+    }
+
+    uint8_t frame[PHYSICAL_LAYER_MTU];
+    double start = thread_cpu_seconds();
+    for (uint64_t iteration = 0; iteration < DECODE_ITERATIONS; ++iteration) {
+        for (size_t offset = 0; offset < samples_count; offset += DECODE_BLOCK_SIZE) {
+            if (PHYSICAL_LAYER__decode(decoder, samples + offset, min(DECODE_BLOCK_SIZE, samples_count - offset)) != 0) {
+                LOG_ERROR("Failed to decode recording");
+                goto l_cleanup;
+            }
+        }
+
+        /* The recording is decoded back to back, collect it's frames before the ring fills up. */
+        int frames_count = 0;
+        while (PHYSICAL_LAYER__recv_nonblocking(decoder, frame, sizeof(frame)) > 0) {
+            frames_count++;
+        }
+        if (frames_count != DECODED_FRAMES_COUNT) {
+            LOG_ERROR("Decoded %d frames of %d", frames_count, DECODED_FRAMES_COUNT);
+            goto l_cleanup;
+        }
+    }
+    seconds = thread_cpu_seconds() - start;
+
+l_cleanup:
+    report(context, name, DECODE_ITERATIONS, seconds);
+    if (decoder != NULL) {
+        PHYSICAL_LAYER__free(decoder);
+    }
+    free(samples);
+}
+
+/**
+ * Benchmarks `LINK_LAYER__send` of a full packet, with and without error correction.
+ * The playback is discarded, only the sending thread's work is timed (the stream layout, the error correction,
+ * the CRC and queueing the frames' pre-rendered symbols).
+ *
+ * @param context The run context.
+ */
+static void bench_link_send(struct bench_context* context) {
+    for (size_t i = 0; i < sizeof(LINK_PARITY_BYTES) / sizeof(LINK_PARITY_BYTES[0]); ++i) {
+        char name[BENCHMARK_NAME_SIZE];
+        snprintf(name, sizeof(name), "link_send/parity_%u", LINK_PARITY_BYTES[i]);
+        if (!is_selected(context, name)) {
+            continue;
+        }
+
+        double seconds = -1;
+        uint8_t* packet = NULL;
+        struct audio_wav_config wav_config = {
+            .sample_rate = SAMPLE_RATE_48000, .capture_path = NULL, .playback_path = NULL,
+            .speed = RENDER_SPEED, .block_size = DECODE_BLOCK_SIZE
+        };
+        struct physical_layer_config physical_config;
+        PHYSICAL_LAYER__get_default_config(&physical_config);
+        physical_config.audio_wav = &wav_config;
+        struct link_layer_config link_config;
+        LINK_LAYER__get_default_config(&link_config);
+        link_config.parity_bytes = LINK_PARITY_BYTES[i];
+        audio_link_layer_socket_t* socket = LINK_LAYER__initialize(&physical_config, &link_config);
+        if (socket == NULL) {
+            LOG_ERROR("Failed to prepare %s", name);
+            goto l_next;
+        }
+
+        size_t packet_size = LINK_LAYER__get_mtu(socket);
+        packet = malloc(packet_size);
+        if (packet == NULL) {
+            LOG_ERROR("Failed to prepare %s", name);
+            goto l_next;
+        }
+        for (size_t j = 0; j < packet_size; ++j) {
+            packet[j] = (uint8_t)(j * 13);
+        }
+
+        double start = thread_cpu_seconds();
+        for (uint64_t iteration = 0; iteration < LINK_SEND_ITERATIONS; ++iteration) {
+            if (LINK_LAYER__send(socket, packet, packet_size) != 0) {
+                LOG_ERROR("Failed to send link layer packet");
+                goto l_next;
+            }
+        }
+        seconds = thread_cpu_seconds() - start;
+
+l_next:
+        report(context, name, LINK_SEND_ITERATIONS, seconds);
+        free(packet);
+        if (socket != NULL) {
+            LINK_LAYER__free(socket);
+        }
+    }
+}
+
+/**
+ * Renders the playback of a full link layer packet into a WAV file, through the WAV file backend.
+ *
+ * @param path The WAV file to write.
+ * @param parity_bytes The link layer's parity size.
+ * @param packet Returns the sent packet, freed by the caller.
+ * @param packet_size Returns the size of the packet.
+ * @param frames_count Returns the amount of frames the packet was sent in.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int render_packet(const char* path, uint32_t parity_bytes, uint8_t** packet, size_t* packet_size,
+                         uint64_t* frames_count) {
+    int ret = -1;
+    *packet = NULL;
+
+    struct audio_wav_config wav_config = {
+        .sample_rate = SAMPLE_RATE_48000, .capture_path = NULL, .playback_path = path,
+        .speed = RENDER_SPEED, .block_size = DECODE_BLOCK_SIZE
+    };
+    struct physical_layer_config physical_config;
+    PHYSICAL_LAYER__get_default_config(&physical_config);
+    physical_config.audio_wav = &wav_config;
+    struct link_layer_config link_config;
+    LINK_LAYER__get_default_config(&link_config);
+    link_config.parity_bytes = parity_bytes;
+    audio_link_layer_socket_t* socket = LINK_LAYER__initialize(&physical_config, &link_config);
+    if (socket == NULL) {
+        LOG_ERROR("Failed to initialize rendering socket");
+        return -1;
+    }
+
+    *packet_size = LINK_LAYER__get_mtu(socket);
+    *packet = malloc(*packet_size);
+    if (*packet == NULL) {
+        LOG_ERROR("Failed to allocate packet");
+        goto l_cleanup;
+    }
+    for (size_t i = 0; i < *packet_size; ++i) {
+        (*packet)[i] = (uint8_t)(i * 13);
+    }
+    if (LINK_LAYER__send(socket, *packet, *packet_size) != 0) {
+        LOG_ERROR("Failed to render packet");
+        free(*packet);
+        *packet = NULL;
+        goto l_cleanup;
+    }
+
+    struct link_layer_stats stats;
+    struct physical_layer_stats physical_stats;
+    LINK_LAYER__get_stats(socket, &stats, &physical_stats);
+    *frames_count = stats.frames_sent;
+    ret = 0;
+
+l_cleanup:
+    /* Completes the WAV file. */
+    LINK_LAYER__free(socket);
+    return ret;
+}
+
+/**
+ * Benchmarks the link layer's receive of a full packet with error correction, replayed from a recording.
+ * The packet spans the most frames a packet can (more than a byte of sequence numbers can count), and must be
+ * received intact. The receiving is done by the socket's decoding thread, so the process's CPU time is timed.
+ *
+ * @param context The run context.
+ */
+static void bench_link_recv(struct bench_context* context) {
+    char name[BENCHMARK_NAME_SIZE];
+    snprintf(name, sizeof(name), "link_recv/parity_%d", LINK_RECV_PARITY_BYTES);
+    if (!is_selected(context, name)) {
+        return;
+    }
+
+    double seconds = -1;
+    uint8_t* packet = NULL;
+    uint8_t* received = NULL;
+    size_t packet_size;
+    uint64_t frames_count;
+    audio_link_layer_socket_t* socket = NULL;
+
+    char path[] = "/tmp/audiobench-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create temporary recording");
+        report(context, name, 1, seconds);
+        return;
+    }
+    close(fd);
+
+    if (render_packet(path, LINK_RECV_PARITY_BYTES, &packet, &packet_size, &frames_count) != 0) {
+        LOG_ERROR("Failed to prepare %s", name);
+        goto l_cleanup;
+    }
+    if (frames_count != LINK_RECV_FRAMES_COUNT) {
+        LOG_ERROR("The packet was sent in %" PRIu64 " frames, expected %d", frames_count, LINK_RECV_FRAMES_COUNT);
+        goto l_cleanup;
+    }
+    received = malloc(packet_size);
+    if (received == NULL) {
+        LOG_ERROR("Failed to prepare %s", name);
+        goto l_cleanup;
+    }
+
+    /* Replay the recording into a receiving socket. */
+    struct audio_wav_config wav_config = {
+        .sample_rate = SAMPLE_RATE_48000, .capture_path = path, .playback_path = NULL,
+        .speed = REPLAY_SPEED, .block_size = DECODE_BLOCK_SIZE
+    };
+    struct physical_layer_config physical_config;
+    PHYSICAL_LAYER__get_default_config(&physical_config);
+    physical_config.audio_wav = &wav_config;
+    struct link_layer_config link_config;
+    LINK_LAYER__get_default_config(&link_config);
+    link_config.parity_bytes = LINK_RECV_PARITY_BYTES;
+    double start = process_cpu_seconds();
+    socket = LINK_LAYER__initialize(&physical_config, &link_config);
+    if (socket == NULL) {
+        LOG_ERROR("Failed to prepare %s", name);
+        goto l_cleanup;
+    }
+
+    /* Receive the packet as it's frames arrive, a packet that doesn't complete stops them from arriving. */
+    struct pollfd ready = {.fd = LINK_LAYER__get_ready_fd(socket), .events = POLLIN};
+    ssize_t length = RECV_WOULD_BLOCK_RET_CODE;
+    while (length == RECV_WOULD_BLOCK_RET_CODE) {
+        int poll_ret = poll(&ready, 1, REPLAY_IDLE_MILLISECONDS);
+        if (poll_ret < 0 && errno == EINTR) {
+            continue;
+        } else if (poll_ret <= 0) {
+            LOG_ERROR("The replayed packet wasn't received");
+            goto l_cleanup;
+        }
+
+        length = LINK_LAYER__recv_nonblocking(socket, received, packet_size);
+    }
+    if (length != (ssize_t)packet_size || memcmp(received, packet, packet_size) != 0) {
+        LOG_ERROR("Received a packet of %zd bytes, different from the sent %zu bytes", length, packet_size);
+        goto l_cleanup;
+    }
+    seconds = process_cpu_seconds() - start;
+
+l_cleanup:
+    report(context, name, 1, seconds);
+    if (socket != NULL) {
+        LINK_LAYER__free(socket);
+    }
+    free(received);
+    free(packet);
+    unlink(path);
+}
+
+/**
+ * Main function for the benchmarks program.
+ * Times each of the DSP and encoding hot paths for a fixed amount of iterations, by the thread's CPU time,
+ * and prints a JSON object line per benchmark followed by a summary line.
+ * The output of a run can be saved as the baseline of later runs, which are then compared against it.
+ *
+ * @param argc The number of arguments to the program, an odd value.
+ * @param argv The arguments to the program (including the program name), pairs of an option and it's value.
+ * @return 0 On Success, -1 if a benchmark failed or regressed past the tolerance.
+ */
+int main(int argc, char *argv[]) {
+    int status;
+    struct bench_context context = {
+        .filter = NULL, .baseline = NULL, .baseline_count = 0, .tolerance = DEFAULT_TOLERANCE_PERCENT / 100.0,
+        .benchmarks = 0, .failures = 0, .regressions = 0
+    };
+
+    /* Parse the arguments. */
+    const char* baseline_path = NULL;
+    if (argc % 2 == 0) {
+        printf(USAGE "\n");
+        return -1;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], BASELINE_ARGUMENT) == 0) {
+            baseline_path = argv[i + 1];
+        } else if (strcmp(argv[i], TOLERANCE_ARGUMENT) == 0 && atof(argv[i + 1]) >= 0) {
+            context.tolerance = atof(argv[i + 1]) / 100;
+        } else if (strcmp(argv[i], FILTER_ARGUMENT) == 0) {
+            context.filter = argv[i + 1];
+        } else {
+            printf(USAGE "\n");
+            return -1;
+        }
+    }
+
+    if (baseline_path != NULL && read_baseline(&context, baseline_path) != 0) {
+        status = -1;
+        goto l_cleanup;
+    }
+
+    /* Run the benchmarks, from the DSP primitives up to the layers. */
+    bench_fft(&context);
+    bench_encode(&context);
+    bench_decode(&context);
+    bench_multi_waveform(&context);
+    bench_comb(&context);
+    bench_physical_decode(&context);
+    bench_link_send(&context);
+    bench_link_recv(&context);
+
+    printf("{\"benchmarks\":%u,\"failed\":%u,\"regressed\":%u}\n",
+           context.benchmarks, context.failures, context.regressions);
+    status = (context.failures == 0 && context.regressions == 0) ? 0 : -1;
+
+l_cleanup:
+    free(context.baseline);
+
+    return status;
+}
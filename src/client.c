@@ -2,15 +2,19 @@
 #include "utils/logger.h"
 #include "audio_socket/audio_socket.h"
 
+/** The argument for only warming the socket caches */
+#define WARM_CACHE_ARGUMENT "--warm-cache"
+
 /** The usage string of the program */
-#define USAGE "AudioClient <message>"
+#define USAGE "AudioClient <message> | AudioClient " WARM_CACHE_ARGUMENT
 
 /**
  * Main function for the client example program.
  * Sends the given message to the server.
  *
  * @param argc The number of arguments to the program, expected value 2.
- * @param argv The arguments to the program (including the program name), arg index 1 is the text to send.
+ * @param argv The arguments to the program (including the program name), arg index 1 is the text to send,
+ *             or `WARM_CACHE_ARGUMENT` for only preparing the socket caches ahead of later runs.
  * @return 0 On Success, -1 On Failure.
  */
 int main(int argc, char *argv[]) {
@@ -22,12 +26,17 @@ int main(int argc, char *argv[]) {
         return -1;
     }
 
+    /* Only warm the caches if requested. */
+    if (strcmp(argv[1], WARM_CACHE_ARGUMENT) == 0) {
+        return AUDIO_SOCKET__warm_cache(NULL);
+    }
+
     /* Get the input message string. */
     char* data = argv[1];
     size_t data_length = strlen(data) + 1;
 
     /* Initialize the client socket. */
-    audio_socket_t* socket = AUDIO_SOCKET__initialize();
+    audio_socket_t* socket = AUDIO_SOCKET__initialize(NULL);
     if (socket == NULL) {
         LOG_ERROR("Failed to initialize socket");
         status = -1;
@@ -0,0 +1,152 @@
+#include <pthread.h>
+#include <string.h>
+
+#include "crc32c.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define CRC32C_HARDWARE_SUPPORT
+#endif
+
+/** The reflected CRC32C (Castagnoli) polynomial. */
+#define CRC32C_POLYNOMIAL (0x82F63B78)
+
+/** The amount of bytes the table implementation handles at once. */
+#define SLICES_COUNT (8)
+
+/** Table `i` holds the checksum update of each byte value followed by `i` zero bytes. */
+static uint32_t g_slice_tables[SLICES_COUNT][256];
+
+/** The update implementation chosen for the CPU, on the first use. */
+static uint32_t (*g_update)(uint32_t crc, const uint8_t* data, size_t length) = NULL;
+
+/** Makes sure the implementation is chosen once, even if the first uses are concurrent. */
+static pthread_once_t g_initialize_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Updates an (inverted) checksum a byte at a time.
+ *
+ * @param crc The inverted checksum.
+ * @param data The data.
+ * @param length The length of the data.
+ * @return The updated inverted checksum.
+ */
+static inline uint32_t update_bytes(uint32_t crc, const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        crc = g_slice_tables[0][(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+/**
+ * Updates an (inverted) checksum eight bytes at a time, with a table lookup for each byte (slicing-by-8).
+ *
+ * @param crc The inverted checksum.
+ * @param data The data.
+ * @param length The length of the data.
+ * @return The updated inverted checksum.
+ */
+static uint32_t update_sliced(uint32_t crc, const uint8_t* data, size_t length) {
+    while (length >= SLICES_COUNT) {
+        /* The checksum is little endian, only the first four bytes mix with it. */
+        uint32_t low;
+        uint32_t high;
+        memcpy(&low, data, sizeof(low));
+        memcpy(&high, data + sizeof(low), sizeof(high));
+        low ^= crc;
+
+        crc = g_slice_tables[7][low & 0xff] ^
+              g_slice_tables[6][(low >> 8) & 0xff] ^
+              g_slice_tables[5][(low >> 16) & 0xff] ^
+              g_slice_tables[4][low >> 24] ^
+              g_slice_tables[3][high & 0xff] ^
+              g_slice_tables[2][(high >> 8) & 0xff] ^
+              g_slice_tables[1][(high >> 16) & 0xff] ^
+              g_slice_tables[0][high >> 24];
+
+        data += SLICES_COUNT;
+        length -= SLICES_COUNT;
+    }
+
+    return update_bytes(crc, data, length);
+}
+
+#ifdef CRC32C_HARDWARE_SUPPORT
+/**
+ * Updates an (inverted) checksum with the SSE4.2 `crc32` instruction.
+ *
+ * @param crc The inverted checksum.
+ * @param data The data.
+ * @param length The length of the data.
+ * @return The updated inverted checksum.
+ */
+__attribute__((target("sse4.2")))
+static uint32_t update_hardware(uint32_t crc, const uint8_t* data, size_t length) {
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+    while (length >= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += sizeof(word);
+        length -= sizeof(word);
+    }
+    crc = (uint32_t)crc64;
+#endif
+
+    while (length >= sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+        data += sizeof(word);
+        length -= sizeof(word);
+    }
+
+    while (length > 0) {
+        crc = _mm_crc32_u8(crc, *data);
+        data++;
+        length--;
+    }
+
+    return crc;
+}
+#endif
+
+/**
+ * Chooses the update implementation, building the tables if the CPU has no `crc32` instruction.
+ */
+static void initialize_crc32c(void) {
+#ifdef CRC32C_HARDWARE_SUPPORT
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        g_update = update_hardware;
+        return;
+    }
+#endif
+
+    for (uint32_t value = 0; value < 256; ++value) {
+        uint32_t crc = value;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+        }
+        g_slice_tables[0][value] = crc;
+    }
+
+    /* Each table continues the previous one's update through another zero byte. */
+    for (int slice = 1; slice < SLICES_COUNT; ++slice) {
+        for (uint32_t value = 0; value < 256; ++value) {
+            uint32_t previous = g_slice_tables[slice - 1][value];
+            g_slice_tables[slice][value] = g_slice_tables[0][previous & 0xff] ^ (previous >> 8);
+        }
+    }
+
+    g_update = update_sliced;
+}
+
+uint32_t CRC32C__update(uint32_t crc, const void* data, size_t length) {
+    pthread_once(&g_initialize_once, initialize_crc32c);
+
+    /* The checksum is kept inverted while updating, so leading zeros change it. */
+    return ~g_update(~crc, (const uint8_t*)data, length);
+}
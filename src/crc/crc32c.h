@@ -0,0 +1,19 @@
+#ifndef AUDIONET_CRC32C_H
+#define AUDIONET_CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Updates a CRC32C (Castagnoli) checksum with more data.
+ * Uses the SSE4.2 `crc32` instruction when the CPU supports it, otherwise a slicing-by-8 table implementation.
+ * Checksumming data in parts gives the same result as checksumming it at once.
+ *
+ * @param crc The checksum of the data so far, 0 to start a new checksum.
+ * @param data The data to add to the checksum.
+ * @param length The length of the data.
+ * @return The checksum of the data so far, including `data`.
+ */
+uint32_t CRC32C__update(uint32_t crc, const void* data, size_t length);
+
+#endif //AUDIONET_CRC32C_H
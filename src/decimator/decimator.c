@@ -0,0 +1,101 @@
+#include <math.h>
+#include <malloc.h>
+#include <stdlib.h>
+
+#include "decimator.h"
+#include "utils/logger.h"
+#include "utils/vector.h"
+
+/**
+ * The main lobe width factor of the Hamming window,
+ * the filter length needed for a transition width `w` is about `HAMMING_TRANSITION_FACTOR / w` (~53dB stop band).
+ */
+#define HAMMING_TRANSITION_FACTOR (3.3)
+
+struct decimator_s {
+    /** The decimation factor */
+    uint32_t factor;
+
+    /** The filter length, always a whole number of vectors */
+    size_t taps_count;
+
+    /** The filter taps in reversed order, so each output is a contiguous dot product with the input */
+    float* reversed_taps;
+};
+
+decimator_t* DECIMATOR__initialize(uint32_t factor, float transition_width) {
+    /* Validate parameters */
+    if (factor == 0 || transition_width <= 0 || transition_width >= 0.5) {
+        LOG_ERROR("Invalid decimator factor %u / transition width %f", factor, transition_width);
+        return NULL;
+    }
+
+    /* Allocate the decimator object */
+    decimator_t* decimator = malloc(sizeof(decimator_t));
+    if (decimator == NULL) {
+        LOG_ERROR("Failed to allocate decimator struct");
+        return NULL;
+    }
+
+    /* The filter length is chosen by the transition width, rounded up to whole vectors for the dot products. */
+    decimator->factor = factor;
+    decimator->taps_count = FLOAT_VECTOR_PADDED((size_t)ceil(HAMMING_TRANSITION_FACTOR / transition_width));
+
+    decimator->reversed_taps = aligned_alloc(FLOAT_VECTOR_ALIGNMENT, decimator->taps_count * sizeof(float));
+    if (decimator->reversed_taps == NULL) {
+        LOG_ERROR("Failed to allocate decimator taps");
+        free(decimator);
+        return NULL;
+    }
+
+    /* Design a Hamming windowed-sinc low-pass, cutting at the output's Nyquist frequency. */
+    double cutoff = 0.5 / factor;
+    double center = (decimator->taps_count - 1) / 2.0;
+    double sum = 0;
+    for (size_t i = 0; i < decimator->taps_count; ++i) {
+        double t = i - center;
+        double sinc = (t == 0) ? 2 * cutoff : sin(2 * M_PI * cutoff * t) / (M_PI * t);
+        double window = 0.54 - 0.46 * cos(2 * M_PI * i / (decimator->taps_count - 1));
+        decimator->reversed_taps[decimator->taps_count - 1 - i] = (float)(sinc * window);
+        sum += sinc * window;
+    }
+
+    /* Normalize the DC gain to the factor, keeping the DFT magnitude scale of the full rate window. */
+    for (size_t i = 0; i < decimator->taps_count; ++i) {
+        decimator->reversed_taps[i] = (float)(decimator->reversed_taps[i] * factor / sum);
+    }
+
+    return decimator;
+}
+
+void DECIMATOR__free(decimator_t* decimator) {
+    if (decimator == NULL) {
+        return;
+    }
+
+    free(decimator->reversed_taps);
+    free(decimator);
+}
+
+size_t DECIMATOR__get_history_size(decimator_t* decimator) {
+    return decimator->taps_count - 1;
+}
+
+void DECIMATOR__process(decimator_t* decimator, const float* input, size_t output_count, float* output) {
+    const float* taps = decimator->reversed_taps;
+
+    /* Only every `factor`th output of the filter is calculated, each as a vectorized dot product. */
+    for (size_t n = 0; n < output_count; ++n) {
+        const float* block = input + n * decimator->factor;
+        float_vector_t accumulator = {0};
+        for (size_t i = 0; i < decimator->taps_count; i += FLOAT_VECTOR_LANES) {
+            float_vector_t tap;
+            float_vector_t sample;
+            float_vector_load(&tap, &taps[i]);
+            float_vector_load(&sample, &block[i]);
+            accumulator += tap * sample;
+        }
+
+        output[n] = float_vector_sum(&accumulator);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef AUDIONET_DECIMATOR_H
+#define AUDIONET_DECIMATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The decimator interface type.
+ * A low-pass FIR filter that lowers the sample rate by an integer factor,
+ * computing only the retained output samples (the polyphase saving).
+ */
+typedef struct decimator_s decimator_t;
+
+/**
+ * Initializes a decimator, designing a windowed-sinc low-pass filter cutting at the output Nyquist frequency.
+ * The filter's gain is the decimation factor, so DFT magnitudes of the (shorter) output keep the scale of the input's.
+ *
+ * @param factor The decimation factor (output rate = input rate / factor).
+ * @param transition_width The filter's transition band width, normalized to the input rate (cycles per sample).
+ * @return The initialized decimator, or NULL on failure.
+ */
+decimator_t* DECIMATOR__initialize(uint32_t factor, float transition_width);
+
+/**
+ * Frees a decimator previously initialized with DECIMATOR__initialize.
+ *
+ * @param decimator The decimator to free.
+ */
+void DECIMATOR__free(decimator_t* decimator);
+
+/**
+ * Gets the amount of history samples the filter needs before the first input sample of a block.
+ *
+ * @param decimator The decimator.
+ * @return The history size in samples (the filter length minus one).
+ */
+size_t DECIMATOR__get_history_size(decimator_t* decimator);
+
+/**
+ * Decimates a block of samples.
+ * Each block is processed on it's own, so the input must start with `DECIMATOR__get_history_size` history samples,
+ * followed by `output_count * factor` samples that are decimated.
+ *
+ * @param decimator The decimator.
+ * @param input The input block, `history + output_count * factor` samples long.
+ * @param output_count The amount of output samples to calculate.
+ * @param output The output buffer, at least `output_count` samples long.
+ */
+void DECIMATOR__process(decimator_t* decimator, const float* input, size_t output_count, float* output);
+
+#endif //AUDIONET_DECIMATOR_H
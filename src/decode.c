@@ -0,0 +1,430 @@
+#include <dirent.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "utils/logger.h"
+#include "utils/work_pool.h"
+#include "wav/wav_file.h"
+#include "audio_socket/layers/physical/physical_layer.h"
+
+/** The argument for choosing the amount of worker threads */
+#define THREADS_ARGUMENT "--threads"
+
+/** The usage string of the program */
+#define USAGE "AudioDecode [" THREADS_ARGUMENT " <count>] <directory>"
+
+/** The extension of the decoded recordings */
+#define RECORDING_EXTENSION ".wav"
+
+/** The sample rate the recordings must be recorded at */
+#define RECORDING_SAMPLE_RATE (48000)
+
+/** The amount of samples decoded at once, the frames are collected between blocks (100 milliseconds) */
+#define DECODE_BLOCK_SIZE (4800)
+
+/**
+ * A frame recovered from a recording.
+ */
+struct recovered_frame {
+    /** The time in the recording by which the frame was recovered, rounded up to a decode block. */
+    double seconds;
+
+    /** The frame's bytes. */
+    uint8_t data[PHYSICAL_LAYER_MTU];
+
+    /** The frame's size. */
+    size_t size;
+
+    /** The frame's erasures, bit i is set if byte i is unreliable. */
+    uint16_t erasures;
+};
+
+/**
+ * The decode result of a single recording.
+ */
+struct recording {
+    /** The recording's file name, within the directory. */
+    char* name;
+
+    /** The recording's file size, longer recordings are decoded first. */
+    off_t size;
+
+    /** Whether the whole recording was decoded. */
+    bool is_decoded;
+
+    /** The index of the worker that decoded the recording. */
+    uint32_t worker_index;
+
+    /** The length of the recording. */
+    double audio_seconds;
+
+    /** The time spent initializing the decoder. */
+    double initialize_seconds;
+
+    /** The time spent decoding. */
+    double decode_seconds;
+
+    /** The decoder's counters at the end of the recording. */
+    struct physical_layer_stats stats;
+
+    /** The recovered frames. */
+    struct recovered_frame* frames;
+
+    /** The amount of recovered frames. */
+    size_t frames_count;
+
+    /** The amount of bytes marked as erasures in the recovered frames. */
+    size_t erased_bytes;
+};
+
+/**
+ * The decode jobs context.
+ */
+struct decode_context {
+    /** The recordings' directory. */
+    const char* directory;
+
+    /** The recordings in job order, longest first. */
+    struct recording** jobs;
+};
+
+/**
+ * Gets the current monotonic time.
+ *
+ * @return The monotonic time in seconds.
+ */
+static double monotonic_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * Compare callback for sorting recordings by name.
+ *
+ * @param a First recording pointer.
+ * @param b Second recording pointer.
+ * @return The order indicator between a and b.
+ */
+static int compare_recording_names(const struct recording* a, const struct recording* b) {
+    return strcmp(a->name, b->name);
+}
+
+/**
+ * Compare callback for sorting recording pointers by decreasing size.
+ *
+ * @param a First recording pointer pointer.
+ * @param b Second recording pointer pointer.
+ * @return The order indicator between a and b.
+ */
+static int compare_recording_sizes(const struct recording* const* a, const struct recording* const* b) {
+    return ((*a)->size < (*b)->size) - ((*a)->size > (*b)->size);
+}
+
+/**
+ * Collects every frame the decoder has recovered so far.
+ *
+ * @param decoder The decoder.
+ * @param recording The recording to append the frames to.
+ * @param seconds The time in the recording decoded so far.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int collect_frames(audio_physical_layer_socket_t* decoder, struct recording* recording, double seconds) {
+    uint8_t frame[PHYSICAL_LAYER_MTU];
+    ssize_t size;
+    while ((size = PHYSICAL_LAYER__peek(decoder, frame, sizeof(frame), false)) > 0) {
+        struct recovered_frame* frames = realloc(recording->frames,
+                                                 (recording->frames_count + 1) * sizeof(struct recovered_frame));
+        if (frames == NULL) {
+            LOG_ERROR("Failed to allocate recovered frame");
+            return -1;
+        }
+        recording->frames = frames;
+
+        struct recovered_frame* recovered = &recording->frames[recording->frames_count++];
+        recovered->seconds = seconds;
+        memcpy(recovered->data, frame, (size_t)size);
+        recovered->size = (size_t)size;
+        (void)PHYSICAL_LAYER__peek_erasures(decoder, &recovered->erasures);
+        recording->erased_bytes += (size_t)__builtin_popcount(recovered->erasures);
+        PHYSICAL_LAYER__pop(decoder);
+    }
+
+    return (size < 0) ? -1 : 0;
+}
+
+/**
+ * Decodes a single recording with it's own decoder, the pool job.
+ *
+ * @param context The decode context.
+ * @param job_index The index of the recording's job.
+ * @param worker_index The index of the worker.
+ */
+static void decode_recording(struct decode_context* context, size_t job_index, uint32_t worker_index) {
+    struct recording* recording = context->jobs[job_index];
+    audio_physical_layer_socket_t* decoder = NULL;
+    wav_reader_t* reader = NULL;
+    float samples[DECODE_BLOCK_SIZE];
+    recording->worker_index = worker_index;
+
+    /* Open the recording. */
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", context->directory, recording->name);
+    reader = WAV_READER__initialize(path);
+    if (reader == NULL) {
+        LOG_ERROR("Failed to open recording %s", path);
+        goto l_cleanup;
+    }
+    if (WAV_READER__get_sample_rate(reader) != RECORDING_SAMPLE_RATE) {
+        LOG_ERROR("Recording %s isn't sampled at %dHz", path, RECORDING_SAMPLE_RATE);
+        goto l_cleanup;
+    }
+    recording->audio_seconds = (double)WAV_READER__get_samples_count(reader) / RECORDING_SAMPLE_RATE;
+
+    /* Initialize the recording's decoder. */
+    double start = monotonic_seconds();
+    decoder = PHYSICAL_LAYER__initialize_decoder(NULL);
+    if (decoder == NULL) {
+        LOG_ERROR("Failed to initialize decoder for %s", path);
+        goto l_cleanup;
+    }
+    recording->initialize_seconds = monotonic_seconds() - start;
+
+    /* Decode the recording a block at a time, collecting the frames in between. */
+    start = monotonic_seconds();
+    uint64_t position = 0;
+    size_t count;
+    while ((count = WAV_READER__read(reader, samples, DECODE_BLOCK_SIZE)) > 0) {
+        position += count;
+        if (PHYSICAL_LAYER__decode(decoder, samples, count) != 0 ||
+            collect_frames(decoder, recording, (double)position / RECORDING_SAMPLE_RATE) != 0) {
+            LOG_ERROR("Failed to decode recording %s", path);
+            goto l_cleanup;
+        }
+    }
+    recording->decode_seconds = monotonic_seconds() - start;
+
+    PHYSICAL_LAYER__get_stats(decoder, &recording->stats);
+    recording->is_decoded = true;
+
+l_cleanup:
+    if (decoder != NULL) {
+        PHYSICAL_LAYER__free(decoder);
+    }
+    WAV_READER__free(reader);
+}
+
+/**
+ * Frees a list of recordings.
+ *
+ * @param recordings The recordings.
+ * @param recordings_count The amount of recordings.
+ */
+static void free_recordings(struct recording* recordings, size_t recordings_count) {
+    for (size_t i = 0; i < recordings_count; ++i) {
+        free(recordings[i].name);
+        free(recordings[i].frames);
+    }
+    free(recordings);
+}
+
+/**
+ * Lists the recordings in a directory, ordered by name.
+ *
+ * @param directory The directory.
+ * @param recordings Returns the recordings, freed with `free_recordings`.
+ * @param recordings_count Returns the amount of recordings.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int list_recordings(const char* directory, struct recording** recordings, size_t* recordings_count) {
+    int ret = -1;
+    struct recording* list = NULL;
+    size_t count = 0;
+
+    DIR* dir = opendir(directory);
+    if (dir == NULL) {
+        LOG_ERROR("Failed to open directory %s", directory);
+        return -1;
+    }
+
+    struct dirent* entry;
+    size_t extension_length = strlen(RECORDING_EXTENSION);
+    while ((entry = readdir(dir)) != NULL) {
+        /* Only regular files with the recording extension. */
+        size_t length = strlen(entry->d_name);
+        if (length <= extension_length ||
+            strcasecmp(entry->d_name + length - extension_length, RECORDING_EXTENSION) != 0) {
+            continue;
+        }
+
+        char path[PATH_MAX];
+        struct stat file_stat;
+        snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+        if (stat(path, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+            continue;
+        }
+
+        struct recording* grown = realloc(list, (count + 1) * sizeof(struct recording));
+        if (grown == NULL) {
+            LOG_ERROR("Failed to allocate recordings list");
+            goto l_cleanup;
+        }
+        list = grown;
+        memset(&list[count], 0, sizeof(struct recording));
+        list[count].size = file_stat.st_size;
+        list[count].name = strdup(entry->d_name);
+        if (list[count].name == NULL) {
+            LOG_ERROR("Failed to allocate recordings list");
+            goto l_cleanup;
+        }
+        count++;
+    }
+
+    qsort(list, count, sizeof(struct recording), (int (*)(const void*, const void*)) compare_recording_names);
+    *recordings = list;
+    *recordings_count = count;
+    list = NULL;
+    count = 0;
+    ret = 0;
+
+l_cleanup:
+    free_recordings(list, count);
+    closedir(dir);
+    return ret;
+}
+
+/**
+ * Prints a string as a JSON string literal.
+ *
+ * @param string The string to print.
+ */
+static void print_json_string(const char* string) {
+    putchar('"');
+    for (const unsigned char* c = (const unsigned char*)string; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            printf("\\%c", *c);
+        } else if (*c < 0x20) {
+            printf("\\u%04x", *c);
+        } else {
+            putchar(*c);
+        }
+    }
+    putchar('"');
+}
+
+/**
+ * Prints the decode result of a recording as a single line JSON object.
+ *
+ * @param recording The recording.
+ */
+static void print_recording(const struct recording* recording) {
+    printf("{\"file\":");
+    print_json_string(recording->name);
+    printf(",\"decoded\":%s,\"worker\":%u,\"audio_seconds\":%.3f,\"initialize_seconds\":%.6f,"
+           "\"decode_seconds\":%.6f,\"realtime_factor\":%.1f,\"windows_decoded\":%" PRIu64 ",\"frames_count\":%zu,"
+           "\"erased_bytes\":%zu,\"frame_ring_overflows\":%" PRIu64 ",\"frames\":[",
+           recording->is_decoded ? "true" : "false", recording->worker_index, recording->audio_seconds,
+           recording->initialize_seconds, recording->decode_seconds,
+           (recording->decode_seconds > 0) ? recording->audio_seconds / recording->decode_seconds : 0,
+           recording->stats.windows_decoded, recording->frames_count, recording->erased_bytes,
+           recording->stats.frame_ring_overflows);
+
+    for (size_t i = 0; i < recording->frames_count; ++i) {
+        const struct recovered_frame* frame = &recording->frames[i];
+        printf("%s{\"seconds\":%.1f,\"data\":\"", (i > 0) ? "," : "", frame->seconds);
+        for (size_t j = 0; j < frame->size; ++j) {
+            printf("%02x", frame->data[j]);
+        }
+        printf("\",\"erasures\":%u}", frame->erasures);
+    }
+    printf("]}\n");
+}
+
+/**
+ * Main function for the offline decoder program.
+ * Decodes every WAV recording in a directory across all cores, one physical layer decoder per recording.
+ * Prints a JSON object line per recording (in name order) with the recovered frames and decode statistics,
+ * followed by a summary line.
+ *
+ * @param argc The number of arguments to the program, expected value 2 or 4.
+ * @param argv The arguments to the program (including the program name),
+ *             optionally `THREADS_ARGUMENT` followed by the amount of workers, then the recordings' directory.
+ * @return 0 On Success, -1 On Failure.
+ */
+int main(int argc, char *argv[]) {
+    int status;
+    struct recording* recordings = NULL;
+    size_t recordings_count = 0;
+    struct recording** jobs = NULL;
+
+    /* Parse the arguments. */
+    uint32_t threads_count = WORK_POOL__get_processors_count();
+    const char* directory;
+    if (argc == 4 && strcmp(argv[1], THREADS_ARGUMENT) == 0 && atoi(argv[2]) > 0) {
+        threads_count = (uint32_t)atoi(argv[2]);
+        directory = argv[3];
+    } else if (argc == 2) {
+        directory = argv[1];
+    } else {
+        printf(USAGE "\n");
+        return -1;
+    }
+
+    /* List the recordings. */
+    status = list_recordings(directory, &recordings, &recordings_count);
+    if (status != 0) {
+        LOG_ERROR("Failed to list recordings");
+        goto l_cleanup;
+    }
+
+    /* Decode the longest recordings first, so the short ones fill in the gaps at the end. */
+    jobs = malloc((recordings_count + 1) * sizeof(struct recording*));
+    if (jobs == NULL) {
+        LOG_ERROR("Failed to allocate decode jobs");
+        status = -1;
+        goto l_cleanup;
+    }
+    for (size_t i = 0; i < recordings_count; ++i) {
+        jobs[i] = &recordings[i];
+    }
+    qsort(jobs, recordings_count, sizeof(struct recording*),
+          (int (*)(const void*, const void*)) compare_recording_sizes);
+
+    struct decode_context context = {.directory = directory, .jobs = jobs};
+    struct work_pool_stats pool_stats = {0};
+    double start = monotonic_seconds();
+    status = WORK_POOL__run(threads_count, recordings_count, (work_pool_job_t) decode_recording, &context, &pool_stats);
+    double wall_seconds = monotonic_seconds() - start;
+    if (status != 0) {
+        LOG_ERROR("Failed to run decode jobs");
+        goto l_cleanup;
+    }
+
+    /* Output the results. */
+    size_t decoded_count = 0;
+    size_t frames_count = 0;
+    double audio_seconds = 0;
+    for (size_t i = 0; i < recordings_count; ++i) {
+        print_recording(&recordings[i]);
+        decoded_count += recordings[i].is_decoded ? 1 : 0;
+        frames_count += recordings[i].frames_count;
+        audio_seconds += recordings[i].audio_seconds;
+    }
+    printf("{\"recordings\":%zu,\"decoded\":%zu,\"threads\":%u,\"steals\":%" PRIu64 ",\"audio_seconds\":%.3f,"
+           "\"wall_seconds\":%.6f,\"realtime_factor\":%.1f,\"frames_count\":%zu}\n",
+           recordings_count, decoded_count, threads_count, pool_stats.steals, audio_seconds, wall_seconds,
+           (wall_seconds > 0) ? audio_seconds / wall_seconds : 0, frames_count);
+
+    status = (decoded_count == recordings_count) ? 0 : -1;
+
+l_cleanup:
+    free(jobs);
+    free_recordings(recordings, recordings_count);
+    return status;
+}
@@ -0,0 +1,401 @@
+#include <malloc.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "reed_solomon.h"
+#include "utils/logger.h"
+
+/** The primitive polynomial generating GF(256), x^8 + x^4 + x^3 + x^2 + 1. */
+#define GF_PRIMITIVE_POLYNOMIAL (0x11d)
+
+/** The amount of non-zero elements in GF(256), the order of the primitive element alpha. */
+#define GF_ORDER (255)
+
+/** The size of the polynomial buffers, enough for any polynomial of a codeword's degree. */
+#define POLYNOMIAL_SIZE (REED_SOLOMON_MAX_CODEWORD_SIZE + 1)
+
+struct reed_solomon_s {
+    /** The amount of parity bytes in each codeword. */
+    uint32_t parity_count;
+
+    /** The powers of alpha, doubled so the sum of two logs can index it without a modulo. */
+    uint8_t exp[2 * GF_ORDER];
+
+    /** The log (base alpha) of each non-zero element. */
+    uint8_t log[GF_ORDER + 1];
+
+    /**
+     * The generator polynomial's coefficients in descending order, without the (monic) leading coefficient,
+     * the generator's roots are alpha^0 ... alpha^(parity_count - 1).
+     */
+    uint8_t generator[POLYNOMIAL_SIZE];
+};
+
+/**
+ * Multiplies two field elements.
+ *
+ * @param codec The codec holding the field tables.
+ * @param a The first element.
+ * @param b The second element.
+ * @return The product.
+ */
+static inline uint8_t gf_multiply(const reed_solomon_t* codec, uint8_t a, uint8_t b) {
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+
+    return codec->exp[codec->log[a] + codec->log[b]];
+}
+
+/**
+ * Divides two field elements.
+ *
+ * @param codec The codec holding the field tables.
+ * @param a The dividend.
+ * @param b The divisor, must be non-zero.
+ * @return The quotient.
+ */
+static inline uint8_t gf_divide(const reed_solomon_t* codec, uint8_t a, uint8_t b) {
+    if (a == 0) {
+        return 0;
+    }
+
+    return codec->exp[codec->log[a] + GF_ORDER - codec->log[b]];
+}
+
+/**
+ * Raises alpha to a power.
+ *
+ * @param codec The codec holding the field tables.
+ * @param power The power, may be negative.
+ * @return alpha^power.
+ */
+static inline uint8_t gf_alpha_power(const reed_solomon_t* codec, int power) {
+    power %= GF_ORDER;
+    if (power < 0) {
+        power += GF_ORDER;
+    }
+
+    return codec->exp[power];
+}
+
+/**
+ * Evaluates a polynomial (ascending coefficients) at a point.
+ *
+ * @param codec The codec holding the field tables.
+ * @param polynomial The polynomial's coefficients, lowest degree first.
+ * @param degree The polynomial's degree.
+ * @param x The point.
+ * @return The polynomial's value at `x`.
+ */
+static uint8_t evaluate_polynomial(const reed_solomon_t* codec, const uint8_t* polynomial, size_t degree, uint8_t x) {
+    uint8_t value = 0;
+    for (size_t i = degree + 1; i > 0; --i) {
+        value = gf_multiply(codec, value, x) ^ polynomial[i - 1];
+    }
+
+    return value;
+}
+
+/**
+ * Multiplies two polynomials (ascending coefficients), truncating the product to `result_size` coefficients.
+ *
+ * @param codec The codec holding the field tables.
+ * @param a The first polynomial.
+ * @param a_size The amount of coefficients in `a`.
+ * @param b The second polynomial.
+ * @param b_size The amount of coefficients in `b`.
+ * @param result Returns the product, mustn't overlap the inputs.
+ * @param result_size The amount of coefficients to calculate.
+ */
+static void multiply_polynomials(const reed_solomon_t* codec,
+                                 const uint8_t* a, size_t a_size, const uint8_t* b, size_t b_size,
+                                 uint8_t* result, size_t result_size) {
+    memset(result, 0, result_size);
+    for (size_t i = 0; i < a_size && i < result_size; ++i) {
+        if (a[i] == 0) {
+            continue;
+        }
+        for (size_t j = 0; j < b_size && i + j < result_size; ++j) {
+            result[i + j] ^= gf_multiply(codec, a[i], b[j]);
+        }
+    }
+}
+
+/**
+ * Calculates the syndromes of a codeword, the codeword evaluated at each of the generator's roots.
+ *
+ * @param codec The codec.
+ * @param codeword The codeword, it's first byte is the highest degree coefficient.
+ * @param length The length of the codeword.
+ * @param syndromes Returns the `parity_count` syndromes.
+ * @return Whether all the syndromes are zero (the codeword is valid).
+ */
+static bool calculate_syndromes(const reed_solomon_t* codec, const uint8_t* codeword, size_t length, uint8_t* syndromes) {
+    bool is_valid = true;
+    for (uint32_t j = 0; j < codec->parity_count; ++j) {
+        uint8_t root = codec->exp[j];
+        uint8_t value = 0;
+        for (size_t i = 0; i < length; ++i) {
+            value = gf_multiply(codec, value, root) ^ codeword[i];
+        }
+
+        syndromes[j] = value;
+        is_valid = is_valid && (value == 0);
+    }
+
+    return is_valid;
+}
+
+/**
+ * Finds the error locator polynomial of the given syndromes with the Berlekamp-Massey algorithm.
+ *
+ * @param codec The codec holding the field tables.
+ * @param syndromes The syndromes.
+ * @param syndromes_count The amount of syndromes.
+ * @param locator Returns the locator polynomial (ascending), `POLYNOMIAL_SIZE` coefficients.
+ * @return The degree of the locator (the amount of errors).
+ */
+static size_t find_error_locator(const reed_solomon_t* codec, const uint8_t* syndromes, size_t syndromes_count,
+                                 uint8_t* locator) {
+    uint8_t previous[POLYNOMIAL_SIZE] = {1};
+    uint8_t temporary[POLYNOMIAL_SIZE];
+    size_t degree = 0;
+    size_t shift = 1;
+    uint8_t previous_discrepancy = 1;
+
+    memset(locator, 0, POLYNOMIAL_SIZE);
+    locator[0] = 1;
+
+    for (size_t n = 0; n < syndromes_count; ++n) {
+        /* The discrepancy of the current locator in predicting the next syndrome. */
+        uint8_t discrepancy = syndromes[n];
+        for (size_t i = 1; i <= degree; ++i) {
+            discrepancy ^= gf_multiply(codec, locator[i], syndromes[n - i]);
+        }
+
+        if (discrepancy == 0) {
+            shift++;
+            continue;
+        }
+
+        /* Correct the locator by the shifted previous locator, growing it if needed. */
+        uint8_t coefficient = gf_divide(codec, discrepancy, previous_discrepancy);
+        bool is_growing = (2 * degree <= n);
+        if (is_growing) {
+            memcpy(temporary, locator, POLYNOMIAL_SIZE);
+        }
+
+        for (size_t i = 0; i + shift < POLYNOMIAL_SIZE; ++i) {
+            locator[i + shift] ^= gf_multiply(codec, coefficient, previous[i]);
+        }
+
+        if (is_growing) {
+            degree = n + 1 - degree;
+            memcpy(previous, temporary, POLYNOMIAL_SIZE);
+            previous_discrepancy = discrepancy;
+            shift = 1;
+        } else {
+            shift++;
+        }
+    }
+
+    return degree;
+}
+
+reed_solomon_t* REED_SOLOMON__initialize(uint32_t parity_count) {
+    /* Validate parameters */
+    if (parity_count == 0 || parity_count >= REED_SOLOMON_MAX_CODEWORD_SIZE) {
+        LOG_ERROR("Invalid reed solomon parity count %u", parity_count);
+        return NULL;
+    }
+
+    /* Allocate the codec object */
+    reed_solomon_t* codec = malloc(sizeof(reed_solomon_t));
+    if (codec == NULL) {
+        LOG_ERROR("Failed to allocate reed solomon struct");
+        return NULL;
+    }
+    codec->parity_count = parity_count;
+
+    /* Build the field's exp/log tables from the primitive polynomial. */
+    uint32_t element = 1;
+    for (int i = 0; i < GF_ORDER; ++i) {
+        codec->exp[i] = (uint8_t)element;
+        codec->exp[i + GF_ORDER] = (uint8_t)element;
+        codec->log[element] = (uint8_t)i;
+        element <<= 1;
+        if (element & 0x100) {
+            element ^= GF_PRIMITIVE_POLYNOMIAL;
+        }
+    }
+    codec->log[0] = 0;
+
+    /* Build the generator polynomial, the product of (x + alpha^j), in ascending order. */
+    uint8_t generator[POLYNOMIAL_SIZE] = {1};
+    for (uint32_t j = 0; j < parity_count; ++j) {
+        uint8_t root = codec->exp[j];
+        for (uint32_t k = j + 1; k > 0; --k) {
+            generator[k] = generator[k - 1] ^ gf_multiply(codec, generator[k], root);
+        }
+        generator[0] = gf_multiply(codec, generator[0], root);
+    }
+
+    /* Keep the non-leading coefficients in descending order, as the encoder's register uses them. */
+    for (uint32_t j = 0; j < parity_count; ++j) {
+        codec->generator[j] = generator[parity_count - 1 - j];
+    }
+
+    return codec;
+}
+
+void REED_SOLOMON__free(reed_solomon_t* codec) {
+    free(codec);
+}
+
+uint32_t REED_SOLOMON__get_parity_count(reed_solomon_t* codec) {
+    return codec->parity_count;
+}
+
+int REED_SOLOMON__encode(reed_solomon_t* codec, const uint8_t* data, size_t data_length, uint8_t* parity) {
+    uint32_t parity_count = codec->parity_count;
+
+    /* Validate parameters */
+    if (data_length + parity_count > REED_SOLOMON_MAX_CODEWORD_SIZE) {
+        LOG_ERROR("Reed solomon codeword too long: %zu", data_length + parity_count);
+        return -1;
+    }
+
+    /* The parity is the remainder of data(x) * x^parity_count divided by the generator,
+     * calculated with a division register, one data byte at a time. */
+    memset(parity, 0, parity_count);
+    for (size_t i = 0; i < data_length; ++i) {
+        uint8_t feedback = data[i] ^ parity[0];
+        memmove(parity, parity + 1, parity_count - 1);
+        parity[parity_count - 1] = 0;
+
+        if (feedback != 0) {
+            uint8_t feedback_log = codec->log[feedback];
+            for (uint32_t j = 0; j < parity_count; ++j) {
+                if (codec->generator[j] != 0) {
+                    parity[j] ^= codec->exp[codec->log[codec->generator[j]] + feedback_log];
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+int REED_SOLOMON__decode(reed_solomon_t* codec, uint8_t* codeword, size_t length,
+                         const size_t* erasures, size_t erasures_count) {
+    uint32_t parity_count = codec->parity_count;
+    uint8_t syndromes[POLYNOMIAL_SIZE] = {0};
+
+    /* Validate parameters */
+    if (length <= parity_count || length > REED_SOLOMON_MAX_CODEWORD_SIZE) {
+        LOG_ERROR("Invalid reed solomon codeword length %zu", length);
+        return -1;
+    }
+    if (erasures_count > parity_count) {
+        LOG_DEBUG("Too many erasures to correct: %zu", erasures_count);
+        return -1;
+    }
+
+    /* A codeword with zero syndromes is valid (erased bytes included). */
+    if (calculate_syndromes(codec, codeword, length, syndromes)) {
+        return 0;
+    }
+
+    /* The erasure locator, with a root at the inverse locator alpha^(length - 1 - index) of each erasure. */
+    uint8_t erasure_locator[POLYNOMIAL_SIZE] = {1};
+    for (size_t k = 0; k < erasures_count; ++k) {
+        if (erasures[k] >= length) {
+            LOG_ERROR("Invalid reed solomon erasure %zu", erasures[k]);
+            return -1;
+        }
+
+        uint8_t locator = gf_alpha_power(codec, (int)(length - 1 - erasures[k]));
+        for (size_t i = k + 1; i > 0; --i) {
+            erasure_locator[i] ^= gf_multiply(codec, erasure_locator[i - 1], locator);
+        }
+    }
+
+    /* The Forney syndromes hide the erasures, so Berlekamp-Massey only has to find the errors. */
+    uint8_t forney_syndromes[POLYNOMIAL_SIZE];
+    multiply_polynomials(codec, syndromes, parity_count, erasure_locator, erasures_count + 1,
+                         forney_syndromes, parity_count);
+
+    uint8_t error_locator[POLYNOMIAL_SIZE];
+    size_t errors_count = find_error_locator(codec, forney_syndromes + erasures_count,
+                                             parity_count - erasures_count, error_locator);
+    if (2 * errors_count + erasures_count > parity_count) {
+        LOG_DEBUG("Too many errors to correct: %zu errors, %zu erasures", errors_count, erasures_count);
+        return -1;
+    }
+
+    /* The errata (errors and erasures) locator, and the errata evaluator. */
+    size_t errata_count = errors_count + erasures_count;
+    uint8_t errata_locator[POLYNOMIAL_SIZE];
+    uint8_t evaluator[POLYNOMIAL_SIZE];
+    multiply_polynomials(codec, error_locator, errors_count + 1, erasure_locator, erasures_count + 1,
+                         errata_locator, errata_count + 1);
+    multiply_polynomials(codec, syndromes, parity_count, errata_locator, errata_count + 1,
+                         evaluator, parity_count);
+
+    /* The formal derivative of the errata locator, only the odd coefficients survive in characteristic 2. */
+    uint8_t derivative[POLYNOMIAL_SIZE] = {0};
+    for (size_t i = 1; i <= errata_count; i += 2) {
+        derivative[i - 1] = errata_locator[i];
+    }
+
+    /* Find the errata positions (Chien search) and their magnitudes (Forney algorithm). */
+    size_t positions[POLYNOMIAL_SIZE];
+    uint8_t magnitudes[POLYNOMIAL_SIZE];
+    size_t found_count = 0;
+    for (size_t index = 0; index < length && found_count <= errata_count; ++index) {
+        int power = (int)(length - 1 - index);
+        uint8_t inverse_locator = gf_alpha_power(codec, -power);
+        if (evaluate_polynomial(codec, errata_locator, errata_count, inverse_locator) != 0) {
+            continue;
+        }
+
+        uint8_t denominator = evaluate_polynomial(codec, derivative, errata_count, inverse_locator);
+        if (denominator == 0 || found_count == errata_count) {
+            found_count = errata_count + 1;
+            break;
+        }
+
+        uint8_t numerator = gf_multiply(codec, gf_alpha_power(codec, power),
+                                        evaluate_polynomial(codec, evaluator, parity_count - 1, inverse_locator));
+        positions[found_count] = index;
+        magnitudes[found_count] = gf_divide(codec, numerator, denominator);
+        found_count++;
+    }
+
+    /* The locator must have exactly it's degree in roots within the codeword, otherwise there are too many errors. */
+    if (found_count != errata_count) {
+        LOG_DEBUG("Reed solomon locator roots mismatch: %zu of %zu", found_count, errata_count);
+        return -1;
+    }
+
+    /* Apply the corrections. */
+    int corrected = 0;
+    for (size_t k = 0; k < found_count; ++k) {
+        if (magnitudes[k] != 0) {
+            codeword[positions[k]] ^= magnitudes[k];
+            corrected++;
+        }
+    }
+
+    /* Make sure the result is a valid codeword, a miscorrection beyond the code's capability is undone. */
+    if (!calculate_syndromes(codec, codeword, length, syndromes)) {
+        for (size_t k = 0; k < found_count; ++k) {
+            codeword[positions[k]] ^= magnitudes[k];
+        }
+        LOG_DEBUG("Reed solomon correction failed verification");
+        return -1;
+    }
+
+    return corrected;
+}
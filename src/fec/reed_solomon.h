@@ -0,0 +1,69 @@
+#ifndef AUDIONET_REED_SOLOMON_H
+#define AUDIONET_REED_SOLOMON_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The maximal length of a codeword (data and parity), the size of GF(256) minus one.
+ */
+#define REED_SOLOMON_MAX_CODEWORD_SIZE (255)
+
+/**
+ * The Reed-Solomon codec interface type.
+ * A systematic code over GF(256), the parity bytes follow the data bytes of each codeword.
+ * Shorter codewords are supported (a shortened code), as long as data and parity fit `REED_SOLOMON_MAX_CODEWORD_SIZE`.
+ */
+typedef struct reed_solomon_s reed_solomon_t;
+
+/**
+ * Initializes a Reed-Solomon codec.
+ * A codeword with `parity_count` parity bytes can be corrected as long as `2 * errors + erasures <= parity_count`.
+ *
+ * @param parity_count The amount of parity bytes in each codeword (1 - 254).
+ * @return The initialized codec, or NULL on failure.
+ */
+reed_solomon_t* REED_SOLOMON__initialize(uint32_t parity_count);
+
+/**
+ * Frees a codec previously initialized with REED_SOLOMON__initialize.
+ *
+ * @param codec The codec to free.
+ */
+void REED_SOLOMON__free(reed_solomon_t* codec);
+
+/**
+ * Gets the amount of parity bytes in each codeword.
+ *
+ * @param codec The codec.
+ * @return The amount of parity bytes.
+ */
+uint32_t REED_SOLOMON__get_parity_count(reed_solomon_t* codec);
+
+/**
+ * Calculates the parity of a codeword's data.
+ *
+ * @param codec The codec.
+ * @param data The codeword's data.
+ * @param data_length The length of the data, up to `REED_SOLOMON_MAX_CODEWORD_SIZE` minus the parity count.
+ * @param parity Returns the parity bytes, `parity_count` bytes long.
+ * @return 0 On Success, -1 On Failure.
+ */
+int REED_SOLOMON__encode(reed_solomon_t* codec, const uint8_t* data, size_t data_length, uint8_t* parity);
+
+/**
+ * Corrects a codeword (data followed by parity) in place.
+ * Erasures are bytes known to be unreliable (e.g. never received), their values are ignored,
+ * correcting an erasure costs half of correcting an error at an unknown position.
+ *
+ * @param codec The codec.
+ * @param codeword The codeword to correct.
+ * @param length The length of the codeword, including the parity.
+ * @param erasures The indices (in `codeword`) of the erased bytes, may be NULL if there are none.
+ * @param erasures_count The amount of erasures.
+ * @return The amount of bytes corrected, or -1 if the codeword can't be corrected.
+ */
+int REED_SOLOMON__decode(reed_solomon_t* codec, uint8_t* codeword, size_t length,
+                         const size_t* erasures, size_t erasures_count);
+
+#endif //AUDIONET_REED_SOLOMON_H
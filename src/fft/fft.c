@@ -3,17 +3,27 @@
 #include <malloc.h>
 #include <stdint.h>
 #include <string.h>
+#include <pthread.h>
 #include "fft.h"
 #include "utils/logger.h"
 
+/** The FFTW planner and wisdom are global state that isn't thread safe, every access is serialized by this lock. */
+static pthread_mutex_t g_planner_lock = PTHREAD_MUTEX_INITIALIZER;
+
 struct fft_s {
 
     /** The expected sample rate for the FFT to process */
-    int sample_rate;
+    float sample_rate;
 
     /** The expected frame count for the FFT to process */
     int frame_count;
 
+    /** The amount of output bins */
+    uint32_t number_of_bins;
+
+    /** The frequency width of each output bin, fractional since the (decimated) rate needn't divide by the size */
+    float bins_size;
+
     /** The preconfigured FFTW plan */
     fftwf_plan plan;
 
@@ -22,21 +32,51 @@ struct fft_s {
 
     /** The input buffer for FFTW */
     float *audioBuffer;
+
+    /** The frequencies output buffer, owned by the FFT and refilled on every execution */
+    struct frequency_and_magnitude *output;
 };
 
 /**
- * Calculates the magnitude of a complex number.
+ * Calculates the squared magnitude (power) of a complex number.
  *
- * @param complex_number The complex number to calculate it's magnitude.
- * @return The magnitude of the complex number
+ * @param complex_number The complex number to calculate it's squared magnitude.
+ * @return The squared magnitude of the complex number
  */
-static float complex_magnitude(const fftwf_complex complex_number) {
+static float complex_power(const fftwf_complex complex_number) {
     float real_part = complex_number[0];
     float complex_part = complex_number[1];
-    return sqrt(real_part * real_part + complex_part * complex_part);
+    return real_part * real_part + complex_part * complex_part;
+}
+
+/**
+ * Creates the FFTW plan of the FFT, restoring it from the wisdom cache if possible.
+ * Must be called with the planner lock held.
+ *
+ * @param fft The FFT with it's buffers allocated.
+ * @param wisdom_path The FFTW wisdom cache file, or NULL to plan with measurements.
+ * @return The created plan, or NULL on failure.
+ */
+static fftwf_plan create_plan(fft_t* fft, const char* wisdom_path) {
+    /* Without a cache we can only measure. */
+    if (wisdom_path == NULL) {
+        return fftwf_plan_dft_r2c_1d(fft->frame_count, fft->audioBuffer, fft->fftBuffer, FFTW_MEASURE);
+    }
+
+    /* Try restoring a measured plan from the cache, a missing cache file simply leaves us without wisdom. */
+    (void)fftwf_import_wisdom_from_filename(wisdom_path);
+    fftwf_plan plan = fftwf_plan_dft_r2c_1d(fft->frame_count, fft->audioBuffer, fft->fftBuffer,
+                                            FFTW_MEASURE | FFTW_WISDOM_ONLY);
+    if (plan != NULL) {
+        return plan;
+    }
+
+    /* There's no wisdom for this size, fall back to a quick estimated plan. */
+    LOG_INFO("No FFTW wisdom for %d frames in %s, using an estimated plan", fft->frame_count, wisdom_path);
+    return fftwf_plan_dft_r2c_1d(fft->frame_count, fft->audioBuffer, fft->fftBuffer, FFTW_ESTIMATE);
 }
 
-fft_t* FFT__initialize(int frame_count, int sample_rate) {
+fft_t* FFT__initialize(int frame_count, float sample_rate, const char* wisdom_path) {
     /* Allocate the FFT object */
     fft_t* fft = malloc(sizeof(fft_t));
     if (fft == NULL) {
@@ -47,9 +87,11 @@ fft_t* FFT__initialize(int frame_count, int sample_rate) {
     /* Set the state */
     fft->frame_count = frame_count;
     fft->sample_rate = sample_rate;
+    fft->number_of_bins = frame_count / 2 + 1;
+    fft->bins_size = sample_rate / (float)frame_count;
 
-    /* Allocate the FFTW input buffer */
-    fft->audioBuffer = (float*)malloc(frame_count * sizeof(float));
+    /* Allocate the FFTW input buffer, FFTW's allocator gives the alignment it's SIMD plans want */
+    fft->audioBuffer = (float*)fftwf_malloc(frame_count * sizeof(float));
     if (fft->audioBuffer == NULL) {
         LOG_ERROR("Failed to allocate audio buffer");
         free(fft);
@@ -57,54 +99,151 @@ fft_t* FFT__initialize(int frame_count, int sample_rate) {
     }
 
     /* Allocate fftw plan */
-    fft->fftBuffer = (fftwf_complex*)fftwf_malloc(frame_count * sizeof(fftwf_complex));
-    if (fft->audioBuffer == NULL) {
+    fft->fftBuffer = (fftwf_complex*)fftwf_malloc(fft->number_of_bins * sizeof(fftwf_complex));
+    if (fft->fftBuffer == NULL) {
         LOG_ERROR("Failed to allocation fft buffer");
-        free(fft->audioBuffer);
+        fftwf_free(fft->audioBuffer);
+        free(fft);
+        return NULL;
+    }
+
+    /* Allocate the frequencies output buffer */
+    fft->output = fftwf_malloc(fft->number_of_bins * sizeof(struct frequency_and_magnitude));
+    if (fft->output == NULL) {
+        LOG_ERROR("Failed to allocate frequencies output buffer");
+        fftwf_free(fft->fftBuffer);
+        fftwf_free(fft->audioBuffer);
         free(fft);
         return NULL;
     }
 
     /* Initialize the FFTW plan */
-    fft->plan = fftwf_plan_dft_r2c_1d(frame_count, fft->audioBuffer, fft->fftBuffer, FFTW_MEASURE);
+    pthread_mutex_lock(&g_planner_lock);
+    fft->plan = create_plan(fft, wisdom_path);
+    pthread_mutex_unlock(&g_planner_lock);
+    if (fft->plan == NULL) {
+        LOG_ERROR("Failed to plan fft");
+        fftwf_free(fft->output);
+        fftwf_free(fft->fftBuffer);
+        fftwf_free(fft->audioBuffer);
+        free(fft);
+        return NULL;
+    }
 
     return fft;
 }
 
+int FFT__warm_wisdom(int frame_count, const char* wisdom_path) {
+    int ret = -1;
+
+    /* Allocate planning buffers, aligned like the ones the FFT module uses. */
+    float* input = (float*)fftwf_malloc(frame_count * sizeof(float));
+    fftwf_complex* output = (fftwf_complex*)fftwf_malloc((frame_count / 2 + 1) * sizeof(fftwf_complex));
+    if (input == NULL || output == NULL) {
+        LOG_ERROR("Failed to allocate planning buffers");
+        goto l_cleanup;
+    }
+
+    pthread_mutex_lock(&g_planner_lock);
+
+    /* Start from the existing cache so other sizes are kept, measuring is skipped for already known sizes. */
+    (void)fftwf_import_wisdom_from_filename(wisdom_path);
+    fftwf_plan plan = fftwf_plan_dft_r2c_1d(frame_count, input, output, FFTW_MEASURE);
+    if (plan == NULL) {
+        LOG_ERROR("Failed to plan fft of %d frames", frame_count);
+        pthread_mutex_unlock(&g_planner_lock);
+        goto l_cleanup;
+    }
+    fftwf_destroy_plan(plan);
+
+    /* Save the updated cache. */
+    if (!fftwf_export_wisdom_to_filename(wisdom_path)) {
+        LOG_ERROR("Failed to export FFTW wisdom to %s", wisdom_path);
+        pthread_mutex_unlock(&g_planner_lock);
+        goto l_cleanup;
+    }
+
+    pthread_mutex_unlock(&g_planner_lock);
+    ret = 0;
+
+l_cleanup:
+    if (output != NULL) {
+        fftwf_free(output);
+    }
+    if (input != NULL) {
+        fftwf_free(input);
+    }
+
+    return ret;
+}
+
 void FFT__free(fft_t* fft) {
     /* Reverse order de-allocation/initiation */
+    pthread_mutex_lock(&g_planner_lock);
     fftwf_destroy_plan(fft->plan);
+    pthread_mutex_unlock(&g_planner_lock);
+    fftwf_free(fft->output);
     fftwf_free(fft->fftBuffer);
-    free(fft->audioBuffer);
+    fftwf_free(fft->audioBuffer);
+    free(fft);
 }
 
-int FFT__calculate(fft_t* fft, const float* sample, size_t frame_count, struct frequency_and_magnitude** frequencies, size_t* out_length) {
+int FFT__execute(fft_t* fft, const float* sample, size_t frame_count, bool squared, struct frequency_and_magnitude** frequencies, size_t* out_length) {
     /* Validate the parameters fit the planned configuration */
     if (frame_count != fft->frame_count) {
-        printf("Frame Count %lld\n", frame_count);
+        LOG_ERROR("Frame Count %zu", frame_count);
         return -1;
     }
 
-    uint32_t number_of_bins = frame_count / 2 + 1;
-    uint32_t bins_size = fft->sample_rate / frame_count;
+    /* Execute the FFT calculation.
+     * The plan may only run on buffers aligned like the ones it was planned with,
+     * an out-of-place r2c transform preserves it's input so the sample can be used as is. */
+    if (fftwf_alignment_of((float*)sample) == fftwf_alignment_of(fft->audioBuffer)) {
+        fftwf_execute_dft_r2c(fft->plan, (float*)sample, fft->fftBuffer);
+    } else {
+        memcpy(fft->audioBuffer, sample, frame_count * sizeof(float));
+        fftwf_execute(fft->plan);
+    }
+
+    /* Export the complex numbers to frequency/magnitude struct list.
+     * The frequencies are rewritten as well since the user may reorder the output. */
+    struct frequency_and_magnitude* freqs = fft->output;
+    for (uint32_t i = 0; i < fft->number_of_bins; ++i) {
+        freqs[i].frequency = i * fft->bins_size;
+        freqs[i].magnitude = complex_power(fft->fftBuffer[i]);
+    }
+
+    if (!squared) {
+        for (uint32_t i = 0; i < fft->number_of_bins; ++i) {
+            freqs[i].magnitude = sqrtf(freqs[i].magnitude);
+        }
+    }
 
-    /* Execute the FFT calculation */
-    memcpy(fft->audioBuffer, sample, frame_count * sizeof(float));
-    fftwf_execute(fft->plan);
+    *out_length = fft->number_of_bins;
+    *frequencies = freqs;
+
+    return 0;
+}
 
-    /* Export the complex numbers to frequency/magnitude struct list */
-    struct frequency_and_magnitude* freqs = malloc(number_of_bins * sizeof(struct frequency_and_magnitude));
+int FFT__calculate(fft_t* fft, const float* sample, size_t frame_count, struct frequency_and_magnitude** frequencies, size_t* out_length) {
+    struct frequency_and_magnitude* results;
+    size_t results_length;
+
+    /* Calculate into the FFT owned buffer. */
+    int ret = FFT__execute(fft, sample, frame_count, false, &results, &results_length);
+    if (ret != 0) {
+        return ret;
+    }
+
+    /* Copy the results to a user owned frequency/magnitude struct list */
+    struct frequency_and_magnitude* freqs = malloc(results_length * sizeof(struct frequency_and_magnitude));
     if (freqs == NULL) {
         LOG_ERROR("Failed to allocate frequencies output buffer");
         return -1;
     }
 
-    for (int i = 0; i < number_of_bins; ++i) {
-        freqs[i].frequency = i * bins_size;
-        freqs[i].magnitude = complex_magnitude(fft->fftBuffer[i]);
-    }
-
-    *out_length = number_of_bins;
+    memcpy(freqs, results, results_length * sizeof(struct frequency_and_magnitude));
+    *out_length = results_length;
     *frequencies = freqs;
 
     return 0;
@@ -1,6 +1,9 @@
 #ifndef AUDIONET_FFT_H
 #define AUDIONET_FFT_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
 
 /**
  * The FFT interface type.
@@ -20,12 +23,26 @@ struct frequency_and_magnitude {
 
 /**
  * Initializes the FFT module.
+ * Planning with measurements is slow, so a wisdom cache file may be given:
+ * when it holds wisdom for this size the measured plan is restored from it instantly,
+ * otherwise a quick estimated plan is used instead (see `FFT__warm_wisdom`).
  *
  * @param frame_count The expected samples size.
  * @param sample_rate The expected samples rate.
+ * @param wisdom_path The FFTW wisdom cache file, or NULL to always plan with measurements.
  * @return The initialized FFT module interface.
  */
-fft_t* FFT__initialize(int frame_count, int sample_rate);
+fft_t* FFT__initialize(int frame_count, float sample_rate, const char* wisdom_path);
+
+/**
+ * Plans the FFT of the given size with measurements and saves the resulting wisdom into the cache file,
+ * so later initializations with this cache are both fast and optimal.
+ *
+ * @param frame_count The samples size to plan for.
+ * @param wisdom_path The FFTW wisdom cache file to update.
+ * @return 0 On Success, -1 On Failure.
+ */
+int FFT__warm_wisdom(int frame_count, const char* wisdom_path);
 
 /**
  * Frees a previously allocated FFT interface initialized with FFT__initialize.
@@ -50,5 +67,24 @@ int FFT__calculate(
         struct frequency_and_magnitude** frequencies, size_t* out_length
 );
 
+/**
+ * Preforms the FFT calculation of the given sample data without any allocation.
+ * The results are written into an aligned output buffer owned by the FFT interface.
+ * When the sample buffer is aligned like FFTW's own buffers it's transformed directly, without copying it.
+ *
+ * @param fft The FFT interface.
+ * @param sample The raw sample data.
+ * @param frame_count The size of the sample data.
+ * @param squared Whether to output squared magnitudes (power), skipping the per-bin square root.
+ * @param frequencies Returns the calculated frequencies array - owned by the FFT interface, valid until the next call.
+ * @param out_length Returns the size of the frequencies array.
+ * @return 0 On Success, negative on failure.
+ */
+int FFT__execute(
+        fft_t* fft,
+        const float* sample, size_t frame_count, bool squared,
+        struct frequency_and_magnitude** frequencies, size_t* out_length
+);
+
 
 #endif //AUDIONET_FFT_H
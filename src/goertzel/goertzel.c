@@ -0,0 +1,124 @@
+#include <math.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "goertzel.h"
+#include "utils/logger.h"
+#include "utils/vector.h"
+
+struct goertzel_s {
+    /** The expected frame count for the bank to process */
+    int frame_count;
+
+    /** The amount of frequencies in the bank */
+    size_t frequencies_count;
+
+    /** The amount of vectors the bank is evaluated in, the last one may be padded */
+    size_t vectors_count;
+
+    /** The Goertzel recurrence coefficient (2cos(w)) of each frequency, padded lanes are 0 */
+    float_vector_t* coefficients;
+
+    /** The frequencies of the bank */
+    float* frequencies;
+
+    /** The output buffer, refilled on every calculation */
+    struct frequency_and_magnitude* output;
+};
+
+goertzel_t* GOERTZEL__initialize(int frame_count, float sample_rate, size_t frequencies_count, const float* frequencies) {
+    /* Validate parameters */
+    if (frame_count <= 0 || sample_rate <= 0 || frequencies_count == 0 || frequencies == NULL) {
+        LOG_ERROR("Invalid goertzel parameters");
+        return NULL;
+    }
+
+    /* Allocate the filter bank object */
+    goertzel_t* goertzel = malloc(sizeof(goertzel_t));
+    if (goertzel == NULL) {
+        LOG_ERROR("Failed to allocate goertzel struct");
+        return NULL;
+    }
+
+    /* Set the state */
+    goertzel->frame_count = frame_count;
+    goertzel->frequencies_count = frequencies_count;
+    goertzel->vectors_count = FLOAT_VECTOR_PADDED(frequencies_count) / FLOAT_VECTOR_LANES;
+    goertzel->frequencies = NULL;
+    goertzel->output = NULL;
+
+    /* Allocate the coefficients, aligned for vector loads */
+    goertzel->coefficients = aligned_alloc(FLOAT_VECTOR_ALIGNMENT, goertzel->vectors_count * sizeof(float_vector_t));
+    if (goertzel->coefficients == NULL) {
+        LOG_ERROR("Failed to allocate goertzel coefficients");
+        free(goertzel);
+        return NULL;
+    }
+
+    /* Allocate the frequencies and output buffers */
+    goertzel->frequencies = malloc(frequencies_count * sizeof(float));
+    goertzel->output = malloc(frequencies_count * sizeof(struct frequency_and_magnitude));
+    if (goertzel->frequencies == NULL || goertzel->output == NULL) {
+        LOG_ERROR("Failed to allocate goertzel output buffer");
+        GOERTZEL__free(goertzel);
+        return NULL;
+    }
+
+    /* Pre-calculate the coefficient of each frequency, the padding lanes stay zero (a bounded recurrence). */
+    float* coefficients = (float*)goertzel->coefficients;
+    memset(coefficients, 0, goertzel->vectors_count * sizeof(float_vector_t));
+    for (size_t i = 0; i < frequencies_count; ++i) {
+        coefficients[i] = (float)(2.0 * cos(2.0 * M_PI * frequencies[i] / sample_rate));
+        goertzel->frequencies[i] = frequencies[i];
+    }
+
+    return goertzel;
+}
+
+void GOERTZEL__free(goertzel_t* goertzel) {
+    if (goertzel == NULL) {
+        return;
+    }
+
+    free(goertzel->output);
+    free(goertzel->frequencies);
+    free(goertzel->coefficients);
+    free(goertzel);
+}
+
+int GOERTZEL__calculate(goertzel_t* goertzel, const float* sample, size_t frame_count, struct frequency_and_magnitude** frequencies, size_t* out_length) {
+    /* Validate the parameters fit the planned configuration */
+    if (frame_count != goertzel->frame_count) {
+        LOG_ERROR("Goertzel expected %d frames, got %zu", goertzel->frame_count, frame_count);
+        return -1;
+    }
+
+    float powers[goertzel->vectors_count * FLOAT_VECTOR_LANES];
+    for (size_t v = 0; v < goertzel->vectors_count; ++v) {
+        /* Run the recurrence s[n] = x[n] + 2cos(w)s[n-1] - s[n-2] for a whole vector of frequencies at once. */
+        float_vector_t coefficient = goertzel->coefficients[v];
+        float_vector_t s1 = {0};
+        float_vector_t s2 = {0};
+        for (size_t n = 0; n < frame_count; ++n) {
+            float_vector_t s0 = coefficient * s1 - s2 + sample[n];
+            s2 = s1;
+            s1 = s0;
+        }
+
+        /* The DFT power at each frequency is |X|^2 = s1^2 + s2^2 - 2cos(w)s1s2. */
+        float_vector_t power = s1 * s1 + s2 * s2 - coefficient * s1 * s2;
+        memcpy(&powers[v * FLOAT_VECTOR_LANES], &power, sizeof(power));
+    }
+
+    /* Export the magnitudes, the frequencies are rewritten as well since the user may reorder the output. */
+    for (size_t i = 0; i < goertzel->frequencies_count; ++i) {
+        goertzel->output[i].frequency = goertzel->frequencies[i];
+        goertzel->output[i].magnitude = sqrtf(fmaxf(powers[i], 0));
+    }
+
+    *out_length = goertzel->frequencies_count;
+    *frequencies = goertzel->output;
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef AUDIONET_GOERTZEL_H
+#define AUDIONET_GOERTZEL_H
+
+#include <stddef.h>
+
+#include "fft/fft.h"
+
+/**
+ * The Goertzel filter bank interface type.
+ * Evaluates the spectrum only at a fixed set of frequencies, instead of every FFT bin.
+ */
+typedef struct goertzel_s goertzel_t;
+
+/**
+ * Initializes a Goertzel filter bank.
+ *
+ * @param frame_count The expected samples size.
+ * @param sample_rate The expected samples rate.
+ * @param frequencies_count The amount of frequencies in the bank.
+ * @param frequencies The frequencies to evaluate.
+ * @return The initialized filter bank interface, or NULL on failure.
+ */
+goertzel_t* GOERTZEL__initialize(int frame_count, float sample_rate, size_t frequencies_count, const float* frequencies);
+
+/**
+ * Frees a previously allocated filter bank initialized with GOERTZEL__initialize.
+ *
+ * @param goertzel The filter bank to free.
+ */
+void GOERTZEL__free(goertzel_t* goertzel);
+
+/**
+ * Runs the filter bank over the given sample data and outputs the magnitude at each of the bank's frequencies.
+ * The magnitudes share the scale of `FFT__calculate` (unnormalized DFT), so the same thresholds apply.
+ *
+ * @param goertzel The filter bank interface.
+ * @param sample The raw sample data.
+ * @param frame_count The size of the sample data.
+ * @param frequencies Returns the frequencies array - owned by the filter bank, valid until the next call.
+ * @param out_length Returns the size of the frequencies array.
+ * @return 0 On Success, negative on failure.
+ */
+int GOERTZEL__calculate(
+        goertzel_t* goertzel,
+        const float* sample, size_t frame_count,
+        struct frequency_and_magnitude** frequencies, size_t* out_length
+);
+
+#endif //AUDIONET_GOERTZEL_H
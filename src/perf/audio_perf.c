@@ -0,0 +1,290 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "audio_perf.h"
+#include "utils/logger.h"
+
+/** The default length of each message. */
+#define DEFAULT_MESSAGE_SIZE (64)
+
+/** The default amount of messages sent. */
+#define DEFAULT_MESSAGES_COUNT (100)
+
+/** The amount of samples streamed at once from or to the WAV file (10 milliseconds). */
+#define WAV_BLOCK_SIZE (480)
+
+/** The names of the socket layers, as given to the `--layer` option. */
+static const char* LAYER_NAMES[] = {
+    [AUDIO_LAYER_PHYSICAL] = "physical",
+    [AUDIO_LAYER_LINK] = "link",
+    [AUDIO_LAYER_TRANSPORT] = "transport",
+};
+
+void AUDIO_PERF__get_default_options(struct audio_perf_options* options) {
+    options->layer = AUDIO_LAYER_TRANSPORT;
+    options->message_size = DEFAULT_MESSAGE_SIZE;
+    options->messages_count = DEFAULT_MESSAGES_COUNT;
+    options->parity_bytes = 0;
+    options->window_size = TRANSPORT_LAYER_DEFAULT_WINDOW_SIZE;
+    options->wav_path = NULL;
+    options->speed = 1;
+}
+
+/**
+ * Parses a positive integer option value.
+ *
+ * @param value The value.
+ * @param result Returns the parsed value.
+ * @return 0 On Success, -1 if the value isn't a positive integer.
+ */
+static int parse_positive(const char* value, unsigned long* result) {
+    char* end;
+    *result = strtoul(value, &end, 10);
+    return (*value != '\0' && *value != '-' && *end == '\0' && *result > 0) ? 0 : -1;
+}
+
+int AUDIO_PERF__parse_option(struct audio_perf_options* options, const char* name, const char* value) {
+    unsigned long number;
+
+    if (strcmp(name, "--layer") == 0) {
+        for (size_t i = 0; i < sizeof(LAYER_NAMES) / sizeof(LAYER_NAMES[0]); ++i) {
+            if (strcmp(value, LAYER_NAMES[i]) == 0) {
+                options->layer = (enum audio_socket_layer)i;
+                return 0;
+            }
+        }
+        return -1;
+    } else if (strcmp(name, "--size") == 0) {
+        if (parse_positive(value, &number) != 0 || number < AUDIO_PERF_MIN_MESSAGE_SIZE) {
+            return -1;
+        }
+        options->message_size = number;
+    } else if (strcmp(name, "--count") == 0) {
+        if (parse_positive(value, &number) != 0 || number > UINT32_MAX) {
+            return -1;
+        }
+        options->messages_count = (uint32_t)number;
+    } else if (strcmp(name, "--parity") == 0) {
+        /* Parity may be 0, which disables the error correction. */
+        if (strcmp(value, "0") == 0) {
+            options->parity_bytes = 0;
+        } else if (parse_positive(value, &number) != 0 || number > LINK_LAYER_MAX_PARITY_BYTES) {
+            return -1;
+        } else {
+            options->parity_bytes = (uint32_t)number;
+        }
+    } else if (strcmp(name, "--window") == 0) {
+        if (parse_positive(value, &number) != 0 || number > TRANSPORT_LAYER_MAX_WINDOW_SIZE) {
+            return -1;
+        }
+        options->window_size = (uint32_t)number;
+    } else if (strcmp(name, "--wav") == 0) {
+        options->wav_path = value;
+    } else if (strcmp(name, "--speed") == 0) {
+        options->speed = strtof(value, NULL);
+        if (!(options->speed > 0)) {
+            return -1;
+        }
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+const char* AUDIO_PERF__get_layer_name(enum audio_socket_layer layer) {
+    return LAYER_NAMES[layer];
+}
+
+audio_socket_t* AUDIO_PERF__initialize_socket(const struct audio_perf_options* options, bool is_sender,
+                                              struct audio_wav_config* wav_config, audio_medium_t* medium) {
+    struct audio_socket_config config;
+    AUDIO_SOCKET__get_default_config(&config);
+    config.layer = options->layer;
+    config.link.parity_bytes = options->parity_bytes;
+    config.transport.window_size = options->window_size;
+
+    /* The sender writes it's playback into the WAV file, the receiver replays it as the recording. */
+    if (medium != NULL) {
+        config.physical.audio_medium = medium;
+    } else if (options->wav_path != NULL) {
+        wav_config->sample_rate = SAMPLE_RATE_48000;
+        wav_config->capture_path = is_sender ? NULL : options->wav_path;
+        wav_config->playback_path = is_sender ? options->wav_path : NULL;
+        wav_config->speed = options->speed;
+        wav_config->block_size = WAV_BLOCK_SIZE;
+        wav_config->drop_while_playing = false;
+        config.physical.audio_wav = wav_config;
+    }
+
+    audio_socket_t* socket = AUDIO_SOCKET__initialize(&config);
+    if (socket == NULL) {
+        LOG_ERROR("Failed to initialize socket");
+        return NULL;
+    }
+
+    if (options->message_size > AUDIO_SOCKET__get_mtu(socket)) {
+        LOG_ERROR("Message size %zu exceeds the %s layer MTU of %zu", options->message_size,
+                  AUDIO_PERF__get_layer_name(options->layer), AUDIO_SOCKET__get_mtu(socket));
+        AUDIO_SOCKET__free(socket);
+        return NULL;
+    }
+
+    return socket;
+}
+
+uint32_t AUDIO_PERF__send_messages(const struct audio_perf_options* options, audio_socket_t* socket,
+                                   uint8_t* message, double* latencies) {
+    uint32_t messages_sent = 0;
+    for (uint32_t sequence = 0; sequence < options->messages_count; ++sequence) {
+        double send_start = AUDIO_PERF__monotonic_seconds();
+        AUDIO_PERF__fill_message(message, options->message_size, sequence, AUDIO_PERF__realtime_nanoseconds());
+        if (AUDIO_SOCKET__send(socket, message, options->message_size) != 0) {
+            LOG_ERROR("Failed to send message %u", sequence);
+            continue;
+        }
+        latencies[messages_sent++] = AUDIO_PERF__monotonic_seconds() - send_start;
+    }
+
+    return messages_sent;
+}
+
+double AUDIO_PERF__monotonic_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+uint64_t AUDIO_PERF__realtime_nanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+void AUDIO_PERF__fill_message(uint8_t* message, size_t size, uint32_t sequence, uint64_t send_nanoseconds) {
+    size_t offset = 0;
+    memcpy(message, &sequence, sizeof(sequence));
+    offset += sizeof(sequence);
+    if (size >= AUDIO_PERF_TIMED_MESSAGE_SIZE) {
+        memcpy(message + offset, &send_nanoseconds, sizeof(send_nanoseconds));
+        offset += sizeof(send_nanoseconds);
+    }
+
+    /* The pattern mixes the sequence number and the offset (SplitMix64), so every symbol value shows up. */
+    for (; offset < size; ++offset) {
+        uint64_t value = ((uint64_t)sequence << 32 | offset) + 0x9E3779B97F4A7C15ULL;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        message[offset] = (uint8_t)(value ^ (value >> 31));
+    }
+}
+
+/**
+ * Gets a symbol of a message, the bits past the end of the message are zero (the padding).
+ *
+ * @param message The message.
+ * @param size The length of the message.
+ * @param symbol_bits The amount of bits each symbol carries.
+ * @param symbol_index The index of the symbol.
+ * @return The symbol's value.
+ */
+static uint32_t get_symbol(const uint8_t* message, size_t size, uint32_t symbol_bits, size_t symbol_index) {
+    uint32_t value = 0;
+    for (size_t position = symbol_index * symbol_bits; position < (symbol_index + 1) * symbol_bits; ++position) {
+        uint32_t bit = (position / 8 < size) ? (message[position / 8] >> (7 - position % 8)) & 1 : 0;
+        value = (value << 1) | bit;
+    }
+    return value;
+}
+
+size_t AUDIO_PERF__count_symbol_errors(const uint8_t* received, size_t received_size,
+                                       const uint8_t* expected, size_t expected_size,
+                                       uint32_t symbol_bits, size_t* symbols_count) {
+    size_t errors = 0;
+    *symbols_count = (expected_size * 8 + symbol_bits - 1) / symbol_bits;
+    for (size_t i = 0; i < *symbols_count; ++i) {
+        if (i * symbol_bits >= received_size * 8 ||
+            get_symbol(received, received_size, symbol_bits, i) != get_symbol(expected, expected_size, symbol_bits, i)) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+/**
+ * Compare callback for sorting samples.
+ *
+ * @param a First sample pointer.
+ * @param b Second sample pointer.
+ * @return The order indicator between a and b.
+ */
+static int compare_samples(const double* a, const double* b) {
+    return (*a > *b) - (*a < *b);
+}
+
+/**
+ * Gets a percentile of sorted samples, by the nearest rank.
+ *
+ * @param samples The sorted samples.
+ * @param count The amount of samples, at least 1.
+ * @param percentile The percentile (0 - 100).
+ * @return The percentile's sample.
+ */
+static double get_percentile(const double* samples, size_t count, double percentile) {
+    size_t rank = (size_t)(percentile / 100 * (double)count + 0.999999);
+    return samples[(rank == 0) ? 0 : rank - 1];
+}
+
+void AUDIO_PERF__calculate_latency(double* samples, size_t count, struct audio_perf_latency* latency) {
+    memset(latency, 0, sizeof(*latency));
+    latency->count = count;
+    if (count == 0) {
+        return;
+    }
+
+    qsort(samples, count, sizeof(double), (int (*)(const void*, const void*)) compare_samples);
+    for (size_t i = 0; i < count; ++i) {
+        latency->mean += samples[i] / (double)count;
+    }
+    latency->p50 = get_percentile(samples, count, 50);
+    latency->p90 = get_percentile(samples, count, 90);
+    latency->p99 = get_percentile(samples, count, 99);
+    latency->max = samples[count - 1];
+}
+
+void AUDIO_PERF__print_latency(const struct audio_perf_latency* latency) {
+    printf("{\"count\":%zu,\"mean\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"max\":%.3f}",
+           latency->count, latency->mean * 1e3, latency->p50 * 1e3, latency->p90 * 1e3, latency->p99 * 1e3,
+           latency->max * 1e3);
+}
+
+void AUDIO_PERF__print_stats(const struct audio_socket_stats* stats) {
+    const struct physical_layer_stats* physical = &stats->physical;
+    const struct link_layer_stats* link = &stats->link;
+    const struct transport_layer_stats* transport = &stats->transport;
+
+    printf("{\"physical\":{\"capture_callbacks\":%" PRIu64 ",\"capture_overrun_samples\":%" PRIu64 ","
+           "\"capture_queue_max_depth\":%" PRIu64 ",\"capture_callback_max_nanoseconds\":%" PRIu64 ","
+           "\"windows_decoded\":%" PRIu64 ",\"frames_received\":%" PRIu64 ",\"frame_ring_max_depth\":%" PRIu64 ","
+           "\"frame_ring_overflows\":%" PRIu64 ",\"symbols_received\":%" PRIu64 ",\"symbols_erased\":%" PRIu64 ","
+           "\"symbol_bits\":%u},",
+           physical->capture_callbacks, physical->capture_overrun_samples, physical->capture_queue_max_depth,
+           physical->capture_callback_max_nanoseconds, physical->windows_decoded, physical->frames_received,
+           physical->frame_ring_max_depth, physical->frame_ring_overflows, physical->symbols_received,
+           physical->symbols_erased, physical->symbol_bits);
+    printf("\"link\":{\"packets_sent\":%" PRIu64 ",\"frames_sent\":%" PRIu64 ",\"packets_received\":%" PRIu64 ","
+           "\"packets_out_of_sync\":%" PRIu64 ",\"packets_uncorrectable\":%" PRIu64 ","
+           "\"packets_crc_mismatch\":%" PRIu64 ",\"bytes_corrected\":%" PRIu64 "},",
+           link->packets_sent, link->frames_sent, link->packets_received, link->packets_out_of_sync,
+           link->packets_uncorrectable, link->packets_crc_mismatch, link->bytes_corrected);
+    printf("\"transport\":{\"messages_sent\":%" PRIu64 ",\"packets_sent\":%" PRIu64 ","
+           "\"packets_retransmitted\":%" PRIu64 ",\"polls_sent\":%" PRIu64 ",\"selective_acks_received\":%" PRIu64 ","
+           "\"polls_unanswered\":%" PRIu64 ",\"messages_received\":%" PRIu64 ",\"packets_received\":%" PRIu64 ","
+           "\"duplicate_packets_received\":%" PRIu64 ",\"acks_sent\":%" PRIu64 "}}",
+           transport->messages_sent, transport->packets_sent, transport->packets_retransmitted, transport->polls_sent,
+           transport->selective_acks_received, transport->polls_unanswered, transport->messages_received,
+           transport->packets_received, transport->duplicate_packets_received, transport->acks_sent);
+}
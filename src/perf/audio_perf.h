@@ -0,0 +1,194 @@
+/**
+ * Defines the shared parts of the AudioPerf client and server.
+ * The client sends numbered messages of a configurable size through the audio socket, the server receives them,
+ * and each side reports goodput, latency percentiles and the socket's counters as a single JSON line.
+ *
+ * Each message starts with it's sequence number (uint32_t), followed by the sender's wall clock time in nanoseconds
+ * (uint64_t) if the message is long enough, the rest is a pattern generated from the sequence number,
+ * so the server can regenerate every message and count the symbols it got wrong.
+ */
+
+#ifndef AUDIONET_AUDIO_PERF_H
+#define AUDIONET_AUDIO_PERF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "audio/audio.h"
+#include "audio/audio_medium.h"
+#include "audio_socket/audio_socket.h"
+
+/** The shortest message, it must carry the sequence number. */
+#define AUDIO_PERF_MIN_MESSAGE_SIZE (sizeof(uint32_t))
+
+/** The shortest message carrying the sender's time, shorter messages have no one-way latency. */
+#define AUDIO_PERF_TIMED_MESSAGE_SIZE (sizeof(uint32_t) + sizeof(uint64_t))
+
+/** The usage string of the options shared by the client and server */
+#define AUDIO_PERF_OPTIONS_USAGE \
+    "[--layer physical|link|transport] [--size <bytes>] [--count <messages>] [--parity <bytes>] " \
+    "[--window <packets>] [--wav <path> [--speed <factor>]]"
+
+/**
+ * The options shared by the client and server, both peers must be given the same options.
+ */
+struct audio_perf_options {
+    /** The layer the socket operates at. */
+    enum audio_socket_layer layer;
+
+    /** The length of each message. */
+    size_t message_size;
+
+    /** The amount of messages sent. */
+    uint32_t messages_count;
+
+    /** The amount of link layer parity bytes per codeword. */
+    uint32_t parity_bytes;
+
+    /** The transport layer window. */
+    uint32_t window_size;
+
+    /** A WAV file used instead of the sound card (the client's playback, the server's capture), or NULL. */
+    const char* wav_path;
+
+    /** How many times faster than real time the WAV file is streamed (or a real time medium runs). */
+    float speed;
+};
+
+/**
+ * Latency percentiles of a set of samples.
+ */
+struct audio_perf_latency {
+    /** The amount of samples. */
+    size_t count;
+
+    /** The mean sample, in seconds. */
+    double mean;
+
+    /** The median sample, in seconds. */
+    double p50;
+
+    /** The 90th percentile sample, in seconds. */
+    double p90;
+
+    /** The 99th percentile sample, in seconds. */
+    double p99;
+
+    /** The largest sample, in seconds. */
+    double max;
+};
+
+/**
+ * Fills the options with the defaults.
+ *
+ * @param options The options to fill.
+ */
+void AUDIO_PERF__get_default_options(struct audio_perf_options* options);
+
+/**
+ * Parses a shared option.
+ *
+ * @param options The options to update.
+ * @param name The option's name.
+ * @param value The option's value.
+ * @return 0 On Success, -1 if the option is unknown or it's value is invalid.
+ */
+int AUDIO_PERF__parse_option(struct audio_perf_options* options, const char* name, const char* value);
+
+/**
+ * Gets the name of a socket layer, as given to the `--layer` option.
+ *
+ * @param layer The layer.
+ * @return The layer's name.
+ */
+const char* AUDIO_PERF__get_layer_name(enum audio_socket_layer layer);
+
+/**
+ * Initializes a socket by the options.
+ *
+ * @param options The options.
+ * @param is_sender Whether the socket sends the messages, choosing which side of the WAV file it streams.
+ * @param wav_config Holds the WAV backend configuration, it must outlive the socket.
+ * @param medium A simulated medium to connect the socket to instead of the sound card (or the WAV file), or NULL.
+ * @return The initialized socket, or NULL on failure.
+ */
+audio_socket_t* AUDIO_PERF__initialize_socket(const struct audio_perf_options* options, bool is_sender,
+                                              struct audio_wav_config* wav_config, audio_medium_t* medium);
+
+/**
+ * Sends the numbered messages back to back, a failed message is counted and skipped.
+ *
+ * @param options The options.
+ * @param socket The socket to send the messages over.
+ * @param message A buffer for the message, of the message size.
+ * @param latencies Returns the time each successful send took in seconds, holds the amount of messages.
+ * @return The amount of messages sent successfully.
+ */
+uint32_t AUDIO_PERF__send_messages(const struct audio_perf_options* options, audio_socket_t* socket,
+                                   uint8_t* message, double* latencies);
+
+/**
+ * Gets the current monotonic time.
+ *
+ * @return The monotonic time in seconds.
+ */
+double AUDIO_PERF__monotonic_seconds(void);
+
+/**
+ * Gets the current wall clock time, comparable between the client and server hosts (given synchronized clocks).
+ *
+ * @return The wall clock time in nanoseconds.
+ */
+uint64_t AUDIO_PERF__realtime_nanoseconds(void);
+
+/**
+ * Fills a message.
+ *
+ * @param message The message buffer.
+ * @param size The length of the message, at least `AUDIO_PERF_MIN_MESSAGE_SIZE`.
+ * @param sequence The message's sequence number.
+ * @param send_nanoseconds The sender's wall clock time, written if the message is long enough.
+ */
+void AUDIO_PERF__fill_message(uint8_t* message, size_t size, uint32_t sequence, uint64_t send_nanoseconds);
+
+/**
+ * Counts the symbols of a received message that differ from the expected message.
+ * The messages are split into symbols of `symbol_bits` bits as the physical layer sends them (most significant first),
+ * expected symbols past the end of the received message count as errors.
+ *
+ * @param received The received message.
+ * @param received_size The length of the received message.
+ * @param expected The expected message.
+ * @param expected_size The length of the expected message.
+ * @param symbol_bits The amount of bits each symbol carries.
+ * @param symbols_count Returns the amount of symbols in the expected message.
+ * @return The amount of wrong symbols.
+ */
+size_t AUDIO_PERF__count_symbol_errors(const uint8_t* received, size_t received_size,
+                                       const uint8_t* expected, size_t expected_size,
+                                       uint32_t symbol_bits, size_t* symbols_count);
+
+/**
+ * Calculates the latency percentiles of a set of samples.
+ *
+ * @param samples The samples in seconds, sorted in place.
+ * @param count The amount of samples.
+ * @param latency Returns the percentiles, all zero if there are no samples.
+ */
+void AUDIO_PERF__calculate_latency(double* samples, size_t count, struct audio_perf_latency* latency);
+
+/**
+ * Prints latency percentiles as a JSON object in milliseconds.
+ *
+ * @param latency The percentiles.
+ */
+void AUDIO_PERF__print_latency(const struct audio_perf_latency* latency);
+
+/**
+ * Prints the socket's counters as a JSON object, by layer.
+ *
+ * @param stats The counters.
+ */
+void AUDIO_PERF__print_stats(const struct audio_socket_stats* stats);
+
+#endif //AUDIONET_AUDIO_PERF_H
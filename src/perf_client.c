@@ -0,0 +1,107 @@
+#include <inttypes.h>
+#include <malloc.h>
+#include <stdio.h>
+#include "utils/logger.h"
+#include "audio_socket/audio_socket.h"
+#include "perf/audio_perf.h"
+
+/** The usage string of the program */
+#define USAGE "AudioPerfClient " AUDIO_PERF_OPTIONS_USAGE
+
+/**
+ * Prints the results of the run as a single line JSON object.
+ *
+ * @param options The run's options.
+ * @param messages_sent The amount of messages sent successfully.
+ * @param seconds The duration of the run.
+ * @param latency The send latency percentiles.
+ * @param stats The socket's counters at the end of the run.
+ */
+static void print_results(const struct audio_perf_options* options, uint32_t messages_sent, double seconds,
+                          const struct audio_perf_latency* latency, const struct audio_socket_stats* stats) {
+    uint64_t packets_sent = stats->transport.packets_sent;
+    uint64_t retransmissions = stats->transport.packets_retransmitted;
+
+    printf("{\"role\":\"client\",\"layer\":\"%s\",\"message_size\":%zu,\"messages_count\":%u,\"parity_bytes\":%u,"
+           "\"window_size\":%u,\"messages_sent\":%u,\"send_failures\":%u,\"seconds\":%.6f,\"goodput_bps\":%.1f,"
+           "\"retransmissions\":%" PRIu64 ",\"retransmission_rate\":%.6f,\"send_latency_ms\":",
+           AUDIO_PERF__get_layer_name(options->layer), options->message_size, options->messages_count,
+           options->parity_bytes, options->window_size, messages_sent, options->messages_count - messages_sent,
+           seconds, (seconds > 0) ? (double)messages_sent * (double)options->message_size * 8 / seconds : 0,
+           retransmissions, (packets_sent > 0) ? (double)retransmissions / (double)packets_sent : 0);
+    AUDIO_PERF__print_latency(latency);
+    printf(",\"stats\":");
+    AUDIO_PERF__print_stats(stats);
+    printf("}\n");
+}
+
+/**
+ * Main function for the performance client program.
+ * Sends numbered messages to the performance server as fast as the socket allows,
+ * then prints the goodput, the retransmissions, the send latency percentiles (the time each send call took,
+ * until acked at the transport layer) and the socket's counters as a single JSON line.
+ *
+ * @param argc The number of arguments to the program, an odd value.
+ * @param argv The arguments to the program (including the program name), pairs of an option and it's value.
+ * @return 0 On Success, -1 On Failure.
+ */
+int main(int argc, char *argv[]) {
+    int status;
+    audio_socket_t* socket = NULL;
+    uint8_t* message = NULL;
+    double* latencies = NULL;
+    struct audio_wav_config wav_config;
+
+    /* Parse the arguments. */
+    struct audio_perf_options options;
+    AUDIO_PERF__get_default_options(&options);
+    if (argc % 2 == 0) {
+        printf(USAGE "\n");
+        return -1;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        if (AUDIO_PERF__parse_option(&options, argv[i], argv[i + 1]) != 0) {
+            printf(USAGE "\n");
+            return -1;
+        }
+    }
+
+    /* Initialize the client socket. */
+    socket = AUDIO_PERF__initialize_socket(&options, true, &wav_config, NULL);
+    if (socket == NULL) {
+        status = -1;
+        goto l_cleanup;
+    }
+
+    message = malloc(options.message_size);
+    latencies = malloc(options.messages_count * sizeof(double));
+    if (message == NULL || latencies == NULL) {
+        LOG_ERROR("Failed to allocate messages");
+        status = -1;
+        goto l_cleanup;
+    }
+
+    /* Send the messages back to back. */
+    double start = AUDIO_PERF__monotonic_seconds();
+    uint32_t messages_sent = AUDIO_PERF__send_messages(&options, socket, message, latencies);
+    double seconds = AUDIO_PERF__monotonic_seconds() - start;
+
+    /* Output the results. */
+    struct audio_socket_stats stats;
+    struct audio_perf_latency latency;
+    AUDIO_SOCKET__get_stats(socket, &stats);
+    AUDIO_PERF__calculate_latency(latencies, messages_sent, &latency);
+    print_results(&options, messages_sent, seconds, &latency, &stats);
+
+    status = (messages_sent == options.messages_count) ? 0 : -1;
+
+l_cleanup:
+    /* Free the audio socket */
+    if (socket != NULL) {
+        AUDIO_SOCKET__free(socket);
+    }
+    free(message);
+    free(latencies);
+
+    return status;
+}
@@ -0,0 +1,398 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <malloc.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/logger.h"
+#include "utils/utils.h"
+#include "audio_socket/audio_socket.h"
+#include "perf/audio_perf.h"
+
+/** The argument for choosing how long to wait for the next message */
+#define IDLE_TIMEOUT_ARGUMENT "--idle-timeout"
+
+/** The argument for running the client in-process, over a simulated medium */
+#define MEDIUM_ARGUMENT "--medium"
+
+/** The usage string of the program */
+#define USAGE "AudioPerfServer [" IDLE_TIMEOUT_ARGUMENT " <seconds>] [" MEDIUM_ARGUMENT " realtime|lockstep] " \
+        AUDIO_PERF_OPTIONS_USAGE
+
+/** The default time without any received frame after which the run ends. */
+#define DEFAULT_IDLE_SECONDS (10)
+
+/** How often the server checks whether the in-process client is done, while waiting for it. */
+#define CLIENT_POLL_MILLISECONDS (10)
+
+/**
+ * The simulated medium modes, as given to the `--medium` option.
+ */
+enum medium_mode {
+    /** No medium, the client is a separate process. */
+    MEDIUM_NONE,
+
+    /** The medium runs on the wall clock, `--speed` times faster than real time. */
+    MEDIUM_REALTIME,
+
+    /** The medium runs in lock-step with the sockets, for reproducible runs. */
+    MEDIUM_LOCK_STEP,
+};
+
+/**
+ * A client sending the messages from a thread of the server, over the simulated medium.
+ */
+struct in_process_client {
+    /** The run's options. */
+    const struct audio_perf_options* options;
+
+    /** The client's socket, connected to the medium before the run starts so the medium's clock won't run ahead. */
+    audio_socket_t* socket;
+
+    /** The client thread. */
+    pthread_t thread;
+
+    /** Set once the client has sent every message and freed it's socket. */
+    atomic_bool is_done;
+
+    /** The amount of messages the client sent successfully. */
+    uint32_t messages_sent;
+};
+
+/**
+ * The results of a run.
+ */
+struct receive_results {
+    /** The sequence number expected next. */
+    uint32_t next_sequence;
+
+    /** The amount of messages received. */
+    uint32_t messages_received;
+
+    /** The amount of messages received exactly as sent. */
+    uint32_t messages_intact;
+
+    /** The amount of receives that failed (e.g a corrupted packet dropped by the link layer). */
+    uint32_t receive_failures;
+
+    /** The amount of symbols of the received messages. */
+    size_t symbols_count;
+
+    /** The amount of wrong symbols in the received messages. */
+    size_t symbol_errors;
+
+    /** The wall clock time the first message was sent, or received if it's time is unknown. */
+    uint64_t start_nanoseconds;
+
+    /** The wall clock time the last message was received. */
+    uint64_t end_nanoseconds;
+
+    /** The one-way latency of each intact message carrying it's send time. */
+    double* latencies;
+
+    /** The amount of latencies. */
+    size_t latencies_count;
+};
+
+/**
+ * Checks a received message against the message expected by it's sequence number.
+ * A message whose sequence number is corrupted (or that's too short to carry it) is taken as the next expected one.
+ *
+ * @param options The run's options.
+ * @param results The results to update.
+ * @param message The received message.
+ * @param length The length of the received message.
+ * @param expected A buffer for the expected message, of the message size.
+ * @param symbol_bits The amount of bits each physical layer symbol carries.
+ */
+static void check_message(const struct audio_perf_options* options, struct receive_results* results,
+                          const uint8_t* message, size_t length, uint8_t* expected, uint32_t symbol_bits) {
+    uint64_t receive_nanoseconds = AUDIO_PERF__realtime_nanoseconds();
+    uint32_t sequence = UINT32_MAX;
+    uint64_t send_nanoseconds = 0;
+
+    /* Read the sequence number and send time. */
+    if (length >= AUDIO_PERF_MIN_MESSAGE_SIZE) {
+        memcpy(&sequence, message, sizeof(sequence));
+    }
+    if (length >= AUDIO_PERF_TIMED_MESSAGE_SIZE) {
+        memcpy(&send_nanoseconds, message + sizeof(sequence), sizeof(send_nanoseconds));
+    }
+    if (sequence >= options->messages_count || sequence < results->next_sequence) {
+        LOG_DEBUG("Corrupted sequence %u, taken as %u", sequence, results->next_sequence);
+        sequence = min(results->next_sequence, options->messages_count - 1);
+    }
+    results->next_sequence = sequence + 1;
+    results->messages_received++;
+
+    /* Compare the message to the expected one, the send time can't be regenerated so it's taken as received. */
+    size_t symbols_count;
+    AUDIO_PERF__fill_message(expected, options->message_size, sequence, send_nanoseconds);
+    results->symbol_errors += AUDIO_PERF__count_symbol_errors(message, length, expected, options->message_size,
+                                                              symbol_bits, &symbols_count);
+    results->symbols_count += symbols_count;
+
+    bool is_intact = (length == options->message_size && memcmp(message, expected, length) == 0);
+    if (results->messages_received == 1) {
+        results->start_nanoseconds = (is_intact && send_nanoseconds != 0) ? send_nanoseconds : receive_nanoseconds;
+    }
+    results->end_nanoseconds = receive_nanoseconds;
+    if (is_intact) {
+        results->messages_intact++;
+        if (send_nanoseconds != 0) {
+            results->latencies[results->latencies_count++] = (double)(int64_t)(receive_nanoseconds - send_nanoseconds) / 1e9;
+        }
+    }
+}
+
+/**
+ * The in-process client thread, sends the messages as the AudioPerf client would.
+ * The socket is freed once done, so a lock-step medium no longer waits for it.
+ *
+ * @param context The in-process client.
+ * @return Always NULL.
+ */
+static void* client_thread_main(void* context) {
+    struct in_process_client* client = context;
+    double* latencies = NULL;
+
+    uint8_t* message = malloc(client->options->message_size);
+    latencies = malloc(client->options->messages_count * sizeof(double));
+    if (message == NULL || latencies == NULL) {
+        LOG_ERROR("Failed to allocate messages");
+        goto l_cleanup;
+    }
+
+    client->messages_sent = AUDIO_PERF__send_messages(client->options, client->socket, message, latencies);
+    LOG_INFO("In-process client sent %u messages", client->messages_sent);
+
+l_cleanup:
+    AUDIO_SOCKET__free(client->socket);
+    client->socket = NULL;
+    free(message);
+    free(latencies);
+    atomic_store(&client->is_done, true);
+
+    return NULL;
+}
+
+/**
+ * Waits for the in-process client to finish, receiving (and dropping) whatever arrives meanwhile,
+ * so the acks to it's last messages are played and a lock-step medium isn't held by the server's socket.
+ *
+ * @param socket The server's socket.
+ * @param client The in-process client.
+ * @param buffer A receive buffer.
+ * @param buffer_size The size of the receive buffer.
+ */
+static void wait_client(audio_socket_t* socket, struct in_process_client* client, uint8_t* buffer, size_t buffer_size) {
+    struct pollfd ready = {.fd = AUDIO_SOCKET__get_ready_fd(socket), .events = POLLIN};
+    while (!atomic_load(&client->is_done)) {
+        if (AUDIO_SOCKET__recv_nonblocking(socket, buffer, buffer_size) == RECV_WOULD_BLOCK_RET_CODE) {
+            (void)poll(&ready, 1, CLIENT_POLL_MILLISECONDS);
+        }
+    }
+}
+
+/**
+ * Prints the results of the run as a single line JSON object.
+ *
+ * @param options The run's options.
+ * @param results The run's results.
+ * @param latency The one-way latency percentiles.
+ * @param stats The socket's counters at the end of the run.
+ */
+static void print_results(const struct audio_perf_options* options, const struct receive_results* results,
+                          const struct audio_perf_latency* latency, const struct audio_socket_stats* stats) {
+    double seconds = (double)(results->end_nanoseconds - results->start_nanoseconds) / 1e9;
+    uint64_t symbols_received = stats->physical.symbols_received;
+
+    printf("{\"role\":\"server\",\"layer\":\"%s\",\"message_size\":%zu,\"messages_count\":%u,\"parity_bytes\":%u,"
+           "\"window_size\":%u,\"messages_received\":%u,\"messages_intact\":%u,\"messages_lost\":%u,"
+           "\"receive_failures\":%u,\"seconds\":%.6f,\"goodput_bps\":%.1f,\"duplicate_packets\":%" PRIu64 ","
+           "\"symbol_bits\":%u,\"symbols_count\":%zu,\"symbol_errors\":%zu,\"symbol_error_rate\":%.6f,"
+           "\"symbol_erasure_rate\":%.6f,\"one_way_latency_ms\":",
+           AUDIO_PERF__get_layer_name(options->layer), options->message_size, options->messages_count,
+           options->parity_bytes, options->window_size, results->messages_received, results->messages_intact,
+           options->messages_count - min(results->messages_received, options->messages_count),
+           results->receive_failures, seconds,
+           (seconds > 0) ? (double)results->messages_intact * (double)options->message_size * 8 / seconds : 0,
+           stats->transport.duplicate_packets_received, stats->physical.symbol_bits, results->symbols_count,
+           results->symbol_errors,
+           (results->symbols_count > 0) ? (double)results->symbol_errors / (double)results->symbols_count : 0,
+           (symbols_received > 0) ? (double)stats->physical.symbols_erased / (double)symbols_received : 0);
+    AUDIO_PERF__print_latency(latency);
+    printf(",\"stats\":");
+    AUDIO_PERF__print_stats(stats);
+    printf("}\n");
+}
+
+/**
+ * Main function for the performance server program.
+ * Receives the performance client's messages until the last one arrives, or no frame arrives for the idle timeout
+ * (counted from the first message, or from the start when replaying a WAV file or running the client in-process).
+ * With a simulated medium the client runs on a thread of the server, with the same options, instead of the sound card.
+ * Then prints the goodput, the lost and corrupted messages, the symbol error rate (of the received messages,
+ * so it's the residual rate the socket's layer hands up), the one-way latency percentiles and the socket's counters
+ * as a single JSON line.
+ *
+ * @param argc The number of arguments to the program, an odd value.
+ * @param argv The arguments to the program (including the program name), pairs of an option and it's value.
+ * @return 0 On Success, -1 On Failure.
+ */
+int main(int argc, char *argv[]) {
+    int status;
+    audio_socket_t* socket = NULL;
+    uint8_t* buffer = NULL;
+    uint8_t* expected = NULL;
+    audio_medium_t* medium = NULL;
+    struct audio_wav_config wav_config;
+    struct in_process_client client = {.socket = NULL, .is_done = false};
+    bool is_client_started = false;
+    struct receive_results results;
+    memset(&results, 0, sizeof(results));
+
+    /* Parse the arguments. */
+    struct audio_perf_options options;
+    int idle_seconds = DEFAULT_IDLE_SECONDS;
+    enum medium_mode medium_mode = MEDIUM_NONE;
+    AUDIO_PERF__get_default_options(&options);
+    if (argc % 2 == 0) {
+        printf(USAGE "\n");
+        return -1;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], IDLE_TIMEOUT_ARGUMENT) == 0 && atoi(argv[i + 1]) > 0) {
+            idle_seconds = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], MEDIUM_ARGUMENT) == 0 && strcmp(argv[i + 1], "realtime") == 0) {
+            medium_mode = MEDIUM_REALTIME;
+        } else if (strcmp(argv[i], MEDIUM_ARGUMENT) == 0 && strcmp(argv[i + 1], "lockstep") == 0) {
+            medium_mode = MEDIUM_LOCK_STEP;
+        } else if (AUDIO_PERF__parse_option(&options, argv[i], argv[i + 1]) != 0) {
+            printf(USAGE "\n");
+            return -1;
+        }
+    }
+    if (medium_mode != MEDIUM_NONE && options.wav_path != NULL) {
+        printf(USAGE "\n");
+        return -1;
+    }
+
+    /* Initialize the simulated medium the in-process client sends over. */
+    if (medium_mode != MEDIUM_NONE) {
+        struct audio_medium_config medium_config;
+        AUDIO_MEDIUM__get_default_config(&medium_config);
+        medium_config.speed = options.speed;
+        medium_config.lock_step = (medium_mode == MEDIUM_LOCK_STEP);
+        medium = AUDIO_MEDIUM__initialize(SAMPLE_RATE_48000, &medium_config);
+        if (medium == NULL) {
+            LOG_ERROR("Failed to initialize medium");
+            status = -1;
+            goto l_cleanup;
+        }
+    }
+
+    /* Initialize the server socket. */
+    socket = AUDIO_PERF__initialize_socket(&options, false, &wav_config, medium);
+    if (socket == NULL) {
+        status = -1;
+        goto l_cleanup;
+    }
+
+    /* The physical layer receives whole frames, so the buffer holds at least one. */
+    size_t buffer_size = max(options.message_size, PHYSICAL_LAYER_MTU);
+    buffer = malloc(buffer_size);
+    expected = malloc(options.message_size);
+    results.latencies = malloc(options.messages_count * sizeof(double));
+    if (buffer == NULL || expected == NULL || results.latencies == NULL) {
+        LOG_ERROR("Failed to allocate messages");
+        status = -1;
+        goto l_cleanup;
+    }
+
+    struct audio_socket_stats stats;
+    AUDIO_SOCKET__get_stats(socket, &stats);
+    uint32_t symbol_bits = stats.physical.symbol_bits;
+
+    /* Start the in-process client, once the server is listening. */
+    if (medium != NULL) {
+        client.options = &options;
+        client.socket = AUDIO_PERF__initialize_socket(&options, true, NULL, medium);
+        if (client.socket == NULL) {
+            status = -1;
+            goto l_cleanup;
+        }
+
+        if (pthread_create(&client.thread, NULL, client_thread_main, &client) != 0) {
+            LOG_ERROR("Failed to start the in-process client");
+            status = -1;
+            goto l_cleanup;
+        }
+        is_client_started = true;
+    }
+
+    /* Receive the messages as their frames arrive, until the last one or the idle timeout.
+     * The socket is waited on only once a receive would block, as a lock-step medium waits for that. */
+    struct pollfd ready = {.fd = AUDIO_SOCKET__get_ready_fd(socket), .events = POLLIN};
+    while (results.next_sequence < options.messages_count) {
+        ssize_t length = AUDIO_SOCKET__recv_nonblocking(socket, buffer, buffer_size);
+        if (length == RECV_WOULD_BLOCK_RET_CODE) {
+            bool is_idle_timed = results.messages_received > 0 || options.wav_path != NULL || medium != NULL;
+            int poll_ret = poll(&ready, 1, is_idle_timed ? idle_seconds * 1000 : -1);
+            if (poll_ret < 0 && errno != EINTR) {
+                LOG_ERROR("Failed to wait for the socket");
+                status = -1;
+                goto l_cleanup;
+            } else if (poll_ret == 0) {
+                LOG_WARNING("No frame received for %d seconds, ending the run", idle_seconds);
+                break;
+            }
+            continue;
+        } else if (length == -1) {
+            LOG_ERROR("Failed to recv message on socket");
+            status = -1;
+            goto l_cleanup;
+        } else if (length < 0) {
+            LOG_INFO("Dropped message: %zd", length);
+            results.receive_failures++;
+            continue;
+        }
+
+        check_message(&options, &results, buffer, (size_t)length, expected, symbol_bits);
+    }
+
+    /* Output the results. */
+    struct audio_perf_latency latency;
+    AUDIO_SOCKET__get_stats(socket, &stats);
+    AUDIO_PERF__calculate_latency(results.latencies, results.latencies_count, &latency);
+    print_results(&options, &results, &latency, &stats);
+
+    status = (results.messages_intact == options.messages_count) ? 0 : -1;
+
+    /* Let the in-process client finish it's last messages. */
+    if (is_client_started) {
+        wait_client(socket, &client, buffer, buffer_size);
+    }
+
+l_cleanup:
+    /* Free the audio socket, then the in-process client and the medium they're connected to. */
+    if (socket != NULL) {
+        AUDIO_SOCKET__free(socket);
+    }
+    if (is_client_started) {
+        pthread_join(client.thread, NULL);
+    } else if (client.socket != NULL) {
+        AUDIO_SOCKET__free(client.socket);
+    }
+    if (medium != NULL) {
+        AUDIO_MEDIUM__free(medium);
+    }
+    free(buffer);
+    free(expected);
+    free(results.latencies);
+
+    return status;
+}
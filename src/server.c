@@ -6,17 +6,34 @@
 #include "audio_socket/audio_socket.h"
 
 
+/** The argument for only warming the socket caches */
+#define WARM_CACHE_ARGUMENT "--warm-cache"
+
+/** The usage string of the program */
+#define USAGE "AudioServer [" WARM_CACHE_ARGUMENT "]"
+
 /**
  * Main function for the server example program.
  * Starts listening for incoming packets and prints them to the screen.
  *
+ * @param argc The number of arguments to the program, expected value 1 or 2.
+ * @param argv The arguments to the program (including the program name),
+ *             arg index 1 may be `WARM_CACHE_ARGUMENT` for only preparing the socket caches ahead of later runs.
  * @return 0 On Success, -1 On Failure.
  */
-int main() {
+int main(int argc, char *argv[]) {
     int status;
 
+    /* Only warm the caches if requested. */
+    if (argc == 2 && strcmp(argv[1], WARM_CACHE_ARGUMENT) == 0) {
+        return AUDIO_SOCKET__warm_cache(NULL);
+    } else if (argc != 1) {
+        printf(USAGE "\n");
+        return -1;
+    }
+
     /* Initialize the audio socket. */
-    audio_socket_t* socket = AUDIO_SOCKET__initialize();
+    audio_socket_t* socket = AUDIO_SOCKET__initialize(NULL);
     if (socket == NULL) {
         LOG_ERROR("Failed to initialize socket");
         status = -1;
@@ -0,0 +1,66 @@
+/**
+ * Defines a portable float vector type for the DSP hot paths.
+ * Uses the GCC/Clang vector extensions, the compiler lowers it to the widest SIMD registers
+ * the target supports (e.g. two SSE registers, or a single AVX register with `-mavx`).
+ */
+
+#ifndef AUDIONET_VECTOR_H
+#define AUDIONET_VECTOR_H
+
+#include <string.h>
+
+/** The number of float lanes in a `float_vector_t`. */
+#define FLOAT_VECTOR_LANES (8)
+
+/** The alignment required for loading a `float_vector_t` directly from memory. */
+#define FLOAT_VECTOR_ALIGNMENT (FLOAT_VECTOR_LANES * sizeof(float))
+
+/**
+ * A vector of `FLOAT_VECTOR_LANES` floats, arithmetic operators apply lane-wise.
+ */
+typedef float float_vector_t __attribute__((vector_size(FLOAT_VECTOR_LANES * sizeof(float))));
+
+/**
+ * Rounds a count of floats up to a whole number of vectors.
+ *
+ * @param count The number of floats.
+ * @return The number of floats padded to a multiple of `FLOAT_VECTOR_LANES`.
+ */
+#define FLOAT_VECTOR_PADDED(count) ((((count) + FLOAT_VECTOR_LANES - 1) / FLOAT_VECTOR_LANES) * FLOAT_VECTOR_LANES)
+
+/**
+ * Loads a vector from memory of any alignment.
+ *
+ * @param vector Returns the loaded vector.
+ * @param source The first of `FLOAT_VECTOR_LANES` floats to load.
+ */
+static inline void float_vector_load(float_vector_t* vector, const float* source) {
+    memcpy(vector, source, sizeof(*vector));
+}
+
+/**
+ * Stores a vector into memory of any alignment.
+ *
+ * @param destination The first of `FLOAT_VECTOR_LANES` floats to store into.
+ * @param vector The vector to store.
+ */
+static inline void float_vector_store(float* destination, const float_vector_t* vector) {
+    memcpy(destination, vector, sizeof(*vector));
+}
+
+/**
+ * Sums the lanes of a vector.
+ *
+ * @param vector The vector to sum.
+ * @return The sum of all lanes.
+ */
+static inline float float_vector_sum(const float_vector_t* vector) {
+    float sum = 0;
+    for (int i = 0; i < FLOAT_VECTOR_LANES; ++i) {
+        sum += (*vector)[i];
+    }
+
+    return sum;
+}
+
+#endif //AUDIONET_VECTOR_H
@@ -0,0 +1,231 @@
+#include <malloc.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "work_pool.h"
+#include "utils/logger.h"
+#include "utils/utils.h"
+
+/**
+ * A worker's deque of jobs, the jobs `[front, back)` of `jobs` are still pending.
+ */
+struct work_deque {
+    /** Protects the deque's bounds, taken by the owner and by thieves. */
+    pthread_mutex_t lock;
+
+    /** The indices of the jobs dealt to the worker. */
+    size_t* jobs;
+
+    /** The first pending job, thieves steal from here. */
+    size_t front;
+
+    /** One past the last pending job, the owner takes from here. */
+    size_t back;
+};
+
+/**
+ * The state shared by the workers of a run.
+ */
+struct work_pool {
+    /** The worker threads. */
+    pthread_t* threads;
+
+    /** The deque of each worker. */
+    struct work_deque* deques;
+
+    /** The amount of workers. */
+    uint32_t workers_count;
+
+    /** The job function. */
+    work_pool_job_t job;
+
+    /** The job function context. */
+    void* context;
+
+    /** The amount of jobs stolen. */
+    atomic_uint_fast64_t steals;
+};
+
+/**
+ * The arguments of a worker thread.
+ */
+struct worker_arguments {
+    /** The pool. */
+    struct work_pool* pool;
+
+    /** The worker's index. */
+    uint32_t index;
+};
+
+/**
+ * Takes the last pending job of the worker's own deque.
+ *
+ * @param deque The worker's deque.
+ * @param job_index Returns the taken job.
+ * @return Whether a job was taken.
+ */
+static bool take_own_job(struct work_deque* deque, size_t* job_index) {
+    bool is_taken = false;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->front < deque->back) {
+        deque->back--;
+        *job_index = deque->jobs[deque->back];
+        is_taken = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return is_taken;
+}
+
+/**
+ * Steals the first pending job of the fullest other deque.
+ *
+ * @param pool The pool.
+ * @param thief The index of the stealing worker.
+ * @param job_index Returns the stolen job.
+ * @return Whether a job was stolen, false once every deque is empty.
+ */
+static bool steal_job(struct work_pool* pool, uint32_t thief, size_t* job_index) {
+    while (true) {
+        /* Find the fullest victim, the sizes are only a hint since they change under us. */
+        uint32_t victim = thief;
+        size_t victim_size = 0;
+        for (uint32_t i = 0; i < pool->workers_count; ++i) {
+            struct work_deque* deque = &pool->deques[i];
+            pthread_mutex_lock(&deque->lock);
+            size_t size = deque->back - deque->front;
+            pthread_mutex_unlock(&deque->lock);
+            if (i != thief && size > victim_size) {
+                victim = i;
+                victim_size = size;
+            }
+        }
+        if (victim == thief) {
+            return false;
+        }
+
+        /* The victim may have run out meanwhile, then look again. */
+        struct work_deque* deque = &pool->deques[victim];
+        bool is_stolen = false;
+        pthread_mutex_lock(&deque->lock);
+        if (deque->front < deque->back) {
+            *job_index = deque->jobs[deque->front];
+            deque->front++;
+            is_stolen = true;
+        }
+        pthread_mutex_unlock(&deque->lock);
+        if (is_stolen) {
+            atomic_fetch_add_explicit(&pool->steals, 1, memory_order_relaxed);
+            return true;
+        }
+    }
+}
+
+/**
+ * The worker thread.
+ * Runs the worker's own jobs, then steals until there are no jobs left.
+ *
+ * @param context The worker arguments.
+ * @return Always NULL.
+ */
+static void* worker_main(void* context) {
+    struct worker_arguments* arguments = context;
+    struct work_pool* pool = arguments->pool;
+    size_t job_index;
+
+    while (take_own_job(&pool->deques[arguments->index], &job_index) ||
+           steal_job(pool, arguments->index, &job_index)) {
+        pool->job(pool->context, job_index, arguments->index);
+    }
+
+    return NULL;
+}
+
+uint32_t WORK_POOL__get_processors_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (uint32_t)count : 1;
+}
+
+int WORK_POOL__run(uint32_t workers_count, size_t jobs_count, work_pool_job_t job, void* context,
+                   struct work_pool_stats* stats) {
+    int ret = -1;
+    uint32_t started_count = 0;
+    uint32_t initialized_count = 0;
+
+    /* Validate parameters. */
+    if (workers_count == 0 || job == NULL) {
+        LOG_ERROR("Invalid parameters");
+        return -1;
+    }
+
+    /* There's no use for more workers than jobs. */
+    if (workers_count > jobs_count) {
+        workers_count = (jobs_count > 0) ? (uint32_t)jobs_count : 1;
+    }
+
+    struct work_pool pool = {
+        .threads = calloc(workers_count, sizeof(pthread_t)),
+        .deques = calloc(workers_count, sizeof(struct work_deque)),
+        .workers_count = workers_count,
+        .job = job,
+        .context = context,
+    };
+    atomic_init(&pool.steals, 0);
+    struct worker_arguments* arguments = calloc(workers_count, sizeof(struct worker_arguments));
+    if (pool.threads == NULL || pool.deques == NULL || arguments == NULL) {
+        LOG_ERROR("Failed to allocate work pool");
+        goto l_cleanup;
+    }
+
+    /* Deal the jobs round-robin, each worker takes it's jobs from the back so they're stored in reverse. */
+    for (; initialized_count < workers_count; ++initialized_count) {
+        struct work_deque* deque = &pool.deques[initialized_count];
+        size_t dealt_count = jobs_count / workers_count + (initialized_count < jobs_count % workers_count ? 1 : 0);
+        deque->jobs = malloc(max(dealt_count, 1) * sizeof(size_t));
+        if (deque->jobs == NULL || pthread_mutex_init(&deque->lock, NULL) != 0) {
+            LOG_ERROR("Failed to initialize work deque");
+            free(deque->jobs);
+            goto l_cleanup;
+        }
+
+        for (size_t i = 0; i < dealt_count; ++i) {
+            deque->jobs[dealt_count - 1 - i] = initialized_count + i * workers_count;
+        }
+        deque->front = 0;
+        deque->back = dealt_count;
+    }
+
+    /* Run the workers, if some fail to start the others still run every job. */
+    for (; started_count < workers_count; ++started_count) {
+        arguments[started_count].pool = &pool;
+        arguments[started_count].index = started_count;
+        if (pthread_create(&pool.threads[started_count], NULL, worker_main, &arguments[started_count]) != 0) {
+            LOG_ERROR("Failed to start worker %u", started_count);
+            break;
+        }
+    }
+    if (started_count == 0) {
+        goto l_cleanup;
+    }
+
+    ret = 0;
+
+l_cleanup:
+    for (uint32_t i = 0; i < started_count; ++i) {
+        pthread_join(pool.threads[i], NULL);
+    }
+    for (uint32_t i = 0; i < initialized_count; ++i) {
+        pthread_mutex_destroy(&pool.deques[i].lock);
+        free(pool.deques[i].jobs);
+    }
+
+    if (stats != NULL) {
+        stats->steals = atomic_load(&pool.steals);
+    }
+
+    free(arguments);
+    free(pool.deques);
+    free(pool.threads);
+    return ret;
+}
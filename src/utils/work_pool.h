@@ -0,0 +1,51 @@
+/**
+ * Defines a work stealing pool, running a batch of independent jobs over multiple worker threads.
+ * Each worker owns a deque of jobs, it takes it's own jobs from the back and once they run out
+ * steals from the front of the fullest other deque, so uneven jobs (e.g files of different lengths) stay balanced.
+ */
+
+#ifndef AUDIONET_WORK_POOL_H
+#define AUDIONET_WORK_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The type definition for a pool job.
+ *
+ * @param context The context passed to `WORK_POOL__run`.
+ * @param job_index The index of the job to run.
+ * @param worker_index The index of the worker running the job, for per-worker state.
+ */
+typedef void (*work_pool_job_t)(void* context, size_t job_index, uint32_t worker_index);
+
+/**
+ * Runtime counters of a pool run.
+ */
+struct work_pool_stats {
+    /** The amount of jobs run by a worker other than the one they were dealt to. */
+    uint64_t steals;
+};
+
+/**
+ * Gets the amount of online processors, the natural amount of workers.
+ *
+ * @return The amount of online processors (at least 1).
+ */
+uint32_t WORK_POOL__get_processors_count(void);
+
+/**
+ * Runs jobs `0` to `jobs_count - 1` over worker threads and waits for all of them to finish.
+ * The jobs are dealt round-robin in order, so jobs expected to run longer should come first.
+ *
+ * @param workers_count The amount of worker threads.
+ * @param jobs_count The amount of jobs.
+ * @param job The job function.
+ * @param context An optional context param passed to the job function.
+ * @param stats Returns the run's counters, optional.
+ * @return 0 On Success, -1 On Failure.
+ */
+int WORK_POOL__run(uint32_t workers_count, size_t jobs_count, work_pool_job_t job, void* context,
+                   struct work_pool_stats* stats);
+
+#endif //AUDIONET_WORK_POOL_H
@@ -0,0 +1,429 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <malloc.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "wav_file.h"
+#include "utils/logger.h"
+
+/** The `format` of integer PCM samples. */
+#define WAVE_FORMAT_PCM (1)
+
+/** The `format` of float PCM samples. */
+#define WAVE_FORMAT_IEEE_FLOAT (3)
+
+/** The `format` of files whose real format is the extension's sub-format. */
+#define WAVE_FORMAT_EXTENSIBLE (0xFFFE)
+
+/** The offset of the sub-format in an extensible format chunk. */
+#define EXTENSIBLE_SUB_FORMAT_OFFSET (24)
+
+/** The size of the header of written files, the RIFF header followed by the format chunk and the data chunk header. */
+#define WRITTEN_HEADER_SIZE (44)
+
+/** The largest data chunk a RIFF file can describe. */
+#define MAX_DATA_SIZE (UINT32_MAX - WRITTEN_HEADER_SIZE)
+
+/** The most samples a written file holds (about 6 hours at 48kHz), so it's sizes always fit the header. */
+#define MAX_WRITTEN_SAMPLES (MAX_DATA_SIZE / sizeof(float))
+
+/** The data sizes standing for "until the end of the file" in a header that was never completed (e.g. streamed). */
+#define UNKNOWN_DATA_SIZE (0)
+#define UNKNOWN_DATA_SIZE_STREAMED (0xFFFFFFFF)
+
+/** The amount of samples the written file grows by at once (about 20 seconds at 48kHz). */
+#define WRITER_GROWTH_SAMPLES (1 << 20)
+
+struct wav_reader_s {
+    /** The mapped file. */
+    uint8_t* mapping;
+
+    /** The size of the mapped file. */
+    size_t mapping_size;
+
+    /** The first sample in the file. */
+    const uint8_t* data;
+
+    /** The sample rate of the file. */
+    uint32_t sample_rate;
+
+    /** The amount of samples (per channel) in the file. */
+    uint64_t samples_count;
+
+    /** The amount of bytes between consecutive samples of a channel (a frame). */
+    uint32_t frame_size;
+
+    /** The size of each sample. */
+    uint32_t sample_size;
+
+    /** Whether the samples are floats (or integers). */
+    bool is_float;
+
+    /** The index of the next sample to read. */
+    uint64_t position;
+};
+
+struct wav_writer_s {
+    /** The written file. */
+    int fd;
+
+    /** The mapped file. */
+    uint8_t* mapping;
+
+    /** The amount of samples the mapped file can hold. */
+    uint64_t capacity;
+
+    /** The amount of samples written. */
+    uint64_t samples_count;
+};
+
+/**
+ * Reads a little endian 16 bit integer.
+ *
+ * @param buffer The buffer to read from.
+ * @return The read integer.
+ */
+static uint16_t read_u16(const uint8_t* buffer) {
+    return (uint16_t)(buffer[0] | (buffer[1] << 8));
+}
+
+/**
+ * Reads a little endian 32 bit integer.
+ *
+ * @param buffer The buffer to read from.
+ * @return The read integer.
+ */
+static uint32_t read_u32(const uint8_t* buffer) {
+    return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) | ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+/**
+ * Writes a little endian 16 bit integer.
+ *
+ * @param buffer The buffer to write to.
+ * @param value The integer to write.
+ */
+static void write_u16(uint8_t* buffer, uint16_t value) {
+    buffer[0] = (uint8_t)value;
+    buffer[1] = (uint8_t)(value >> 8);
+}
+
+/**
+ * Writes a little endian 32 bit integer.
+ *
+ * @param buffer The buffer to write to.
+ * @param value The integer to write.
+ */
+static void write_u32(uint8_t* buffer, uint32_t value) {
+    write_u16(buffer, (uint16_t)value);
+    write_u16(buffer + 2, (uint16_t)(value >> 16));
+}
+
+/**
+ * Parses the chunks of a mapped WAV file.
+ *
+ * @param reader The reader of the mapped file, returns the format and the location of the samples.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int parse_chunks(wav_reader_t* reader) {
+    const uint8_t* file = reader->mapping;
+    size_t size = reader->mapping_size;
+    if (size < 12 || memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0) {
+        LOG_ERROR("Not a WAV file");
+        return -1;
+    }
+
+    bool has_format = false;
+    uint16_t format = 0;
+    uint16_t channels = 0;
+    uint16_t bits = 0;
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        const uint8_t* chunk = file + offset;
+        size_t chunk_size = read_u32(chunk + 4);
+        const uint8_t* body = chunk + 8;
+        size_t available = size - offset - 8;
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (chunk_size < 16 || chunk_size > available) {
+                LOG_ERROR("Invalid WAV format chunk");
+                return -1;
+            }
+            format = read_u16(body);
+            channels = read_u16(body + 2);
+            reader->sample_rate = read_u32(body + 4);
+            bits = read_u16(body + 14);
+            if (format == WAVE_FORMAT_EXTENSIBLE && chunk_size >= EXTENSIBLE_SUB_FORMAT_OFFSET + 2) {
+                format = read_u16(body + EXTENSIBLE_SUB_FORMAT_OFFSET);
+            }
+            has_format = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!has_format) {
+                LOG_ERROR("WAV data chunk before the format chunk");
+                return -1;
+            }
+
+            reader->data = body;
+            break;
+        }
+
+        /* Chunks are padded to an even size. */
+        offset += 8 + chunk_size + (chunk_size & 1);
+    }
+
+    if (reader->data == NULL) {
+        LOG_ERROR("WAV file has no data chunk");
+        return -1;
+    }
+
+    /* Validate the format is supported. */
+    bool is_supported = (format == WAVE_FORMAT_PCM && (bits == 16 || bits == 24 || bits == 32)) ||
+                        (format == WAVE_FORMAT_IEEE_FLOAT && bits == 32);
+    if (!is_supported || channels == 0 || reader->sample_rate == 0) {
+        LOG_ERROR("Unsupported WAV format %u (%u bits, %u channels, %uHz)", format, bits, channels, reader->sample_rate);
+        return -1;
+    }
+
+    reader->is_float = (format == WAVE_FORMAT_IEEE_FLOAT);
+    reader->sample_size = bits / 8;
+    reader->frame_size = reader->sample_size * channels;
+    /* Streamed (or never completed) files may not have their data size filled, read until the end of the file. */
+    size_t data_size = read_u32(reader->data - 4);
+    size_t available = size - (size_t)(reader->data - file);
+    if (data_size == UNKNOWN_DATA_SIZE || data_size == UNKNOWN_DATA_SIZE_STREAMED || data_size > available) {
+        data_size = available;
+    }
+    reader->samples_count = data_size / reader->frame_size;
+    return 0;
+}
+
+wav_reader_t* WAV_READER__initialize(const char* path) {
+    wav_reader_t* reader = NULL;
+    int fd = -1;
+
+    /* Validate parameters. */
+    if (path == NULL) {
+        LOG_ERROR("Invalid parameters");
+        goto l_cleanup;
+    }
+
+    /* Allocate the reader struct. */
+    reader = malloc(sizeof(wav_reader_t));
+    if (reader == NULL) {
+        LOG_ERROR("Failed to allocate WAV reader");
+        goto l_cleanup;
+    }
+    reader->mapping = NULL;
+    reader->data = NULL;
+    reader->position = 0;
+
+    /* Map the file. */
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat file_stat;
+    if (fd < 0 || fstat(fd, &file_stat) != 0) {
+        LOG_ERROR("Failed to open WAV file %s", path);
+        goto l_error;
+    }
+    reader->mapping_size = (size_t)file_stat.st_size;
+    if (reader->mapping_size == 0) {
+        LOG_ERROR("Empty WAV file %s", path);
+        goto l_error;
+    }
+    reader->mapping = mmap(NULL, reader->mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (reader->mapping == MAP_FAILED) {
+        reader->mapping = NULL;
+        LOG_ERROR("Failed to map WAV file %s", path);
+        goto l_error;
+    }
+    madvise(reader->mapping, reader->mapping_size, MADV_SEQUENTIAL);
+
+    if (parse_chunks(reader) != 0) {
+        LOG_ERROR("Failed to parse WAV file %s", path);
+        goto l_error;
+    }
+
+    goto l_cleanup;
+
+l_error:
+    WAV_READER__free(reader);
+    reader = NULL;
+
+l_cleanup:
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    return reader;
+}
+
+void WAV_READER__free(wav_reader_t* reader) {
+    if (reader == NULL) {
+        return;
+    }
+
+    if (reader->mapping != NULL) {
+        munmap(reader->mapping, reader->mapping_size);
+    }
+    free(reader);
+}
+
+uint32_t WAV_READER__get_sample_rate(wav_reader_t* reader) {
+    return reader->sample_rate;
+}
+
+uint64_t WAV_READER__get_samples_count(wav_reader_t* reader) {
+    return reader->samples_count;
+}
+
+size_t WAV_READER__read(wav_reader_t* reader, float* samples, size_t samples_count) {
+    uint64_t remaining = reader->samples_count - reader->position;
+    size_t count = (samples_count < remaining) ? samples_count : (size_t)remaining;
+    const uint8_t* frame = reader->data + reader->position * reader->frame_size;
+
+    for (size_t i = 0; i < count; ++i, frame += reader->frame_size) {
+        if (reader->is_float) {
+            memcpy(&samples[i], frame, sizeof(float));
+        } else if (reader->sample_size == 2) {
+            samples[i] = (float)(int16_t)read_u16(frame) / 32768.0f;
+        } else if (reader->sample_size == 3) {
+            /* Place the 24 bits at the top of a 32 bit integer to sign extend them. */
+            int32_t value = (int32_t)(((uint32_t)frame[0] << 8) | ((uint32_t)frame[1] << 16) | ((uint32_t)frame[2] << 24));
+            samples[i] = (float)value / 2147483648.0f;
+        } else {
+            samples[i] = (float)(int32_t)read_u32(frame) / 2147483648.0f;
+        }
+    }
+
+    reader->position += count;
+    return count;
+}
+
+/**
+ * Grows the written file and it's mapping.
+ *
+ * @param writer The writer.
+ * @param capacity The amount of samples the file must hold.
+ * @return 0 On Success, -1 On Failure.
+ */
+static int grow_writer(wav_writer_t* writer, uint64_t capacity) {
+    /* Grow by large steps so the file is rarely remapped. */
+    capacity = (capacity + WRITER_GROWTH_SAMPLES - 1) / WRITER_GROWTH_SAMPLES * WRITER_GROWTH_SAMPLES;
+    if (capacity > MAX_WRITTEN_SAMPLES) {
+        capacity = MAX_WRITTEN_SAMPLES;
+    }
+
+    size_t old_size = WRITTEN_HEADER_SIZE + writer->capacity * sizeof(float);
+    size_t new_size = WRITTEN_HEADER_SIZE + capacity * sizeof(float);
+    if (ftruncate(writer->fd, (off_t)new_size) != 0) {
+        LOG_ERROR("Failed to grow WAV file");
+        return -1;
+    }
+
+    uint8_t* mapping = (writer->mapping == NULL) ?
+            mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, writer->fd, 0) :
+            mremap(writer->mapping, old_size, new_size, MREMAP_MAYMOVE);
+    if (mapping == MAP_FAILED) {
+        LOG_ERROR("Failed to map WAV file");
+        return -1;
+    }
+
+    writer->mapping = mapping;
+    writer->capacity = capacity;
+    return 0;
+}
+
+wav_writer_t* WAV_WRITER__initialize(const char* path, uint32_t sample_rate) {
+    /* Validate parameters. */
+    if (path == NULL || sample_rate == 0) {
+        LOG_ERROR("Invalid parameters");
+        return NULL;
+    }
+
+    /* Allocate the writer struct. */
+    wav_writer_t* writer = malloc(sizeof(wav_writer_t));
+    if (writer == NULL) {
+        LOG_ERROR("Failed to allocate WAV writer");
+        return NULL;
+    }
+    writer->mapping = NULL;
+    writer->capacity = 0;
+    writer->samples_count = 0;
+
+    writer->fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (writer->fd < 0) {
+        LOG_ERROR("Failed to create WAV file %s", path);
+        free(writer);
+        return NULL;
+    }
+
+    if (grow_writer(writer, WRITER_GROWTH_SAMPLES) != 0) {
+        LOG_ERROR("Failed to allocate WAV file %s", path);
+        close(writer->fd);
+        free(writer);
+        return NULL;
+    }
+
+    /* Write the header, the sizes are filled once the writer is freed. */
+    uint8_t* header = writer->mapping;
+    memcpy(header, "RIFF", 4);
+    write_u32(header + 4, 0);
+    memcpy(header + 8, "WAVE", 4);
+    memcpy(header + 12, "fmt ", 4);
+    write_u32(header + 16, 16);
+    write_u16(header + 20, WAVE_FORMAT_IEEE_FLOAT);
+    write_u16(header + 22, 1);
+    write_u32(header + 24, sample_rate);
+    write_u32(header + 28, sample_rate * sizeof(float));
+    write_u16(header + 32, sizeof(float));
+    write_u16(header + 34, 8 * sizeof(float));
+    memcpy(header + 36, "data", 4);
+    write_u32(header + 40, 0);
+
+    return writer;
+}
+
+void WAV_WRITER__free(wav_writer_t* writer) {
+    if (writer == NULL) {
+        return;
+    }
+
+    /* Fill the sizes in the header and drop the unused tail of the file,
+     * the writer never holds more than `MAX_WRITTEN_SAMPLES` so the sizes fit. */
+    uint64_t data_size = writer->samples_count * sizeof(float);
+    write_u32(writer->mapping + 4, (uint32_t)(WRITTEN_HEADER_SIZE - 8 + data_size));
+    write_u32(writer->mapping + 40, (uint32_t)data_size);
+    munmap(writer->mapping, WRITTEN_HEADER_SIZE + writer->capacity * sizeof(float));
+    if (ftruncate(writer->fd, WRITTEN_HEADER_SIZE + (off_t)data_size) != 0) {
+        LOG_WARNING("Failed to truncate WAV file");
+    }
+
+    close(writer->fd);
+    free(writer);
+}
+
+int WAV_WRITER__write(wav_writer_t* writer, const float* samples, size_t samples_count) {
+    /* A RIFF file can't describe more samples, refuse them rather than corrupting the header. */
+    if (samples_count > MAX_WRITTEN_SAMPLES - writer->samples_count) {
+        LOG_ERROR("WAV file size limit of %zu samples reached", (size_t)MAX_WRITTEN_SAMPLES);
+        return -1;
+    }
+
+    if (writer->samples_count + samples_count > writer->capacity) {
+        if (grow_writer(writer, writer->samples_count + samples_count) != 0) {
+            return -1;
+        }
+    }
+
+    memcpy(writer->mapping + WRITTEN_HEADER_SIZE + writer->samples_count * sizeof(float),
+           samples, samples_count * sizeof(float));
+    writer->samples_count += samples_count;
+    return 0;
+}
+
+uint64_t WAV_WRITER__get_samples_count(wav_writer_t* writer) {
+    return writer->samples_count;
+}
@@ -0,0 +1,103 @@
+/**
+ * Defines memory-mapped WAV file reading and writing.
+ * Recordings are read as mono 32 bit float samples, from 16/24/32 bit PCM or 32 bit float files (the first channel).
+ * Recordings are written as mono 32 bit float files, so written samples are read back bit-exact.
+ */
+
+#ifndef AUDIONET_WAV_FILE_H
+#define AUDIONET_WAV_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The WAV file reader interface type.
+ */
+typedef struct wav_reader_s wav_reader_t;
+
+/**
+ * The WAV file writer interface type.
+ */
+typedef struct wav_writer_s wav_writer_t;
+
+/**
+ * Opens a WAV file for reading, mapping it into memory.
+ * A data size of 0 or 0xFFFFFFFF (a header that was never completed, e.g. the writer's process was killed)
+ * is read until the end of the file (for an incomplete written file, followed by the silence it was grown by).
+ *
+ * @param path The path of the file.
+ * @return The initialized reader, or NULL on failure.
+ */
+wav_reader_t* WAV_READER__initialize(const char* path);
+
+/**
+ * Closes a reader previously initialized with WAV_READER__initialize.
+ *
+ * @param reader The reader to free.
+ */
+void WAV_READER__free(wav_reader_t* reader);
+
+/**
+ * Gets the sample rate of the read file.
+ *
+ * @param reader The reader.
+ * @return The sample rate.
+ */
+uint32_t WAV_READER__get_sample_rate(wav_reader_t* reader);
+
+/**
+ * Gets the amount of samples (per channel) in the read file.
+ *
+ * @param reader The reader.
+ * @return The amount of samples.
+ */
+uint64_t WAV_READER__get_samples_count(wav_reader_t* reader);
+
+/**
+ * Reads the next samples of the file, converted to 32 bit float.
+ *
+ * @param reader The reader.
+ * @param samples The buffer to read the samples into.
+ * @param samples_count The amount of samples to read.
+ * @return The amount of samples read, less than requested once the end of the file is reached.
+ */
+size_t WAV_READER__read(wav_reader_t* reader, float* samples, size_t samples_count);
+
+/**
+ * Creates (or truncates) a mono 32 bit float WAV file for writing, mapping it into memory.
+ * The file grows as samples are written, it's complete only once the writer is freed.
+ *
+ * @param path The path of the file.
+ * @param sample_rate The sample rate of the written samples.
+ * @return The initialized writer, or NULL on failure.
+ */
+wav_writer_t* WAV_WRITER__initialize(const char* path, uint32_t sample_rate);
+
+/**
+ * Completes the written file's header and closes a writer previously initialized with WAV_WRITER__initialize.
+ *
+ * @param writer The writer to free.
+ */
+void WAV_WRITER__free(wav_writer_t* writer);
+
+/**
+ * Appends samples to the written file.
+ * A file holds up to 4GiB of samples (about 6 hours at 48kHz), a write past that fails and writes nothing,
+ * the samples written before it are kept.
+ *
+ * @param writer The writer.
+ * @param samples The samples to write.
+ * @param samples_count The amount of samples.
+ * @return 0 On Success, -1 On Failure.
+ */
+int WAV_WRITER__write(wav_writer_t* writer, const float* samples, size_t samples_count);
+
+/**
+ * Gets the amount of samples written so far.
+ *
+ * @param writer The writer.
+ * @return The amount of samples written.
+ */
+uint64_t WAV_WRITER__get_samples_count(wav_writer_t* writer);
+
+#endif //AUDIONET_WAV_FILE_H